@@ -684,6 +684,16 @@ endif(FLTK_OPTION_SVG)
 
 #######################################################################
 
+option(FLTK_OPTION_TRACE "time event loop phases and widgets (Fl::Trace)" OFF)
+
+if(FLTK_OPTION_TRACE)
+  set(FLTK_USE_TRACE 1)
+else()
+  set(FLTK_USE_TRACE 0)
+endif(FLTK_OPTION_TRACE)
+
+#######################################################################
+
 # FIXME: GLU libs have already been searched in resources.cmake
 
 set(HAVE_GL LIB_GL OR LIB_MesaGL)
@@ -1,7 +1,7 @@
 //
 // OpenGL header file for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2018 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // You must include this instead of GL/gl.h to get the Microsoft
 // APIENTRY stuff included (from <windows.h>) prior to the OpenGL
@@ -93,6 +93,10 @@ FL_EXPORT void gl_measure(const char*, int& x, int& y);
 FL_EXPORT void gl_texture_pile_height(int max);
 FL_EXPORT int  gl_texture_pile_height();
 FL_EXPORT void gl_texture_reset();
+FL_EXPORT void gl_text_batch_begin();
+FL_EXPORT void gl_text_batch_end();
+FL_EXPORT void gl_shape_batch_begin();
+FL_EXPORT void gl_shape_batch_end();
 
 FL_EXPORT void gl_draw_image(const uchar *, int x,int y,int w,int h, int d=3, int ld=0);
 
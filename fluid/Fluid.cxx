@@ -19,6 +19,7 @@
 #include "Project.h"
 #include "proj/mergeback.h"
 #include "app/Menu.h"
+#include "app/batch.h"
 #include "app/shell_command.h"
 #include "proj/undo.h"
 #include "io/Project_Reader.h"
@@ -149,6 +150,10 @@ int Application::run(int argc,char **argv) {
 
   make_main_window();
 
+  // compile many project files in one session
+  if (!args.batch_files.empty())
+    ::exit(app::compile_batch(args.batch_files, args.batch_jobs, args.batch_force!=0));
+
   if (c) {
     if (batch_mode) {
       proj.set_filename(c);
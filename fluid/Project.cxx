@@ -55,6 +55,7 @@ void Project::reset() {
   header_file_name = ".h";
   code_file_name = ".cxx";
   include_guard = "";
+  input_stamp = "";
   write_mergeback_data = 0;
 }
 
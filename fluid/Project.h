@@ -71,6 +71,8 @@ public: // Member Variables
   std::string code_file_name = ".cxx";
   /// Macro used in header file for #ifdef MACRO \n #defined MACRO \n ... \n #endif
   std::string include_guard = "";
+  /// If set, this hash of the project file is written into the header file in multi-file batch mode.
+  std::string input_stamp = "";
 
   /// Used as a counter to set the .fl project dir as the current directory.
   int in_project_dir { 0 };
@@ -32,14 +32,18 @@
 #include <FL/Fl_File_Chooser.H>
 #include <FL/Fl_SVG_Image.H>
 #include <FL/Fl_Anim_GIF_Image.H>
+#include <FL/Fl_Pixmap.H>
 #include "../src/flstring.h"
 
+#include <zlib.h>
+
 #include <stdio.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <map>
 #include <string>
+#include <vector>
 
 
 /**
@@ -145,22 +149,112 @@ void Image_Asset::write_static_rgb(fld::io::Code_Writer& f, const char* idata_na
 }
 
 
+/**
+ \brief Append a PNG chunk with length, type, data, and crc to a buffer.
+ */
+static void png_chunk(std::vector<unsigned char> &out, const char *type, const unsigned char *data, size_t n) {
+  unsigned char hdr[8] = {
+    (unsigned char)(n>>24), (unsigned char)(n>>16), (unsigned char)(n>>8), (unsigned char)n,
+    (unsigned char)type[0], (unsigned char)type[1], (unsigned char)type[2], (unsigned char)type[3] };
+  out.insert(out.end(), hdr, hdr+8);
+  if (n) out.insert(out.end(), data, data+n);
+  uLong crc = crc32(0L, hdr+4, 4);
+  if (n) crc = crc32(crc, data, (uInt)n);
+  unsigned char tail[4] = {
+    (unsigned char)(crc>>24), (unsigned char)(crc>>16), (unsigned char)(crc>>8), (unsigned char)crc };
+  out.insert(out.end(), tail, tail+4);
+}
+
+
+/**
+ \brief Write the image pixels as a deflated PNG data stream.
+
+ Convert the image into RGB or grayscale pixels and compress them with zlib
+ into a minimal PNG data stream. This is usually much smaller than the raw
+ pixel data written by write_static_rgb(), and it is decoded by
+ Fl_PNG_Image when the image initializer is called for the first time.
+
+ A comment with the size of the raw and the compressed pixel data is written
+ to the source file to help choosing the best storage mode.
+
+ \param f Write code to this C++ source code file
+ \param idata_name name of the static array holding the image data
+ */
+void Image_Asset::write_static_deflated(fld::io::Code_Writer& f, const char* idata_name) {
+  Fl_RGB_Image *rgb = nullptr;
+  const uchar *pixels = nullptr;
+  int w = image_->w(), h = image_->h(), d = image_->d(), ld = image_->ld();
+  if (image_->count() > 1) {
+    // convert pixmaps into RGBA data
+    rgb = new Fl_RGB_Image((Fl_Pixmap*)image_->image());
+    pixels = rgb->array;
+    w = rgb->w(); h = rgb->h(); d = rgb->d(); ld = rgb->ld();
+  } else {
+    pixels = (const uchar*)image_->data()[0];
+  }
+  if (!pixels || w <= 0 || h <= 0 || d < 1 || d > 4) {
+    delete rgb;
+    write_static_rgb(f, idata_name);
+    return;
+  }
+  if (!ld) ld = w * d;
+
+  // PNG scanlines are prefixed with a filter type byte, 0 is 'none'
+  size_t row = (size_t)w * d;
+  std::vector<unsigned char> raw((row + 1) * h);
+  for (int y = 0; y < h; y++) {
+    raw[y*(row+1)] = 0;
+    memcpy(&raw[y*(row+1)+1], pixels + (size_t)y * ld, row);
+  }
+  delete rgb;
+  uLongf zlen = compressBound((uLong)raw.size());
+  std::vector<unsigned char> zdata(zlen);
+  if (compress2(zdata.data(), &zlen, raw.data(), (uLong)raw.size(), Z_BEST_COMPRESSION) != Z_OK) {
+    write_static_rgb(f, idata_name);
+    return;
+  }
+
+  static const unsigned char color_type[] = { 0, 0, 4, 2, 6 };
+  static const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  unsigned char ihdr[13] = {
+    (unsigned char)(w>>24), (unsigned char)(w>>16), (unsigned char)(w>>8), (unsigned char)w,
+    (unsigned char)(h>>24), (unsigned char)(h>>16), (unsigned char)(h>>8), (unsigned char)h,
+    8, color_type[d], 0, 0, 0 };
+  std::vector<unsigned char> png(signature, signature+8);
+  png_chunk(png, "IHDR", ihdr, sizeof(ihdr));
+  png_chunk(png, "IDAT", zdata.data(), zlen);
+  png_chunk(png, "IEND", nullptr, 0);
+
+  f.write_c("\n");
+  f.write_c_once("#include <FL/Fl_PNG_Image.H>\n");
+  f.write_c("// %d bytes of pixel data, deflated to %d bytes\n", (int)(row * h), (int)png.size());
+  f.write_c("static const unsigned char %s[] =\n", idata_name);
+  f.write_cdata((const char*)png.data(), (int)png.size());
+  f.write_c(";\n");
+  write_initializer(f, "Fl_PNG_Image", "\"%s\", %s, %d", fl_filename_name(filename()), idata_name, (int)png.size());
+}
+
+
 /**
  \brief Write the static image data into the source file.
 
  Write source code that generates the image data at compile time, and an
  initializer that creates the image at run time.
 
- If \p compressed is set, write the original image format, which requires
+ If \p compressed is 1, write the original image format, which requires
  linking the matching image reader at runtime, or if we want to store the raw
  uncompressed pixels, which makes images fast, needs no reader, but takes a
- lot of memory (current default for PNG)
+ lot of memory (current default for PNG). If \p compressed is 2, the raw
+ pixels are deflated into a PNG data stream, which needs the PNG reader, but
+ is independent of the original file format.
 
  \param f Write code to this C++ source code file
- \param compressed write data in the original compressed file format
+ \param compressed 0 for raw pixels, 1 for the original format, 2 for deflated pixels
  */
 void Image_Asset::write_static(fld::io::Code_Writer& f, int compressed) {
   if (!image_) return;
+  bool deflated = (compressed == 2);
+  if (deflated) compressed = 0;
   const char *idata_name = f.unique_id(this, "idata", fl_filename_name(filename()), nullptr);
   initializer_function_ = f.unique_id(this, "image", fl_filename_name(filename()), nullptr);
 
@@ -188,6 +282,9 @@ void Image_Asset::write_static(fld::io::Code_Writer& f, int compressed) {
     size_t nData = write_static_binary(f, "BMP");
     f.write_c(";\n");
     write_initializer(f, "Fl_BMP_Image", "\"%s\", %s, %d", fl_filename_name(filename()), idata_name, nData);
+  } else if (deflated && image_->count() > 1) {
+    // Write Pixmap as deflated RGBA pixels...
+    write_static_deflated(f, idata_name);
   } else if (image_->count() > 1) {
     // Write Pixmap data...
     f.write_c("\n");
@@ -269,14 +366,19 @@ void Image_Asset::write_static(fld::io::Code_Writer& f, int compressed) {
         svg_image = rgb_image->as_svg_image();
       if (svg_image) {
         svg_image->resize(svg_image->w(), svg_image->h());
-        write_static_rgb(f, idata_name);
+        if (deflated)
+          write_static_deflated(f, idata_name);
+        else
+          write_static_rgb(f, idata_name);
       } else {
         write_file_error(f, "RGB_from_SVG");
       }
     }
   }
 #endif // FLTK_USE_SVG
-  else {
+  else if (deflated) {
+    write_static_deflated(f, idata_name);
+  } else {
     write_static_rgb(f, idata_name);
   }
 }
@@ -41,6 +41,7 @@ private: // methods
   size_t write_static_binary(fld::io::Code_Writer& f, const char* fmt);
   size_t write_static_text(fld::io::Code_Writer& f, const char* fmt);
   void write_static_rgb(fld::io::Code_Writer& f, const char* idata_name);
+  void write_static_deflated(fld::io::Code_Writer& f, const char* idata_name);
 
 public: // methods
   static Image_Asset* find(const char *);
@@ -21,6 +21,12 @@
 #include <FL/Fl.H>
 #include <FL/filename.H>
 #include <FL/fl_ask.H>
+#include <FL/fl_utf8.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 
 using namespace fld;
 using namespace fld::app;
@@ -36,17 +42,34 @@ using namespace fld::app;
 int Args::load(int argc,char **argv) {
   int i = 1;
   Fl::args_to_utf8(argc, argv); // for MSYS2/MinGW
-  if (   (Fl::args(argc,argv,i,arg_cb) == 0)     // unsupported argument found
-      || (Fluid.batch_mode && (i != argc-1))        // .fl filename missing
+  int args_ok = (Fl::args(argc,argv,i,arg_cb) != 0);
+  // More than one project file, or a response file, selects multi-file batch mode
+  if (   args_ok && Fluid.batch_mode && (i < argc)
+      && ((i < argc-1) || (argv[i][0] == '@'))) {
+    for (int j = i; j < argc; j++) {
+      if (!add_batch_file(argv[j])) args_ok = 0;
+    }
+    if (batch_files.empty())
+      args_ok = 0;
+    // output names must be extensions, or all projects would write to the same file
+    if (   (!code_filename.empty() && code_filename[0] != '.')
+        || (!header_filename.empty() && header_filename[0] != '.'))
+      args_ok = 0;
+  }
+  if (   !args_ok                                   // unsupported argument found
+      || (Fluid.batch_mode && batch_files.empty() && (i != argc-1)) // .fl filename missing
       || (!Fluid.batch_mode && (i < argc-1))        // more than one filename found
-      || (argv[i] && (argv[i][0] == '-'))) {  // unknown option
+      || (batch_files.empty() && argv[i] && (argv[i][0] == '-'))) {  // unknown option
     static const char *msg =
-    "usage: %s <switches> name.fl\n"
+    "usage: %s <switches> name.fl [name2.fl ... | @list.txt]\n"
     " -u : update .fl file and exit (may be combined with '-c' or '-cs')\n"
     " -c : write .cxx and .h and exit\n"
     " -cs : write .cxx and .h and strings and exit\n"
     " -o <name> : .cxx output filename, or extension if <name> starts with '.'\n"
     " -h <name> : .h output filename, or extension if <name> starts with '.'\n"
+    " -j <n> : compile multiple .fl files using n worker processes\n"
+    " --force : compile multiple .fl files even if they are unchanged\n"
+    " @list.txt : read .fl filenames from list.txt, one per line\n"
     " --help : brief usage information\n"
     " --version, -v : print fluid version number\n"
     " -d : enable internal debugging\n";
@@ -67,6 +90,41 @@ int Args::load(int argc,char **argv) {
 }
 
 
+/**
+ Add a project file name or the contents of a response file to the batch list.
+
+ A name starting with '@' is read as a response file that contains one
+ project file name per line. Empty lines and lines starting with '#' are
+ ignored.
+
+ \param[in] name project file name, or '@' followed by a response file name
+ \return false if the name is an option, or if the response file can't be read
+ */
+bool Args::add_batch_file(const char *name) {
+  if (!name || !name[0] || (name[0] == '-'))
+    return false;
+  if (name[0] != '@') {
+    batch_files.push_back(name);
+    return true;
+  }
+  FILE *f = fl_fopen(name+1, "rb");
+  if (!f) {
+    fprintf(stderr, "%s : %s\n", name+1, strerror(errno));
+    return false;
+  }
+  char line[FL_PATH_MAX];
+  while (fgets(line, sizeof(line), f)) {
+    char *s = line, *e = line + strlen(line);
+    while (*s && isspace((unsigned char)*s)) s++;
+    while (e > s && isspace((unsigned char)e[-1])) *--e = 0;
+    if (*s && *s != '#')
+      batch_files.push_back(s);
+  }
+  fclose(f);
+  return true;
+}
+
+
 int Args::arg_cb(int argc, char** argv, int& i) {
   return Fluid.args.arg(argc, argv, i);
 }
@@ -117,6 +175,15 @@ int Args::arg(int argc, char** argv, int& i) {
     i += 2; return 2;
   }
 #endif
+  if (argv[i][1] == 'j' && !argv[i][2] && i+1 < argc) {
+    batch_jobs = atoi(argv[i+1]);
+    if (batch_jobs < 1) batch_jobs = 1;
+    i += 2; return 2;
+  }
+  if (strcmp(argv[i], "--force")==0) {
+    batch_force = 1;
+    i++; return 1;
+  }
   if (strcmp(argv[i], "--help")==0) {
     return 0;
   }
@@ -18,6 +18,7 @@
 #define FLUID_APP_ARGS_H
 
 #include <string>
+#include <vector>
 
 namespace fld {
 namespace app {
@@ -27,6 +28,8 @@ class Args {
   static int arg_cb(int argc, char** argv, int& i);
   // Handle args individually.
   int arg(int argc, char** argv, int& i);
+  // Add a project file name or the contents of a response file to the batch list.
+  bool add_batch_file(const char *name);
 public:
   /// Set, if Fluid was started with the command line argument -u
   int update_file { 0 };            // fluid -u
@@ -42,6 +45,12 @@ public:
   std::string autodoc_path { };         // fluid --autodoc path
   /// Set, if Fluid was started with the command line argument -v
   int show_version { 0 };           // fluid -v
+  /// Number of worker processes when compiling more than one project file
+  int batch_jobs { 1 };             // fluid -j n
+  /// Set, if unchanged project files should be compiled anyway
+  int batch_force { 0 };            // fluid --force
+  /// List of project files if more than one file or a response file was given
+  std::vector<std::string> batch_files { };   // fluid -c a.fl b.fl @list.txt
   /// Constructor.
   Args() = default;
   // Load args from command line into variables.
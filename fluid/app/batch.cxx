@@ -0,0 +1,309 @@
+//
+// Multi-file Batch Compiler code for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// When FLUID is called with more than one project file, or with a response
+// file, all files are compiled within a single process. This saves loading
+// the preferences, registering image types, and creating the main window
+// for every single file, which adds up when a build compiles hundreds of
+// .fl files.
+//
+// FLUID nodes refer to the global project via `Fluid.proj`, so project files
+// can't be compiled in parallel threads. Instead, on platforms that provide
+// fork(), the file list is split between worker processes, each with its
+// own copy of the project state.
+//
+// A hash of the project file, the FLUID version, and the command line
+// switches that change the output is written into the generated header file.
+// Images and data files that the project reads are hashed as well. If the
+// hash is unchanged and both output files exist, the project is skipped,
+// unless `--force` is given.
+
+#include "app/batch.h"
+
+#include "Fluid.h"
+#include "Project.h"
+#include "io/Code_Writer.h"
+#include "io/Project_Reader.h"
+#include "io/Project_Writer.h"
+#include "io/String_Writer.h"
+#include "nodes/Function_Node.h"
+#include "nodes/Widget_Node.h"
+
+#include <FL/Fl.H>
+#include <FL/fl_utf8.h>
+
+#include <zlib.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+#  include <sys/types.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#  define FLUID_BATCH_FORK 1
+#endif
+
+using namespace fld;
+using namespace fld::app;
+
+
+/**
+ Add the contents of a file to a hash value.
+ \param[in] filename file to read
+ \param[inout] crc hash value
+ \return false if the file could not be read
+ */
+static bool crc_file(const char *filename, uLong &crc) {
+  FILE *f = fl_fopen(filename, "rb");
+  if (!f) return false;
+  unsigned char buf[8192];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    crc = crc32(crc, buf, (uInt)n);
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+
+/**
+ Add the name and contents of a file that the project reads to a hash value.
+ Missing files are hashed by name, so that the stamp changes when they appear.
+ \param[in] filename file name relative to the project directory, may be empty
+ \param[inout] crc hash value
+ */
+static void crc_dependency(const std::string &filename, uLong &crc) {
+  if (filename.empty()) return;
+  crc = crc32(crc, (const Bytef*)filename.c_str(), (uInt)filename.size() + 1);
+  if (!crc_file(filename.c_str(), crc))
+    crc = crc32(crc, (const Bytef*)"?", 1);
+}
+
+
+/**
+ Calculate the hash of the project file and the command line switches that
+ change the output.
+ \param[in] filename project file
+ \param[out] crc hash value
+ \return false if the file could not be read
+ */
+static bool batch_stamp(const std::string &filename, uLong &crc) {
+  crc = crc32(0L, Z_NULL, 0);
+  if (!crc_file(filename.c_str(), crc)) return false;
+  char opts[FL_PATH_MAX*2 + 64];
+  snprintf(opts, sizeof(opts), "%.4f|%d|%d|%s|%s", FL_VERSION,
+           Fluid.args.update_file, Fluid.args.compile_strings,
+           Fluid.args.code_filename.c_str(), Fluid.args.header_filename.c_str());
+  crc = crc32(crc, (const Bytef*)opts, (uInt)strlen(opts));
+  return true;
+}
+
+
+/**
+ Add the images and data files of a project that was read to the hash of
+ the project file, and format the stamp.
+ \param[in] proj project that was read
+ \param[in] crc hash value from batch_stamp()
+ \param[out] stamp hexadecimal hash value
+ */
+static void batch_stamp_dependencies(Project &proj, uLong crc, std::string &stamp) {
+  proj.enter_project_dir();
+  for (Node *t = proj.tree.first; t; t = t->next) {
+    if (t->is_widget()) {
+      Widget_Node *w = (Widget_Node*)t;
+      crc_dependency(w->image_name(), crc);
+      crc_dependency(w->inactive_name(), crc);
+    } else if (t->is_a(Type::Data)) {
+      crc_dependency(((Data_Node*)t)->filename(), crc);
+    }
+  }
+  proj.leave_project_dir();
+  char hex[16];
+  snprintf(hex, sizeof(hex), "%08lx", (unsigned long)(crc & 0xffffffffUL));
+  stamp = hex;
+}
+
+
+/**
+ Check if a previous run generated the header file from the same input.
+ \param[in] header_filename generated header file
+ \param[in] stamp hash of the current input
+ \return true if the stamp in the header file matches
+ */
+static bool batch_stamp_matches(const std::string &header_filename, const std::string &stamp) {
+  FILE *f = fl_fopen(header_filename.c_str(), "rb");
+  if (!f) return false;
+  std::string tag = "// fluid input stamp: " + stamp;
+  char line[1024];
+  bool found = false;
+  // The stamp is written right before the include guard.
+  while (fgets(line, sizeof(line), f)) {
+    if (strncmp(line, tag.c_str(), tag.size()) == 0) { found = true; break; }
+    if (strncmp(line, "#ifndef", 7) == 0) break;
+  }
+  fclose(f);
+  return found;
+}
+
+
+/**
+ Read one project file and write the source code, header, and strings files.
+ \param[in] proj reuse this project, it will be reset
+ \param[in] filename project file
+ \param[in] force compile even if the stamp did not change
+ \return 0 if the files were written, 1 if they were up to date, -1 on error
+ */
+static int compile_one(Project &proj, const std::string &filename, bool force) {
+  proj.reset();
+  proj.set_filename(filename);
+  if (!Fluid.args.code_filename.empty()) {
+    proj.code_file_set = 1;
+    proj.code_file_name = Fluid.args.code_filename;
+  }
+  if (!Fluid.args.header_filename.empty()) {
+    proj.header_file_set = 1;
+    proj.header_file_name = Fluid.args.header_filename;
+  }
+
+  uLong crc;
+  if (!batch_stamp(filename, crc)) {
+    fprintf(stderr, "%s : %s\n", filename.c_str(), strerror(errno));
+    return -1;
+  }
+
+  proj.undo.suspend();
+  int ok = fld::io::read_file(proj, filename.c_str(), 0);
+  proj.undo.resume();
+  if (!ok) {
+    fprintf(stderr, "%s : %s\n", filename.c_str(), strerror(errno));
+    return -1;
+  }
+
+  if (Fluid.args.update_file && !fld::io::write_file(proj, filename.c_str(), 0)) {
+    fprintf(stderr, "%s : %s\n", filename.c_str(), strerror(errno));
+    return -1;
+  }
+  if (!Fluid.args.compile_file)
+    return 0;
+
+  std::string stamp;
+  batch_stamp_dependencies(proj, crc, stamp);
+
+  // The output file names are only known after reading the project.
+  std::string code_filename = proj.codefile_path() + proj.codefile_name();
+  std::string header_filename = proj.headerfile_path() + proj.headerfile_name();
+  if (   !force && !Fluid.args.update_file
+      && (fl_access(code_filename.c_str(), 0) == 0)
+      && batch_stamp_matches(header_filename, stamp))
+    return 1;
+
+  if (Fluid.args.compile_strings) {
+    std::string strings_filename = proj.stringsfile_path() + proj.stringsfile_name();
+    if (fld::io::write_strings(proj, strings_filename)) {
+      fprintf(stderr, "%s : %s\n", strings_filename.c_str(), strerror(errno));
+      return -1;
+    }
+  }
+
+  proj.input_stamp = stamp;
+  fld::io::Code_Writer f(proj);
+  if (!f.write_code(code_filename.c_str(), header_filename.c_str())) {
+    fprintf(stderr, "%s and %s: %s\n",
+            code_filename.c_str(), header_filename.c_str(), strerror(errno));
+    return -1;
+  }
+  return 0;
+}
+
+
+/**
+ Compile every n-th project file, starting at the given index.
+ \param[in] files list of all project files
+ \param[in] first index of the first file for this worker
+ \param[in] step number of workers
+ \param[in] force compile even if the stamp did not change
+ \return number of files that failed to compile
+ */
+static int compile_slice(const std::vector<std::string> &files, int first, int step, bool force) {
+  int failed = 0;
+  for (int i = first; i < (int)files.size(); i += step) {
+    Fl_Timestamp start = Fl::now();
+    int ret = compile_one(Fluid.proj, files[i], force);
+    double ms = Fl::seconds_since(start) * 1000.0;
+    if (ret < 0) failed++;
+    printf("%8.2f ms  %-10s  %s\n", ms,
+           ret < 0 ? "failed" : (ret > 0 ? "unchanged" : "written"),
+           files[i].c_str());
+    fflush(stdout);
+  }
+  return failed;
+}
+
+
+/**
+ Compile a list of project files in one FLUID session.
+
+ Every file is read into a freshly reset project and written just like
+ `fluid -c` would do. Errors are reported, but don't stop the remaining
+ files from being compiled. One line per file with the time spent is
+ written to stdout.
+
+ \param[in] files list of project files
+ \param[in] jobs number of worker processes, ignored if fork() is not available
+ \param[in] force compile files, even if the input stamp did not change
+ \return 0 if all files were compiled, 1 if any file failed
+ */
+int fld::app::compile_batch(const std::vector<std::string> &files, int jobs, bool force) {
+  Fl_Timestamp start = Fl::now();
+  int nfiles = (int)files.size();
+  int failed = 0;
+  if (jobs > nfiles) jobs = nfiles;
+#ifdef FLUID_BATCH_FORK
+  if (jobs > 1) {
+    fflush(stdout);
+    fflush(stderr);
+    std::vector<pid_t> workers;
+    for (int j = 0; j < jobs; j++) {
+      pid_t pid = fork();
+      if (pid == 0) {
+        int n = compile_slice(files, j, jobs, force);
+        fflush(stdout);
+        _exit(n > 0 ? 1 : 0);
+      }
+      if (pid < 0) {
+        // could not create a worker, compile the remaining slices here
+        failed += compile_slice(files, j, jobs, force);
+      } else {
+        workers.push_back(pid);
+      }
+    }
+    for (pid_t pid : workers) {
+      int status = 0;
+      while (waitpid(pid, &status, 0) < 0 && errno == EINTR) { }
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        failed++;
+    }
+  } else
+#endif
+  {
+    failed = compile_slice(files, 0, 1, force);
+  }
+  printf("%8.2f ms  total for %d file%s\n", Fl::seconds_since(start) * 1000.0,
+         nfiles, nfiles == 1 ? "" : "s");
+  return failed ? 1 : 0;
+}
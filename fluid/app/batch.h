@@ -0,0 +1,32 @@
+//
+// Multi-file Batch Compiler header for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2025 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef FLUID_APP_BATCH_H
+#define FLUID_APP_BATCH_H
+
+#include <string>
+#include <vector>
+
+namespace fld {
+namespace app {
+
+// Compile a list of project files in one FLUID session.
+int compile_batch(const std::vector<std::string> &files, int jobs, bool force);
+
+} // namespace app
+} // namespace fld
+
+#endif // FLUID_APP_BATCH_H
@@ -638,6 +638,8 @@ int Code_Writer::write_code(const char *s, const char *t, bool to_codeview) {
 // generated by Fast Light User Interface Designer (fluid) version %.4f\n\n";
   write_h(hdr, FL_VERSION);
   crc_printf(hdr, FL_VERSION);
+  if (!proj_.input_stamp.empty() && !write_codeview)
+    write_h("// fluid input stamp: %s\n\n", proj_.input_stamp.c_str());
   {
     // Creating the include guard is more involved than it seems at first glance.
     // The include guard is deduced from header filename. However, if the
@@ -197,28 +197,40 @@ static void cb_Reset(Fl_Button*, void* v) {
 //ﬂ ▲ ----------~=-=~==~~==------------~=--==-~=-~~=~=-=~~~= ▲ ﬂ//
 }
 
-static void cb_convert(Fl_Check_Button* o, void* v) {
-//ﬂ ▼ ---------------------- callback --~~=-=-~-~--=---~-=~= ▼ ﬂ//
+Fl_Choice *image_panel_storage=(Fl_Choice *)0;
+
+static void cb_image_panel_storage(Fl_Choice* o, void* v) {
+//ﬂ ▼ ---------------------- callback ~~-~~--~=~~-~~~-=~~~~= ▼ ﬂ//
   if (v == LOAD) {
     if (current_widget->is_widget() && !current_widget->is_a(Type::Window)) {
       o->activate();
-      o->value(!current_widget->compress_image_);
+      for (int i = 0; i < o->size()-1; i++)
+        if (o->menu()[i].argument() == current_widget->compress_image_)
+          o->value(i);
     } else {
       o->deactivate();
     }
   } else {
     int mod = 0;
+    int mode = (int)o->mvalue()->argument();
     for (Widget_Node *q: Fluid.proj.tree.all_selected_widgets()) {
-      q->compress_image_ = !o->value();
+      q->compress_image_ = mode;
       mod = 1;
     }
     if (mod) Fluid.proj.set_modflag(1);
   }
-//ﬂ ▲ ----------~=---=~-~==~------------~~=~~~=~~=-~~==-=-=~ ▲ ﬂ//
+//ﬂ ▲ ----------~=---=~-~==~------------=~=-~-=-=~~=~-=~=~-~ ▲ ﬂ//
 }
 
+Fl_Menu_Item menu_image_panel_storage[] = {
+ {"original file format", 0,  0, (void*)(1), 0, (uchar)FL_NORMAL_LABEL, 0, 11, 0},
+ {"raw pixel data", 0,  0, (void*)(0), 0, (uchar)FL_NORMAL_LABEL, 0, 11, 0},
+ {"deflated pixel data", 0,  0, (void*)(2), 0, (uchar)FL_NORMAL_LABEL, 0, 11, 0},
+ {0,0,0,0,0,0,0,0,0}
+};
+
 static void cb_bind(Fl_Check_Button* o, void* v) {
-//ﬂ ▼ ---------------------- callback ~~~~~-=~=~---~--~~~~~= ▼ ﬂ//
+//ﬂ ▼ ---------------------- callback ~~--=-~=------~~~-~~~= ▼ ﬂ//
   if (v == LOAD) {
     if (current_widget->is_widget() && !current_widget->is_a(Type::Window)) {
       o->activate();
@@ -337,28 +349,40 @@ static void cb_Reset1(Fl_Button*, void* v) {
 //ﬂ ▲ ----------=~~--~~=---~-----------~=-~~-~~==-~=-~---=-= ▲ ﬂ//
 }
 
-static void cb_convert1(Fl_Check_Button* o, void* v) {
-//ﬂ ▼ ---------------------- callback ~~-==--~~-~~=~-==~-~-- ▼ ﬂ//
+Fl_Choice *image_panel_destorage=(Fl_Choice *)0;
+
+static void cb_image_panel_destorage(Fl_Choice* o, void* v) {
+//ﬂ ▼ ---------------------- callback ~~---=-=--~-=~---=--~= ▼ ﬂ//
   if (v == LOAD) {
     if (current_widget->is_widget() && !current_widget->is_a(Type::Window)) {
       o->activate();
-      o->value(!current_widget->compress_deimage_);
+      for (int i = 0; i < o->size()-1; i++)
+        if (o->menu()[i].argument() == current_widget->compress_deimage_)
+          o->value(i);
     } else {
       o->deactivate();
     }
   } else {
     int mod = 0;
+    int mode = (int)o->mvalue()->argument();
     for (Widget_Node *q: Fluid.proj.tree.all_selected_widgets()) {
-      q->compress_deimage_ = !o->value();
+      q->compress_deimage_ = mode;
       mod = 1;
     }
     if (mod) Fluid.proj.set_modflag(1);
   }
-//ﬂ ▲ ----------~=--~==-~~~=----------~------~~~-~-=~~--~-=~ ▲ ﬂ//
+//ﬂ ▲ ----------~=--~==-~~~=----------~-~~--~--~~~-=~~-~-=-~ ▲ ﬂ//
 }
 
+Fl_Menu_Item menu_image_panel_destorage[] = {
+ {"original file format", 0,  0, (void*)(1), 0, (uchar)FL_NORMAL_LABEL, 0, 11, 0},
+ {"raw pixel data", 0,  0, (void*)(0), 0, (uchar)FL_NORMAL_LABEL, 0, 11, 0},
+ {"deflated pixel data", 0,  0, (void*)(2), 0, (uchar)FL_NORMAL_LABEL, 0, 11, 0},
+ {0,0,0,0,0,0,0,0,0}
+};
+
 static void cb_bind1(Fl_Check_Button* o, void* v) {
-//ﬂ ▼ ---------------------- callback ---=--~-=--~-~~~-=-=~= ▼ ﬂ//
+//ﬂ ▼ ---------------------- callback -~--=~=-=-=~~-------~- ▼ ﬂ//
   if (v == LOAD) {
     if (current_widget->is_widget() && !current_widget->is_a(Type::Window)) {
       o->activate();
@@ -451,14 +475,17 @@ Fl_Double_Window* make_image_panel() {
         o->labelsize(11);
         o->align(Fl_Align(FL_ALIGN_RIGHT|FL_ALIGN_INSIDE));
       } // Fl_Box* o
-      { Fl_Check_Button* o = new Fl_Check_Button(75, 100, 170, 20, "convert to raw pixel data");
-        o->tooltip("if unchecked, keep the image in its original format and store the data as is;"
-" if checked, convert the image and store it as uncompressed RGB or grayscale p"
-"ixel data");
-        o->down_box(FL_DOWN_BOX);
-        o->labelsize(11);
-        o->callback((Fl_Callback*)cb_convert);
-      } // Fl_Check_Button* o
+      { image_panel_storage = new Fl_Choice(75, 100, 170, 20);
+        image_panel_storage->tooltip("original format: keep the image in its original format and store the data as "
+"is; raw pixel data: convert the image and store it as uncompressed RGB or gray"
+"scale pixel data; deflated pixel data: convert the image and store the pixels "
+"zlib compressed in PNG format");
+        image_panel_storage->down_box(FL_BORDER_BOX);
+        image_panel_storage->labelsize(11);
+        image_panel_storage->textsize(11);
+        image_panel_storage->callback((Fl_Callback*)cb_image_panel_storage);
+        image_panel_storage->menu(menu_image_panel_storage);
+      } // Fl_Choice* image_panel_storage
       { Fl_Check_Button* o = new Fl_Check_Button(75, 120, 170, 20, "bind to widget");
         o->tooltip("bind the image to the widget, so it will be deleted with the widget");
         o->down_box(FL_DOWN_BOX);
@@ -527,14 +554,17 @@ Fl_Double_Window* make_image_panel() {
         o->labelsize(11);
         o->align(Fl_Align(FL_ALIGN_RIGHT|FL_ALIGN_INSIDE));
       } // Fl_Box* o
-      { Fl_Check_Button* o = new Fl_Check_Button(75, 240, 170, 20, "convert to raw pixel data");
-        o->tooltip("if unchecked, keep the image in its original format and store the data as is;"
-" if checked, convert the image and store it as uncompressed RGB or grayscale p"
-"ixel data");
-        o->down_box(FL_DOWN_BOX);
-        o->labelsize(11);
-        o->callback((Fl_Callback*)cb_convert1);
-      } // Fl_Check_Button* o
+      { image_panel_destorage = new Fl_Choice(75, 240, 170, 20);
+        image_panel_destorage->tooltip("original format: keep the image in its original format and store the data as "
+"is; raw pixel data: convert the image and store it as uncompressed RGB or gray"
+"scale pixel data; deflated pixel data: convert the image and store the pixels "
+"zlib compressed in PNG format");
+        image_panel_destorage->down_box(FL_BORDER_BOX);
+        image_panel_destorage->labelsize(11);
+        image_panel_destorage->textsize(11);
+        image_panel_destorage->callback((Fl_Callback*)cb_image_panel_destorage);
+        image_panel_destorage->menu(menu_image_panel_destorage);
+      } // Fl_Choice* image_panel_destorage
       { Fl_Check_Button* o = new Fl_Check_Button(75, 260, 170, 20, "bind to widget");
         o->tooltip("bind the image to the widget, so it will be deleted with the widget");
         o->down_box(FL_DOWN_BOX);
@@ -554,7 +584,7 @@ Fl_Double_Window* make_image_panel() {
 }
 
 void run_image_panel() {
-//ﬂ ▼ ------------------------ code --~~~~--~==--~=---=-=~~~ ▼ ﬂ//
+//ﬂ ▼ ------------------------ code --~--~-~~---=~~---~=-~~- ▼ ﬂ//
   if (!image_panel_window)
     make_image_panel();
 
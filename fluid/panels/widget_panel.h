@@ -34,13 +34,18 @@ extern Fl_Box *image_panel_data;
 extern fld::widget::Formula_Input *image_panel_imagew;
 extern fld::widget::Formula_Input *image_panel_imageh;
 #include <FL/Fl_Button.H>
+#include <FL/Fl_Choice.H>
+extern Fl_Choice *image_panel_storage;
 #include <FL/Fl_Check_Button.H>
 extern Fl_Group *image_panel_deimagegroup;
 extern Fl_Box *image_panel_dedata;
 extern fld::widget::Formula_Input *image_panel_deimagew;
 extern fld::widget::Formula_Input *image_panel_deimageh;
+extern Fl_Choice *image_panel_destorage;
 extern Fl_Button *image_panel_close;
 Fl_Double_Window* make_image_panel();
+extern Fl_Menu_Item menu_image_panel_storage[];
+extern Fl_Menu_Item menu_image_panel_destorage[];
 void run_image_panel();
 void flex_margin_cb(Fl_Value_Input* i, void* v, void (*load_margin)(Fl_Flex*,Fl_Value_Input*), int (*update_margin)(Fl_Flex*,int));
 #include <FL/Fl_Wizard.H>
@@ -51,7 +56,6 @@ extern Fl_Group *wp_gui_tab;
 #include <FL/Fl_Input.H>
 extern void label_cb(Fl_Input*, void*);
 extern Fl_Input *wp_gui_label;
-#include <FL/Fl_Choice.H>
 extern Fl_Menu_Item labeltypemenu[];
 extern void labeltype_cb(Fl_Choice*, void*);
 extern Fl_Input *widget_image_input;
@@ -1,7 +1,7 @@
 //
 // Main event handling code for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2025 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -24,6 +24,7 @@
 #include "Fl_Window_Driver.H"
 #include "Fl_System_Driver.H"
 #include "Fl_Timeout.h"
+#include "Fl_Trace.H"
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Tooltip.H>
 #include <FL/fl_draw.H>
@@ -551,7 +552,8 @@ void Fl::Private::run_checks()
 {
   // checks are a bit messy so that add/remove and wait may be called
   // from inside them without causing an infinite loop:
-  if (next_check == first_check) {
+  if (next_check == first_check && next_check) {
+    FL_TRACE_SCOPE("loop", "checks");
     while (next_check) {
       Check* checkp = next_check;
       next_check = checkp->next;
@@ -645,6 +647,26 @@ bool Fl::idle() {
   return (Private::idle_ != nullptr);
 }
 
+double Fl::Private::frame_rate_ = 0;
+double Fl::Private::idle_budget_ = 0;
+
+// frame pacing state, see Fl::frame_rate(double)
+static bool frame_drawn_ = false;     // last_frame_ is valid
+static Fl_Timestamp last_frame_;      // when the last frame started drawing
+static bool idle_frame_valid_ = false;
+static Fl_Timestamp idle_frame_;      // when the current idle budget period began
+static double idle_spent_ = 0;        // seconds of idle callbacks in this period
+
+// Returns the seconds of idle callbacks left in the current frame
+static double idle_time_left() {
+  if (!idle_frame_valid_ || Fl::seconds_since(idle_frame_) >= 1.0 / Fl::Private::frame_rate_) {
+    idle_frame_ = Fl::now();
+    idle_frame_valid_ = true;
+    idle_spent_ = 0;
+  }
+  return Fl::Private::idle_budget_ - idle_spent_;
+}
+
 /*
   Private, undocumented method to run idle callbacks.
 
@@ -671,10 +693,30 @@ bool Fl::idle() {
   ```
   if an event (timeout or button click etc.) handler calls Fl::add_idle()
   or even in Fl::flush() if a draw() method calls Fl::add_idle().
+
+  If Fl::idle_budget() is set, idle callbacks are called in turn until
+  the budget is used up. With a frame rate set by Fl::frame_rate() the
+  budget is shared by all calls during one frame, otherwise each call of
+  this method gets the whole budget.
 */
 void Fl::Private::run_idle() {
   static char in_idle;
   if (Fl::Private::idle_ && !in_idle) {
+    FL_TRACE_SCOPE("loop", "idle");
+    if (idle_budget_ > 0) {
+      double left = (frame_rate_ > 0 ? idle_time_left() : idle_budget_);
+      if (left <= 0) return; // wait for the next frame
+      in_idle = 1;
+      Fl_Timestamp start = Fl::now();
+      double used;
+      do {
+        Fl::Private::idle_();
+        used = Fl::seconds_since(start);
+      } while (Fl::Private::idle_ && used < left);
+      if (frame_rate_ > 0) idle_spent_ += used;
+      in_idle = 0;
+      return;
+    }
     in_idle = 1;
     Fl::Private::idle_(); // call the idle callback stored in Fl::Private::idle_ == Fl::idle()
     in_idle = 0;
@@ -881,6 +923,28 @@ void Fl::redraw() {
   for (Fl_X* i = Fl_X::first; i; i = i->next) i->w->redraw();
 }
 
+// frame statistics, see Fl::frame_draw_histogram()
+static const int frame_histogram_size_ = 64;
+static unsigned long frame_count_ = 0;
+static unsigned long frame_draw_hist_[frame_histogram_size_];
+static unsigned long frame_interval_hist_[frame_histogram_size_];
+
+static int frame_histogram_bucket(double seconds) {
+  int ms = int(seconds * 1000);
+  if (ms < 0) ms = 0;
+  return (ms < frame_histogram_size_ ? ms : frame_histogram_size_ - 1);
+}
+
+// Counts a frame that started drawing at \p start and ended now
+static void record_frame(Fl_Timestamp &start) {
+  if (frame_drawn_)
+    frame_interval_hist_[frame_histogram_bucket(Fl::seconds_between(start, last_frame_))]++;
+  frame_draw_hist_[frame_histogram_bucket(Fl::seconds_since(start))]++;
+  frame_count_++;
+  last_frame_ = start;
+  frame_drawn_ = true;
+}
+
 /**
   Causes all the windows that need it to be redrawn and graphics forced
   out through the pipes.
@@ -894,14 +958,19 @@ void Fl::redraw() {
 */
 void Fl::flush() {
   if (damage()) {
+    FL_TRACE_SCOPE("loop", "flush");
+    Fl_Timestamp start = Fl::now();
+    int drawn = 0;
     damage_ = 0;
     for (Fl_X* i = Fl_X::first; i; i = i->next) {
       Fl_Window* wi = i->w;
       if (Fl_Window_Driver::driver(wi)->wait_for_expose_value) {damage_ = 1; continue;}
       if (!wi->visible_r()) continue;
       if (wi->damage()) {
+        FL_TRACE_SCOPE("draw", wi);
         Fl_Window_Driver::driver(wi)->flush();
         wi->clear_damage();
+        drawn++;
       }
       // destroy damage regions for windows that don't use them:
       if (i->region) {
@@ -909,10 +978,175 @@ void Fl::flush() {
         i->region = 0;
       }
     }
+    if (drawn) record_frame(start);
   }
   screen_driver()->flush();
 }
 
+/*
+  Private method called by the event loop instead of Fl::flush().
+
+  If a frame rate is set by Fl::frame_rate(double), damaged windows are
+  only drawn when the frame interval has elapsed since the last frame.
+  Until then damage keeps accumulating, so that all changes are drawn
+  together in the next frame.
+*/
+void Fl::Private::flush_frame() {
+  if (frame_rate_ > 0 && Fl::damage() && frame_drawn_ &&
+      Fl::seconds_since(last_frame_) < 1.0 / frame_rate_) {
+    screen_driver()->flush();
+    return;
+  }
+  Fl::flush();
+}
+
+/*
+  Private method returning whether the event loop must call idle callbacks
+  without waiting, i.e. idle callbacks are set and, if a frame rate is set,
+  they did not use up Fl::idle_budget() in the current frame.
+*/
+bool Fl::Private::idle_pending() {
+  if (!idle_) return false;
+  if (frame_rate_ <= 0 || idle_budget_ <= 0) return true;
+  return idle_time_left() > 0;
+}
+
+/*
+  Private method limiting the time the event loop waits for events
+  to the start of the next frame, if windows are damaged or idle callbacks
+  wait for a new idle budget. Does nothing if no frame rate is set.
+*/
+double Fl::Private::frame_wait(double time_to_wait) {
+  if (frame_rate_ <= 0) return time_to_wait;
+  double interval = 1.0 / frame_rate_;
+  if (Fl::damage()) {
+    double t = frame_drawn_ ? interval - Fl::seconds_since(last_frame_) : 0.0;
+    if (t < time_to_wait) time_to_wait = (t > 0 ? t : 0.0);
+  }
+  if (idle_ && idle_budget_ > 0 && idle_frame_valid_) {
+    double t = interval - Fl::seconds_since(idle_frame_);
+    if (t < time_to_wait) time_to_wait = (t > 0 ? t : 0.0);
+  }
+  return time_to_wait;
+}
+
+/**
+  Sets the maximum number of times per second the event loop redraws windows.
+
+  Without a frame rate, which is the default, damaged windows are drawn
+  each time Fl::wait() is called. Programs whose windows are damaged very
+  often, e.g. by Fl::awake() callbacks of worker threads, can thus redraw
+  much more often than the display can show, and spend that time drawing
+  instead of handling user input.
+
+  With a frame rate set, Fl::wait() draws damaged windows only if at least
+  1/fps seconds have passed since the last frame was drawn. Damage done
+  in the meantime is collected and drawn in one go. Fl::wait() does not
+  wait longer than the start of the next frame if windows are damaged.
+
+  Calling Fl::flush() directly always draws immediately.
+
+  The frame rate also defines the period of the budget of idle callbacks,
+  see Fl::idle_budget(double).
+
+  \param[in] fps  maximum frames per second, 0 to draw without limit
+  \see Fl::frame_count(), Fl::frame_draw_histogram(int)
+  \version 1.5.0
+*/
+void Fl::frame_rate(double fps) {
+  Private::frame_rate_ = (fps > 0 ? fps : 0);
+}
+
+/**
+  Returns the maximum number of times per second the event loop redraws windows.
+  \see Fl::frame_rate(double)
+  \version 1.5.0
+*/
+double Fl::frame_rate() {
+  return Private::frame_rate_;
+}
+
+/**
+  Sets the time idle callbacks may run each time they are called.
+
+  By default Fl::wait() calls one idle callback, see Fl::add_idle().
+  With a budget set, idle callbacks are called in turn until they ran
+  for \p seconds or all of them were removed. This lets programs do more
+  background work between events without starving the event loop.
+
+  If a frame rate is set by Fl::frame_rate(double), the budget is for each
+  frame: once idle callbacks used it, they are not called again until the
+  next frame begins, and Fl::wait() waits for events until then instead
+  of returning immediately.
+
+  \param[in] seconds  idle time per call or frame, 0 to call one idle callback
+  \version 1.5.0
+*/
+void Fl::idle_budget(double seconds) {
+  Private::idle_budget_ = (seconds > 0 ? seconds : 0);
+}
+
+/**
+  Returns the time idle callbacks may run each time they are called.
+  \see Fl::idle_budget(double)
+  \version 1.5.0
+*/
+double Fl::idle_budget() {
+  return Private::idle_budget_;
+}
+
+/**
+  Returns the number of frames drawn.
+  A frame is a call of Fl::flush() that drew at least one window.
+  Frames are counted from program start or the last call of
+  Fl::reset_frame_statistics().
+  \see Fl::frame_draw_histogram(int), Fl::frame_interval_histogram(int)
+  \version 1.5.0
+*/
+unsigned long Fl::frame_count() {
+  return frame_count_;
+}
+
+/**
+  Returns the number of frames that took \p ms milliseconds to draw.
+  Frames are counted in buckets of one millisecond: the number returned
+  is for frames that took at least \p ms and less than \p ms + 1
+  milliseconds. The last bucket, 63, also counts all longer frames.
+  \param[in] ms  0 to 63
+  \return number of frames, 0 if \p ms is out of range
+  \see Fl::frame_count(), Fl::reset_frame_statistics()
+  \version 1.5.0
+*/
+unsigned long Fl::frame_draw_histogram(int ms) {
+  if (ms < 0 || ms >= frame_histogram_size_) return 0;
+  return frame_draw_hist_[ms];
+}
+
+/**
+  Returns the number of frames that started \p ms milliseconds after the previous one.
+  Buckets are the same as those of Fl::frame_draw_histogram(int).
+  With a frame rate set by Fl::frame_rate(double), short intervals show
+  how well it is respected.
+  \param[in] ms  0 to 63
+  \return number of frames, 0 if \p ms is out of range
+  \version 1.5.0
+*/
+unsigned long Fl::frame_interval_histogram(int ms) {
+  if (ms < 0 || ms >= frame_histogram_size_) return 0;
+  return frame_interval_hist_[ms];
+}
+
+/**
+  Resets the frame count and histograms.
+  \see Fl::frame_count()
+  \version 1.5.0
+*/
+void Fl::reset_frame_statistics() {
+  frame_count_ = 0;
+  memset(frame_draw_hist_, 0, sizeof(frame_draw_hist_));
+  memset(frame_interval_hist_, 0, sizeof(frame_interval_hist_));
+}
+
 
 ////////////////////////////////////////////////////////////////
 // Event handlers:
@@ -1354,7 +1588,11 @@ static int send_event(int event, Fl_Widget* to, Fl_Window* window) {
   }
   int save_x = Fl::e_x; Fl::e_x += dx;
   int save_y = Fl::e_y; Fl::e_y += dy;
-  int ret = to->handle(Fl::e_number = event);
+  int ret;
+  {
+    FL_TRACE_SCOPE("handle", to);
+    ret = to->handle(Fl::e_number = event);
+  }
   Fl::e_number = old_event;
   Fl::e_y = save_y;
   Fl::e_x = save_x;
@@ -1441,6 +1679,7 @@ Fl_Event_Dispatch Fl::event_dispatch()
  */
 int Fl::handle(int e, Fl_Window* window)
 {
+  FL_TRACE_SCOPE("loop", "event dispatch");
   if (e_dispatch) {
     return e_dispatch(e, window);
   } else {
@@ -2297,6 +2536,112 @@ int Fl::draw_GL_text_with_textures() {
   return Private::draw_GL_text_with_textures_;
 }
 
+int Fl::Private::motion_compression_ = 0;
+unsigned long Fl::Private::motion_delivered_ = 0;
+unsigned long Fl::Private::motion_coalesced_ = 0;
+
+// positions of the mouse motion events merged into the current one
+static int *motion_history_ = NULL; // x and y of each event
+static int motion_history_count_ = 0, motion_history_alloc_ = 0;
+
+void Fl::Private::add_motion_history(int x, int y) {
+  if (motion_history_count_ >= motion_history_alloc_) {
+    motion_history_alloc_ = motion_history_alloc_ ? 2 * motion_history_alloc_ : 64;
+    motion_history_ = (int*)realloc(motion_history_, 2 * motion_history_alloc_ * sizeof(int));
+  }
+  motion_history_[2 * motion_history_count_] = x;
+  motion_history_[2 * motion_history_count_ + 1] = y;
+  motion_history_count_++;
+}
+
+void Fl::Private::clear_motion_history() {
+  motion_history_count_ = 0;
+}
+
+/** Sets whether mouse motion events waiting in the event queue are merged.
+  When the mouse (or a pen) moves faster than the program handles the
+  resulting FL_MOVE or FL_DRAG events, many motion events can be waiting in
+  the queue. With motion compression on, consecutive motion events for the
+  same window and with the same mouse buttons and modifier keys are merged,
+  and only the last one is sent to widgets. This avoids handling and redrawing
+  for positions that are already outdated, e.g. while dragging an Fl_Tile
+  border or an Fl_Slider.
+
+  Programs that need every position, e.g. to draw a stroke, can read the
+  positions of the merged events with Fl::event_motion_history() while they
+  handle FL_MOVE or FL_DRAG.
+
+  Motion events are merged before the system event handlers are called,
+  so these only see the last event, too.
+
+  Default is off.
+  \note Currently only implemented on the X11 platform.
+  \param on non-zero to merge queued motion events
+  \see Fl::motion_statistics()
+  \version 1.5.0
+ */
+void Fl::motion_compression(int on) {
+  Private::motion_compression_ = on;
+}
+
+/** Returns whether mouse motion events waiting in the event queue are merged.
+  \see Fl::motion_compression(int)
+  \version 1.5.0
+ */
+int Fl::motion_compression() {
+  return Private::motion_compression_;
+}
+
+/** Returns the number of mouse motion events merged into the current event.
+  This is only non-zero while an FL_MOVE or FL_DRAG event is handled, and
+  only if Fl::motion_compression() is on.
+  \see Fl::event_motion_history(int i, int &x, int &y)
+  \version 1.5.0
+ */
+int Fl::event_motion_history_count() {
+  return motion_history_count_;
+}
+
+/** Gets the mouse position of one of the motion events merged into the current event.
+  Positions are relative to the window of the current event, like
+  Fl::event_x() and Fl::event_y(). The oldest position has index 0,
+  the position of the current event itself is not included.
+  \param[in] i index, from 0 to Fl::event_motion_history_count() - 1
+  \param[out] x,y mouse position
+  \see Fl::motion_compression(int)
+  \version 1.5.0
+ */
+void Fl::event_motion_history(int i, int &x, int &y) {
+  if (i < 0 || i >= motion_history_count_) {
+    x = Fl::e_x;
+    y = Fl::e_y;
+    return;
+  }
+  x = motion_history_[2 * i];
+  y = motion_history_[2 * i + 1];
+}
+
+/** Gets the number of mouse motion events sent to widgets and merged into others.
+  The counts start at program start or at the last call of Fl::reset_motion_statistics().
+  \param[out] delivered motion events sent as FL_MOVE or FL_DRAG
+  \param[out] coalesced motion events merged into later ones
+  \note Motion events are only counted on the X11 platform.
+  \see Fl::motion_compression(int)
+  \version 1.5.0
+ */
+void Fl::motion_statistics(unsigned long &delivered, unsigned long &coalesced) {
+  delivered = Private::motion_delivered_;
+  coalesced = Private::motion_coalesced_;
+}
+
+/** Resets the counts returned by Fl::motion_statistics().
+  \version 1.5.0
+ */
+void Fl::reset_motion_statistics() {
+  Private::motion_delivered_ = 0;
+  Private::motion_coalesced_ = 0;
+}
+
 int Fl::dnd()
 {
   return Fl::screen_driver()->dnd();
@@ -1,7 +1,7 @@
 //
 // Fl_BMP_Image class for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 2011-2022 by Bill Spitzak and others.
+// Copyright 2011-2026 by Bill Spitzak and others.
 // Copyright 1997-2010 by Easy Software Products.
 // Image support by Matthias Melcher, Copyright 2000-2009.
 //
@@ -111,6 +111,61 @@ Fl_BMP_Image::Fl_BMP_Image(const char *imagename, const unsigned char *data, con
   }
 }
 
+/**
+  Decodes a BMP image file row by row without creating an image.
+
+  The callback gets the size of the image first and then bands of decoded
+  rows, as described for Fl_Image_Rows. Unless the callback sets its own
+  target buffer, only a few rows are kept in memory at any time, so this
+  works for images that are too large for Fl_BMP_Image (see
+  Fl_RGB_Image::max_size()). BMP files with a transparency mask are the
+  exception: all rows are kept and passed to the callback at the end.
+
+  Rows of most BMP files are stored bottom-up, hence the callback gets
+  the bands of these files from the bottom of the image to the top.
+
+  \param[in] filename  name of the BMP file
+  \param[in] cb        callback that receives the decoded rows
+  \param[in] data      user data passed to \p cb
+  \return 0 on success, Fl_Image::ERR_FILE_ACCESS or Fl_Image::ERR_FORMAT on
+    errors, or Fl_Image_Rows::STOP if \p cb stopped decoding
+
+  \see Fl_PNG_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+  \version 1.5.0
+*/
+int Fl_BMP_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+{
+  Fl_Image_Reader rdr;
+  if (rdr.open(filename) == -1)
+    return ERR_FILE_ACCESS;
+  Fl_Image_Band band(cb, data);
+  Fl_BMP_Image img;
+  img.load_bmp_(rdr, 0, 0, &band);
+  return band.result() ? band.result() : img.ld();
+}
+
+/**
+  Decodes a BMP image in memory row by row without creating an image.
+  \param[in] buffer    start of the BMP image in memory
+  \param[in] length    size in bytes of the BMP image in memory
+  \param[in] cb        callback that receives the decoded rows
+  \param[in] data      user data passed to \p cb
+  \return 0 on success, Fl_Image::ERR_FILE_ACCESS or Fl_Image::ERR_FORMAT on
+    errors, or Fl_Image_Rows::STOP if \p cb stopped decoding
+  \see Fl_BMP_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+  \version 1.5.0
+*/
+int Fl_BMP_Image::decode(const unsigned char *buffer, long length, Fl_Image_Rows_Cb cb, void *data)
+{
+  Fl_Image_Reader rdr;
+  if (rdr.open(NULL, buffer, (size_t)length) == -1)
+    return ERR_FILE_ACCESS;
+  Fl_Image_Band band(cb, data);
+  Fl_BMP_Image img;
+  img.load_bmp_(rdr, 0, 0, &band);
+  return band.result() ? band.result() : img.ld();
+}
+
 /*
   This macro can be used to check for end of file (EOF) or other read errors.
   In case of an error or EOF an error message is issued and the image loading
@@ -128,8 +183,10 @@ Fl_BMP_Image::Fl_BMP_Image(const char *imagename, const unsigned char *data, con
   This method reads BMP image data and creates an RGB or RGBA image. The BMP
   format supports only 1 bit for alpha. To avoid code duplication, we use
   an Fl_Image_Reader that reads data from either a file or from memory.
+  If band is given, rows are passed to its callback instead of being stored
+  in the image.
 */
-void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr, int ico_height, int ico_width)
+void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr, int ico_height, int ico_width, Fl_Image_Band *band)
 {
   int   info_size,        // Size of info header
         width,            // Width of image (pixels)
@@ -277,13 +334,24 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr, int ico_height, int ico_width
   if (offbits) rdr.seek((unsigned int)offbits);
   CHECK_ERROR
 
-  if (((size_t)width) * height * bDepth > max_size() ) {
-    Fl::warning("BMP file \"%s\" is too large!\n", rdr.name());
-    ld(ERR_FORMAT);
-    return;
+  if (band) {
+    // the mask is read after all rows, so these must stay in memory
+    if (band->begin(width, height, bDepth, 1, havemask != 0))
+      return;
+    if (band->error()) {
+      Fl::warning("BMP file \"%s\" is too large!\n", rdr.name());
+      ld(ERR_FORMAT);
+      return;
+    }
+  } else {
+    if (((size_t)width) * height * bDepth > max_size() ) {
+      Fl::warning("BMP file \"%s\" is too large!\n", rdr.name());
+      ld(ERR_FORMAT);
+      return;
+    }
+    array = new uchar[width * height * bDepth];
+    alloc_array = 1;
   }
-  array = new uchar[width * height * bDepth];
-  alloc_array = 1;
 
   // Read the image data...
   color = 0;
@@ -301,7 +369,10 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr, int ico_height, int ico_width
   }
 
   for (y = start_y; y != end_y; y += row_order) {
-    ptr = (uchar *)array + y * width * bDepth;
+    if (band)
+      ptr = band->row(y);
+    else
+      ptr = (uchar *)array + y * width * bDepth;
 
     switch (depth)
     {
@@ -504,11 +575,16 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr, int ico_height, int ico_width
         break;
     }
     CHECK_ERROR
+    if (band && !havemask && band->done(y))
+      return;
   }
 
   if (havemask) {
     for (y = height - 1; y >= 0; y --) {
-      ptr = (uchar *)array + y * width * bDepth + 3;
+      if (band)
+        ptr = band->row(y) + 3;
+      else
+        ptr = (uchar *)array + y * width * bDepth + 3;
       for (x = width, bit = 128; x > 0; x --, ptr += bDepth) {
         if (bit == 128) byte = rdr.read_byte();
         if (byte & bit)
@@ -528,6 +604,9 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr, int ico_height, int ico_width
 
   CHECK_ERROR
 
+  if (band && havemask && band->deliver(0, height))
+    return;
+
   // Success: set image attributes and return
   // File is closed when returning...
 
@@ -1,7 +1,7 @@
 //
 // Base Browser widget class for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2016 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -390,6 +390,7 @@ J1:
   bbox(X, Y, W, H);
 
   fl_push_clip(X, Y, W, H);
+  fl_text_batch_begin(); // send the text of all lines at once
   // for each line, draw it if full redraw or scrolled.  Erase background
   // if not a full redraw or if it is selected:
   void* l = top();
@@ -416,6 +417,7 @@ J1:
     }
     yy += hh;
   }
+  fl_text_batch_end();
   // erase the area below last line:
   if (!(damage()&FL_DAMAGE_ALL) && yy < H) {
     fl_push_clip(X, yy+Y, W, H-yy);
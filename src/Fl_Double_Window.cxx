@@ -72,6 +72,29 @@ void Fl_Double_Window::flush()
 }
 
 
+/**
+  Returns the number of pixels copied from the offscreen buffer to the window.
+  The count is in drawing units, that is, it includes the GUI scaling factor.
+  It allows to check how much of the window is copied when only part of it
+  is damaged. Currently, only the X11 platform counts these pixels.
+  \see blitted_pixels(unsigned long long)
+  \version 1.5.0
+*/
+unsigned long long Fl_Double_Window::blitted_pixels() const {
+  return Fl_Window_Driver::driver(this)->blitted_pixels_;
+}
+
+/**
+  Sets the count of pixels copied from the offscreen buffer to the window.
+  Use 0 to reset the count.
+  \see blitted_pixels()
+  \version 1.5.0
+*/
+void Fl_Double_Window::blitted_pixels(unsigned long long n) {
+  Fl_Window_Driver::driver(this)->blitted_pixels_ = n;
+}
+
+
 /**
   The destructor <I>also deletes all the children</I>. This allows a
   whole tree to be deleted at once, without having to keep a pointer to
@@ -2,7 +2,7 @@
 // Fl_File_Browser routines.
 //
 // Copyright 1999-2010 by Michael Sweet.
-// Copyright 2016 by Bill Spitzak and others.
+// Copyright 2016-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -22,6 +22,7 @@
 //   Fl_File_Browser::item_draw()       - Draw a list item.
 //   Fl_File_Browser::Fl_File_Browser() - Create a Fl_File_Browser widget.
 //   Fl_File_Browser::load()            - Load a directory into the browser.
+//   Fl_File_Browser::cancel_load()     - Stop loading a directory.
 //   Fl_File_Browser::filter()          - Set the filename filter.
 //
 
@@ -36,10 +37,143 @@
 #include <FL/filename.H>
 #include <FL/fl_string_functions.h>
 #include <FL/Fl_Image.H>        // icon
+#include <FL/fl_utf8.h>         // fl_stat()
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <atomic>
 #include "flstring.h"
 
+
+//
+// Directory listings...
+//
+// Fl_System_Driver::file_browser_load_directory() sorts the directory
+// entries and checks which ones are directories. This can take very long
+// for network directories or directories with many entries, so load() runs
+// it in a background thread when async_load() is set. The listings of the
+// last directories loaded are reused as long as their modification time
+// doesn't change.
+//
+
+enum {
+  LISTING_SCANNING,             // the directory is being read
+  LISTING_DONE,                 // the entries are available
+  LISTING_ABANDONED             // nobody needs it, the scanning thread frees it
+};
+
+struct Fl_File_Listing {
+  char            *directory;   // directory name as given to load()
+  Fl_File_Sort_F  *sort;        // sort function
+  int             sorted;       // the entries are sorted already
+  time_t          mtime;        // directory modification time before reading it
+  int             cacheable;    // can be reused while mtime doesn't change
+  dirent          **files;      // sorted entries, directory names end with '/'
+  int             num_files;    // number of entries, <= 0 on error
+  char            errmsg[1024]; // error message when num_files <= 0
+  int             refs;         // references held by the main thread
+  std::atomic<int> state;       // LISTING_SCANNING, LISTING_DONE or LISTING_ABANDONED
+};
+
+static void free_listing(Fl_File_Listing *l) {
+  for (int i = 0; i < l->num_files; i ++)
+    free(l->files[i]);
+  if (l->files) free(l->files);
+  free(l->directory);
+  delete l;
+}
+
+// Reads the directory entries, in a background thread or not.
+// The sort function may not be thread-safe, so a background thread leaves
+// the entries unsorted and sort_listing() sorts them in the main thread.
+static void scan_listing(void *data) {
+  Fl_File_Listing *l = (Fl_File_Listing *)data;
+  char filename[4096];
+  l->num_files = Fl::system_driver()->file_browser_load_directory(l->directory,
+                                                                 filename, sizeof(filename),
+                                                                 &l->files,
+                                                                 l->sorted ? l->sort : NULL,
+                                                                 l->errmsg, sizeof(l->errmsg));
+  int expected = LISTING_SCANNING;
+  if (!l->state.compare_exchange_strong(expected, LISTING_DONE))
+    free_listing(l); // the browser doesn't need it any more
+}
+
+// Sorts the entries of a listing read by a background thread
+static void sort_listing(Fl_File_Listing *l) {
+  if (l->sorted) return;
+  if (l->sort && l->num_files > 1)
+    qsort(l->files, l->num_files, sizeof(dirent *),
+          (int (*)(const void *, const void *))l->sort);
+  l->sorted = 1;
+}
+
+static void release_listing(Fl_File_Listing *l) {
+  if (--l->refs > 0) return;
+  int expected = LISTING_SCANNING;
+  if (!l->state.compare_exchange_strong(expected, LISTING_ABANDONED))
+    free_listing(l); // else the scanning thread frees it when done
+}
+
+static time_t directory_mtime(const char *directory) {
+  struct stat s;
+  return fl_stat(directory, &s) ? 0 : s.st_mtime;
+}
+
+// Most recently used listings first
+static const int listing_cache_size = 4;
+static Fl_File_Listing *listing_cache[listing_cache_size];
+
+static int cache_index(Fl_File_Listing *l) {
+  for (int i = 0; i < listing_cache_size; i ++)
+    if (listing_cache[i] == l) return i;
+  return -1;
+}
+
+static void uncache_listing(int i) {
+  Fl_File_Listing *l = listing_cache[i];
+  memmove(listing_cache + i, listing_cache + i + 1,
+          (listing_cache_size - i - 1) * sizeof(Fl_File_Listing *));
+  listing_cache[listing_cache_size - 1] = NULL;
+  release_listing(l);
+}
+
+// Drops a reference to a listing after keeping it in the cache if it can be reused
+static void cache_listing(Fl_File_Listing *l) {
+  if (l->state.load() == LISTING_DONE && l->cacheable && l->num_files > 0 &&
+      cache_index(l) < 0) {
+    if (listing_cache[listing_cache_size - 1])
+      uncache_listing(listing_cache_size - 1);
+    memmove(listing_cache + 1, listing_cache,
+            (listing_cache_size - 1) * sizeof(Fl_File_Listing *));
+    listing_cache[0] = l;
+    return; // the cache takes over the reference
+  }
+  release_listing(l);
+}
+
+// Returns a new reference to the cached listing of a directory, or NULL
+static Fl_File_Listing *cached_listing(const char *directory, Fl_File_Sort_F *sort) {
+  for (int i = 0; i < listing_cache_size && listing_cache[i]; i ++) {
+    Fl_File_Listing *l = listing_cache[i];
+    if (l->sort != sort || strcmp(l->directory, directory)) continue;
+    if (l->mtime != directory_mtime(directory)) {
+      uncache_listing(i); // the directory has changed
+      return NULL;
+    }
+    // move it to the front
+    memmove(listing_cache + 1, listing_cache, i * sizeof(Fl_File_Listing *));
+    listing_cache[0] = l;
+    l->refs ++;
+    return l;
+  }
+  return NULL;
+}
+
+// Number of entries added to the browser at a time when loading in the background
+static const int load_batch = 2000;
+
 //
 // 'Fl_File_Browser::full_height()' - Return the height of the list.
 //
@@ -250,6 +384,16 @@ Fl_File_Browser::item_draw(void *p,     // I - List item data
   }
   else
   {
+    // Look up the icon when the line is drawn for the first time...
+    if (line_flags & BLINE_ICON_PENDING) {
+      bline_flags(line) &= ~BLINE_ICON_PENDING;
+      if (!line_data && directory_) {
+        char filename[4096];
+        fl_snprintf(filename, sizeof(filename), "%s/%s", directory_, line_txt);
+        line_data = bline_data(line) = Fl_File_Icon::find(filename);
+      }
+    }
+
     // Draw the icon if it is set...
     if (line_data)
       ((Fl_File_Icon *)line_data)->draw(X, Y + (H - iconsize_) / 2,
@@ -347,16 +491,25 @@ Fl_File_Browser::Fl_File_Browser(int        X,  // I - Upper-lefthand X coordina
 {
   // Initialize the filter pattern, current directory, and icon size...
   pattern_   = "*";
-  directory_ = "";
+  directory_ = NULL;
   iconsize_  = (uchar)(3 * textsize() / 2);
   filetype_  = FILES;
   errmsg_    = NULL;
+  async_     = 0;
+  listing_   = NULL;
+  next_      = 0;
+  num_dirs_  = 0;
+  num_loaded_ = 0;
+  load_cb_   = NULL;
+  load_data_ = NULL;
 }
 
 
 // DTOR
 Fl_File_Browser::~Fl_File_Browser() {
+  cancel_load();
   errmsg(NULL);       // free()s prev errmsg, if any
+  free((void*)directory_);
 }
 
 
@@ -374,6 +527,7 @@ void Fl_File_Browser::errmsg(const char* emsg) {
 /**
   Loads the specified directory into the browser. If icons have been
   loaded then the correct icon is associated with each file in the list.
+  Icons are looked up when their line is drawn for the first time.
 
   If directory is "", all mount points (unix) or drive letters (Windows)
   are listed.
@@ -381,6 +535,17 @@ void Fl_File_Browser::errmsg(const char* emsg) {
   The sort argument specifies a sort function to be used with
   fl_filename_list().
 
+  When async_load() is set, the directory is read by a background thread
+  and its entries are added to the browser in batches. load() then returns
+  0 unless the listing of the directory was already available, and the
+  load_callback() is called when all entries have been added. Loading
+  another directory or calling cancel_load() stops loading. The sort
+  function is always called by the main thread. Where FLTK can't start
+  threads (currently Windows), the directory is read before load() returns.
+
+  Listings of recently loaded directories are reused while the modification
+  time of the directory doesn't change.
+
   Return value is the number of filename entries, or 0 if none.
   On error, 0 is returned, and errmsg() has OS error string if non-NULL.
 */
@@ -388,22 +553,24 @@ int                                             // O - Number of files loaded
 Fl_File_Browser::load(const char     *directory,// I - Directory to load
                       Fl_File_Sort_F *sort)     // I - Sort function to use
 {
-  int           i;                              // Looping var
   int           num_files;                      // Number of files in directory
-  int           num_dirs;                       // Number of directories in list
   char          filename[4096];                 // Current file
   Fl_File_Icon  *icon;                          // Icon to use
 
+  cancel_load();
   errmsg(NULL); // clear errors first
+  num_loaded_ = 0;
 
 //  printf("Fl_File_Browser::load(\"%s\")\n", directory);
 
   clear();
 
-  directory_ = directory;
+  free((void*)directory_);
+  directory_ = directory ? fl_strdup(directory) : NULL;
 
   if (!directory) {
     errmsg("NULL directory specified");
+    if (load_cb_) load_cb_(this, load_data_);
     return 0;
   }
 
@@ -415,44 +582,118 @@ Fl_File_Browser::load(const char     *directory,// I - Directory to load
     if ((icon = Fl_File_Icon::find("any", Fl_File_Icon::DEVICE)) == NULL)
       icon = Fl_File_Icon::find("any", Fl_File_Icon::DIRECTORY);
     num_files = Fl::system_driver()->file_browser_load_filesystem(this, filename, (int)sizeof(filename), icon);
-  } else {
-    dirent **files;        // Files in in directory
-    char emsg[1024] = "";
+    num_loaded_ = num_files > 0 ? num_files : 0;
+    if (load_cb_) load_cb_(this, load_data_);
+    return num_files;
+  }
 
-    // Build the file list, check for errors
-    num_files = Fl::system_driver()->file_browser_load_directory(directory_,
-                                                                 filename, sizeof(filename),
-                                                                 &files, sort,
-                                                                 emsg, sizeof(emsg));
-    // printf("Fl_File_Browser::load(dir='%s',filename='%s'): failed, emsg='%s'\n", directory_, filename, emsg);
+  // Get the directory entries from the cache, or read them...
+  listing_ = cached_listing(directory_, sort);
+  if (!listing_) {
+    listing_ = new Fl_File_Listing;
+    listing_->directory = fl_strdup(directory_);
+    listing_->sort      = sort;
+    listing_->sorted    = 1;
+    listing_->mtime     = directory_mtime(directory_);
+    // a directory modified during the last seconds may change again unnoticed
+    listing_->cacheable = listing_->mtime && listing_->mtime < time(NULL) - 1;
+    listing_->files     = NULL;
+    listing_->num_files = 0;
+    listing_->errmsg[0] = '\0';
+    listing_->refs      = 1;
+    listing_->state     = LISTING_SCANNING;
+    if (async_) {
+      listing_->sorted = 0;
+      if (Fl::system_driver()->start_thread(scan_listing, listing_))
+        scan_listing(listing_);
+    } else
+      scan_listing(listing_);
+  }
+  next_     = 0;
+  num_dirs_ = 0;
 
-    if (num_files <= 0) {
-      errmsg(emsg);
-      return 0;
-    }
+  if (!async_) {
+    add_entries(listing_->num_files);
+    return load_done();
+  }
+
+  if (listing_->state.load() == LISTING_DONE) {
+    add_entries(load_batch);
+    if (next_ >= listing_->num_files) return load_done();
+  }
+  Fl::add_timeout(0.0, load_timeout_cb, this);
+  return 0;
+}
 
-    for (i = 0, num_dirs = 0; i < num_files; i ++) {
-      if (strcmp(files[i]->d_name, "./")) {
-        fl_snprintf(filename, sizeof(filename), "%s/%s", directory_, files[i]->d_name);
-
-        icon = Fl_File_Icon::find(filename);
-        if ((icon && icon->type() == Fl_File_Icon::DIRECTORY) ||
-            Fl::system_driver()->filename_isdir_quick(filename)) {
-          num_dirs ++;
-          insert(num_dirs, files[i]->d_name, icon);
-        } else if (filetype_ == FILES &&
-                   fl_filename_match(files[i]->d_name, pattern_)) {
-          add(files[i]->d_name, icon);
-        }
-      }
 
-      free(files[i]);
+/**
+  Stops loading a directory in the background.
+  The entries added so far stay in the browser and the load_callback()
+  is not called. A directory that is still being read is read to the end
+  by its thread, but its entries are discarded.
+  \version 1.5.0
+*/
+void Fl_File_Browser::cancel_load() {
+  if (!listing_) return;
+  Fl::remove_timeout(load_timeout_cb, this);
+  cache_listing(listing_);
+  listing_ = NULL;
+}
+
+
+// Adds up to max entries of the directory being loaded to the browser.
+// Directories come first, then files matching the filter pattern.
+void Fl_File_Browser::add_entries(int max) {
+  sort_listing(listing_);
+  dirent        **files = listing_->files;  // Files in directory
+  int           num_files = listing_->num_files;
+
+  for (; next_ < num_files && max > 0; next_ ++, max --) {
+    const char *name = files[next_]->d_name;
+    if (!strcmp(name, "./")) continue;
+
+    // Directory names end with a slash, no need to stat() them...
+    int len = (int) strlen(name);
+    if (len > 0 && name[len - 1] == '/') {
+      num_dirs_ ++;
+      insert(num_dirs_, name);
+      bline_flags(find_line(num_dirs_)) |= BLINE_ICON_PENDING;
+    } else if (filetype_ == FILES && fl_filename_match(name, pattern_)) {
+      add(name);
+      bline_flags(find_line(size())) |= BLINE_ICON_PENDING;
     }
+  }
+}
+
 
-    free(files);
+// Ends loading a directory and returns its number of entries
+int Fl_File_Browser::load_done() {
+  int num_files = listing_->num_files;
+
+  if (num_files <= 0) errmsg(listing_->errmsg);
+  cache_listing(listing_);
+  listing_ = NULL;
+
+  num_loaded_ = num_files > 0 ? num_files : 0;
+  if (load_cb_) load_cb_(this, load_data_);
+  return num_loaded_;
+}
+
+
+// Waits for the background thread, then adds entries in batches
+void Fl_File_Browser::load_timeout_cb(void *data) {
+  Fl_File_Browser *fb = (Fl_File_Browser *)data;
+
+  if (fb->listing_->state.load() == LISTING_SCANNING) {
+    Fl::repeat_timeout(0.05, load_timeout_cb, data);
+    return;
   }
 
-  return (num_files);
+  fb->add_entries(load_batch);
+  if (fb->next_ < fb->listing_->num_files)
+    Fl::repeat_timeout(0.0, load_timeout_cb, data);
+  else
+    fb->load_done();
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Fl_File_Chooser dialog for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2024 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -201,6 +201,7 @@ Fl_File_Chooser::Fl_File_Chooser(const char *pathname, const char *pattern, int
         fileList->box(FL_DOWN_BOX);
         fileList->callback((Fl_Callback*)cb_fileList);
         fileList->window()->hotspot(fileList);
+        fileList->load_callback(fileListLoadedCB, this);
       } // Fl_File_Browser* fileList
       { errorBox = new Fl_Box(10, 45, 295, 225, "dynamic error display");
         errorBox->box(FL_DOWN_BOX);
@@ -311,6 +312,7 @@ Fl_File_Chooser::Fl_File_Chooser(const char *pathname, const char *pattern, int
   } // Fl_Double_Window* favWindow
   callback_ = 0;
   data_ = 0;
+  keep_filename_ = 0;
   directory_[0] = 0;
   window->size_range(window->w(), window->h());
   type(type_val);
@@ -332,6 +334,14 @@ Fl_File_Chooser::~Fl_File_Chooser() {
   delete favWindow;
 }
 
+void Fl_File_Chooser::async_load(int a) {
+  fileList->async_load(a);
+}
+
+int Fl_File_Chooser::async_load() const {
+  return fileList->async_load();
+}
+
 void Fl_File_Chooser::callback(void (*cb)(Fl_File_Chooser *, void *), void *d ) {
   callback_ = cb;
   data_     = d;
@@ -2,7 +2,7 @@
 // More Fl_File_Chooser routines.
 //
 // Copyright 1999-2007 by Michael Sweet.
-// Copyright 2008-2024 by Bill Spitzak and others.
+// Copyright 2008-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -197,6 +197,19 @@
 /** \fn Fl_File_Chooser::~Fl_File_Chooser()
   Destroys the widget and frees all memory used by it.*/
 
+/** \fn void Fl_File_Chooser::async_load(int a)
+  Sets whether directories are read in the background, see
+  Fl_File_Browser::async_load(int). This is off by default.
+  While a directory is being loaded, count() and value() only see
+  the files listed so far.
+  \version 1.5.0
+*/
+
+/** \fn int Fl_File_Chooser::async_load() const
+  Returns nonzero if directories are read in the background.
+  \version 1.5.0
+*/
+
 /** \fn void Fl_File_Chooser::color(Fl_Color c)
   Sets the background color of the Fl_File_Browser list.*/
 
@@ -326,6 +339,7 @@
 //   Fl_File_Chooser::favoritesButtonCB() - Handle favorites selections.
 //   Fl_File_Chooser::fileListCB()        - Handle clicks (and double-clicks)
 //                                          in the Fl_File_Browser.
+//   Fl_File_Chooser::fileListLoaded()    - Finish showing a directory.
 //   Fl_File_Chooser::fileNameCB()        - Handle text entry in the FileBrowser.
 //   Fl_File_Chooser::showChoiceCB()      - Handle show selections.
 //   compare_dirnames()                   - Compare two directory names.
@@ -1091,18 +1105,9 @@ Fl_File_Chooser::rescan()
   else
     okButton->deactivate();
 
-  // Build the file list...
-  if ( fileList->load(directory_, sort) <= 0 ) {
-    if ( fileList->errmsg() ) errorBox->label(fileList->errmsg());     // show OS errormsg when possible
-    else                      errorBox->label("No files found...");
-    show_error_box(1);
-  } else {
-    show_error_box(0);
-  }
-
-  if (Fl::system_driver()->dot_file_hidden() && !showHiddenButton->value()) remove_hidden_files();
-  // Update the preview box...
-  update_preview();
+  // Build the file list, fileListLoaded() is called when it is complete...
+  keep_filename_ = 0;
+  fileList->load(directory_, sort);
 }
 
 /**
@@ -1118,42 +1123,67 @@ void Fl_File_Chooser::rescan_keep_filename()
     return;
   }
 
+  // Build the file list, fileListLoaded() selects the file when it is complete...
+  keep_filename_ = 1;
+  fileList->load(directory_, sort);
+}
+
+
+//
+// 'Fl_File_Chooser::fileListLoaded()' - Finish showing a directory.
+//
+
+void
+Fl_File_Chooser::fileListLoaded()
+{
   int   i;
-  char  pathname[FL_PATH_MAX];          // New pathname for filename field
-  strlcpy(pathname, fn, sizeof(pathname));
 
-  // Build the file list...
-  if (fileList->load(directory_, sort) <= 0) {
-    if ( fileList->errmsg() ) errorBox->label(fileList->errmsg());     // show OS errormsg when possible
-    else                      errorBox->label("No files found...");
+  if ( fileList->errmsg() ) {
+    errorBox->label(fileList->errmsg());     // show OS errormsg when possible
+    show_error_box(1);
+  } else if ( !fileList->num_loaded() ) {
+    errorBox->label("No files found...");
     show_error_box(1);
   } else {
     show_error_box(0);
   }
+
   if (Fl::system_driver()->dot_file_hidden() && !showHiddenButton->value()) remove_hidden_files();
   // Update the preview box...
   update_preview();
 
-  // and select the chosen file
+  // and select the file in the filename field, if any
   char found = 0;
-  char *slash = strrchr(pathname, '/');
+  const char *slash = strrchr(fileName->value(), '/');
   if (slash)
     slash++;
   else
-    slash = pathname;
-  for (i = 1; i <= fileList->size(); i ++)
-    if ( (Fl::system_driver()->case_insensitive_filenames() ? strcasecmp(fileList->text(i), slash) : strcmp(fileList->text(i), slash)) == 0) {
-      fileList->topline(i);
-      fileList->select(i);
-      found = 1;
-      break;
-    }
+    slash = fileName->value();
+  if (*slash) {
+    for (i = 1; i <= fileList->size(); i ++)
+      if ( (Fl::system_driver()->case_insensitive_filenames() ? strcasecmp(fileList->text(i), slash) : strcmp(fileList->text(i), slash)) == 0) {
+        fileList->topline(i);
+        fileList->select(i);
+        found = 1;
+        break;
+      }
+  }
 
   // update OK button activity
-  if (found || type_ & CREATE)
-    okButton->activate();
-  else
-    okButton->deactivate();
+  if (keep_filename_) {
+    if (found || type_ & CREATE)
+      okButton->activate();
+    else
+      okButton->deactivate();
+    keep_filename_ = 0;
+  }
+}
+
+
+void
+Fl_File_Chooser::fileListLoadedCB(Fl_File_Browser *, void *fc)
+{
+  ((Fl_File_Chooser *)fc)->fileListLoaded();
 }
 
 
@@ -1569,6 +1599,7 @@ void Fl_File_Chooser::show()
 
 void Fl_File_Chooser::hide() {
   Fl::remove_timeout((Fl_Timeout_Handler)previewCB, this);
+  fileList->cancel_load();
   Fl_Shared_Image *oldimage = (Fl_Shared_Image*)previewBox->image();
   if (oldimage) oldimage->release();
   previewBox->image(NULL);
@@ -1,7 +1,7 @@
 //
 // OpenGL visual selection code for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2021 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -61,6 +61,7 @@ void Fl_Gl_Window_Driver::del_context(GLContext ctx) {
       break;
     }
   }
+  remove_glyph_atlases(ctx);
   if (!nContext) gl_remove_displaylist_fonts();
 }
 
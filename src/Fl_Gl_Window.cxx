@@ -1,7 +1,7 @@
 //
 // OpenGL window code for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2022 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -123,6 +123,7 @@ void Fl_Gl_Window::make_current() {
   // make_current() for proper initialization.
   if (!shown()) return;
   pGlWindowDriver->make_current_before();
+  Fl_Gl_Window_Driver::flush_glyph_atlases(context_);
   if (!context_) {
     mode_ &= ~NON_LOCAL_CONTEXT;
     context_ = pGlWindowDriver->create_gl_context(this, g);
@@ -255,6 +256,7 @@ void Fl_Gl_Window::flush() {
         static Fl_Gl_Window* ortho_window = 0;
         int orthoinit = !ortho_context;
         if (orthoinit) ortho_context = pGlWindowDriver->create_gl_context(this, g);
+        Fl_Gl_Window_Driver::flush_glyph_atlases(ortho_context);
         pGlWindowDriver->set_gl_context(this, ortho_context);
         if (orthoinit || !save_valid || ortho_window != this) {
           glDisable(GL_DEPTH_TEST);
@@ -424,6 +426,8 @@ void Fl_Gl_Window::draw_begin() {
  \see \ref opengl_with_fltk_widgets
  */
 void Fl_Gl_Window::draw_end() {
+  // draw primitives the driver has not sent to GL yet
+  ((Fl_OpenGL_Graphics_Driver*)Fl_Surface_Device::surface()->driver())->flush_batch();
   glMatrixMode(GL_MODELVIEW);
   glPopMatrix();
 
@@ -1,7 +1,7 @@
 //
 // Group widget for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2024 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -22,10 +22,13 @@
 
 #include <FL/Fl_Group.H>
 #include "Fl_Window_Driver.H"
+#include "Fl_Trace.H"
 #include <FL/Fl_Rect.H>
 #include <FL/fl_draw.H>
 
 #include <stdlib.h> // malloc etc.
+#include <math.h>   // sqrt()
+#include <algorithm>
 
 Fl_Group* Fl_Group::current_;
 
@@ -96,6 +99,7 @@ extern Fl_Widget* fl_oldfocus; // set by Fl::focus
 // windows so they are relative to that window.
 
 static int send(Fl_Widget* o, int event) {
+  FL_TRACE_SCOPE("handle", o);
   if (!o->as_window()) return o->handle(event);
   switch ( event )
   {
@@ -145,6 +149,205 @@ static int navkey() {
   return 0;
 }
 
+// Spatial index of the children of a group, see Fl_Group::spatial_index(int).
+// A uniform grid over the bounding box of the children lists, for each cell,
+// the children that overlap it in ascending order. Children that overlap
+// many cells, or whose label is drawn outside, are listed separately and
+// are candidates everywhere.
+class Fl_Group_Index {
+  int x0_, y0_, x1_, y1_;       // bounding box of the indexed children
+  int cw_, ch_, nx_, ny_;       // size and number of cells
+  std::vector<int> start_;      // first entry of each cell, nx_ * ny_ + 1 values
+  std::vector<int> entries_;    // child indices of all cells
+  std::vector<int> always_;     // child indices that are candidates everywhere
+  static int below(const int *first, const int *last, int i);
+public:
+  void build(const Fl_Group *g);
+  int below(int X, int Y, int i) const;
+  void overlapping(int X, int Y, int W, int H, std::vector<int> &list) const;
+  void visible(std::vector<int> &list) const;
+};
+
+// cells with more children than this are not split
+static const int index_cell_children = 4;
+// children overlapping more cells than this are candidates everywhere
+static const int index_max_cells = 16;
+
+static bool outside_label(const Fl_Widget *o) {
+  return (o->align() & 15) && !(o->align() & FL_ALIGN_INSIDE) && (o->label() || o->image());
+}
+
+void Fl_Group_Index::build(const Fl_Group *g) {
+  Fl_Widget *const *a = g->array();
+  int n = g->children();
+  start_.clear();
+  entries_.clear();
+  always_.clear();
+  x0_ = y0_ = 0;
+  x1_ = y1_ = -1;
+  bool first = true;
+  for (int i = 0; i < n; i++) {
+    const Fl_Widget *o = a[i];
+    if (o->w() <= 0 || o->h() <= 0) continue;
+    if (first) {
+      x0_ = o->x(); y0_ = o->y(); x1_ = o->x() + o->w(); y1_ = o->y() + o->h();
+      first = false;
+    } else {
+      if (o->x() < x0_) x0_ = o->x();
+      if (o->y() < y0_) y0_ = o->y();
+      if (o->x() + o->w() > x1_) x1_ = o->x() + o->w();
+      if (o->y() + o->h() > y1_) y1_ = o->y() + o->h();
+    }
+  }
+  if (first) { nx_ = ny_ = 0; return; }
+  // choose square-ish cells for about index_cell_children children each
+  double cells = double(n) / index_cell_children;
+  double bw = x1_ - x0_, bh = y1_ - y0_;
+  nx_ = int(sqrt(cells * bw / bh) + 0.5);
+  nx_ = (nx_ < 1 ? 1 : (nx_ > 1024 ? 1024 : nx_));
+  ny_ = int(cells / nx_ + 0.5);
+  ny_ = (ny_ < 1 ? 1 : (ny_ > 1024 ? 1024 : ny_));
+  cw_ = (x1_ - x0_ + nx_ - 1) / nx_;
+  ch_ = (y1_ - y0_ + ny_ - 1) / ny_;
+  // count, then fill the entries of each cell
+  start_.assign(nx_ * ny_ + 1, 0);
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<int> fill;
+    if (pass) {
+      for (int c = 0; c < nx_ * ny_; c++) start_[c + 1] += start_[c];
+      entries_.resize(start_[nx_ * ny_]);
+      fill.assign(start_.begin(), start_.end() - 1);
+    }
+    for (int i = 0; i < n; i++) {
+      const Fl_Widget *o = a[i];
+      if (o->w() <= 0 || o->h() <= 0) continue;
+      int cx0 = (o->x() - x0_) / cw_, cx1 = (o->x() + o->w() - 1 - x0_) / cw_;
+      int cy0 = (o->y() - y0_) / ch_, cy1 = (o->y() + o->h() - 1 - y0_) / ch_;
+      if ((cx1 - cx0 + 1) * (cy1 - cy0 + 1) > index_max_cells || outside_label(o)) {
+        if (pass) always_.push_back(i);
+        continue;
+      }
+      for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+          if (pass) entries_[fill[cy * nx_ + cx]++] = i;
+          else start_[cy * nx_ + cx + 1]++;
+        }
+      }
+    }
+  }
+}
+
+// Returns the largest index below i in the ascending list [first, last), or -1
+int Fl_Group_Index::below(const int *first, const int *last, int i) {
+  const int *p = std::lower_bound(first, last, i);
+  return (p == first ? -1 : p[-1]);
+}
+
+// Returns the largest index below i of a child that may contain the point X, Y, or -1
+int Fl_Group_Index::below(int X, int Y, int i) const {
+  int r = always_.empty() ? -1 : below(&always_[0], &always_[0] + always_.size(), i);
+  if (X < x0_ || X >= x1_ || Y < y0_ || Y >= y1_) return r;
+  int c = ((Y - y0_) / ch_) * nx_ + (X - x0_) / cw_;
+  if (start_[c] < start_[c + 1]) {
+    int j = below(&entries_[start_[c]], &entries_[0] + start_[c + 1], i);
+    if (j > r) r = j;
+  }
+  return r;
+}
+
+// Sets list to the ascending indices of children that may overlap the rectangle
+void Fl_Group_Index::overlapping(int X, int Y, int W, int H, std::vector<int> &list) const {
+  list = always_;
+  if (X < x1_ && X + W > x0_ && Y < y1_ && Y + H > y0_ && W > 0 && H > 0) {
+    int cx0 = (X > x0_ ? (X - x0_) / cw_ : 0);
+    int cy0 = (Y > y0_ ? (Y - y0_) / ch_ : 0);
+    int cx1 = (X + W < x1_ ? (X + W - 1 - x0_) / cw_ : nx_ - 1);
+    int cy1 = (Y + H < y1_ ? (Y + H - 1 - y0_) / ch_ : ny_ - 1);
+    for (int cy = cy0; cy <= cy1; cy++) {
+      for (int cx = cx0; cx <= cx1; cx++) {
+        int c = cy * nx_ + cx;
+        list.insert(list.end(), entries_.begin() + start_[c], entries_.begin() + start_[c + 1]);
+      }
+    }
+  }
+  std::sort(list.begin(), list.end());
+  list.erase(std::unique(list.begin(), list.end()), list.end());
+}
+
+// Sets list to the ascending indices of children that may overlap the clip region
+void Fl_Group_Index::visible(std::vector<int> &list) const {
+  if (x1_ <= x0_) { // no child has a size
+    list = always_;
+    return;
+  }
+  int X, Y, W, H;
+  fl_clip_box(x0_, y0_, x1_ - x0_, y1_ - y0_, X, Y, W, H);
+  overlapping(X, Y, W, H, list);
+}
+
+// Returns the largest index below i of a child that may contain the mouse, or -1.
+// Without spatial index, this is just the previous child.
+int Fl_Group::child_below_(int i) {
+  if (!index_) return i - 1;
+  if (!index_valid_) {
+    if (i != children()) return i - 1; // children changed while looping over them
+    index_->build(this);
+    index_valid_ = true;
+  }
+  return index_->below(Fl::event_x(), Fl::event_y(), i);
+}
+
+/**
+  Gets the children that may overlap the current clip region.
+
+  This uses the spatial index of the group, see spatial_index(int).
+  Subclasses that draw their children themselves can use it to skip
+  children that are clipped.
+
+  \param[out] list ascending indices of the children
+  \return false if the group has no spatial index, list is unchanged then
+  \version 1.5.0
+*/
+bool Fl_Group::visible_children(std::vector<int> &list) {
+  if (!index_) return false;
+  if (!index_valid_) {
+    index_->build(this);
+    index_valid_ = true;
+  }
+  index_->visible(list);
+  return true;
+}
+
+/**
+  Sets whether the group finds its children under the mouse with a spatial index.
+
+  Without the index, which is the default, a group tests every child to
+  find the one below the mouse for FL_PUSH, FL_MOVE, FL_DRAG and other
+  mouse events, and tests every child against the clip region when drawing.
+  This takes a time proportional to the number of children, which can be
+  too slow for groups with thousands of children, e.g. in an Fl_Scroll.
+
+  The spatial index divides the area of the children into a grid and
+  keeps the list of children overlapping each cell, so that only the few
+  children near the mouse or in the clip region are tested. Events and
+  drawing order are the same as without the index.
+
+  The index is built on first use and rebuilt when children are added,
+  removed or resized. See invalidate_spatial_index() for other changes.
+
+  \param[in] on non-zero to use a spatial index
+  \version 1.5.0
+*/
+void Fl_Group::spatial_index(int on) {
+  if (on && !index_) {
+    index_ = new Fl_Group_Index;
+    index_valid_ = false;
+  } else if (!on) {
+    delete index_;
+    index_ = nullptr;
+  }
+}
+
 int Fl_Group::handle(int event) {
 
   Fl_Widget*const* a = array();
@@ -176,7 +379,7 @@ int Fl_Group::handle(int event) {
     return navigation(navkey());
 
   case FL_SHORTCUT:
-    for (i = children(); i--;) {
+    for (i = children(); (i = child_below_(i)) >= 0;) {
       o = a[i];
       if (o->takesevents() && Fl::event_inside(o) && send(o,FL_SHORTCUT))
         return 1;
@@ -191,7 +394,7 @@ int Fl_Group::handle(int event) {
 
   case FL_ENTER:
   case FL_MOVE:
-    for (i = children(); i--;) {
+    for (i = children(); (i = child_below_(i)) >= 0;) {
       o = a[i];
       if (o->visible() && Fl::event_inside(o)) {
         if (o->contains(Fl::belowmouse())) {
@@ -207,7 +410,7 @@ int Fl_Group::handle(int event) {
 
   case FL_DND_ENTER:
   case FL_DND_DRAG:
-    for (i = children(); i--;) {
+    for (i = children(); (i = child_below_(i)) >= 0;) {
       o = a[i];
       if (o->takesevents() && Fl::event_inside(o)) {
         if (o->contains(Fl::belowmouse())) {
@@ -222,7 +425,7 @@ int Fl_Group::handle(int event) {
     return 0;
 
   case FL_PUSH:
-    for (i = children(); i--;) {
+    for (i = children(); (i = child_below_(i)) >= 0;) {
       o = a[i];
       if (o->takesevents() && Fl::event_inside(o)) {
         Fl_Widget_Tracker wp(o);
@@ -240,7 +443,7 @@ int Fl_Group::handle(int event) {
     if (o == this) return 0;
     else if (o) send(o,event);
     else {
-      for (i = children(); i--;) {
+      for (i = children(); (i = child_below_(i)) >= 0;) {
         o = a[i];
         if (o->takesevents() && Fl::event_inside(o)) {
           if (send(o,event)) return 1;
@@ -250,7 +453,7 @@ int Fl_Group::handle(int event) {
     return 0;
 
   case FL_MOUSEWHEEL:
-    for (i = children(); i--;) {
+    for (i = children(); (i = child_below_(i)) >= 0;) {
       o = a[i];
       if (o->takesevents() && Fl::event_inside(o) && send(o,FL_MOUSEWHEEL))
         return 1;
@@ -358,6 +561,8 @@ Fl_Group::Fl_Group(int X, int Y, int W, int H, const char *L)
   resizable_ = this;
   bounds_ = 0; // this is allocated when first resize() is done
   sizes_ = 0;  // see bounds_ (FLTK 1.3 compatibility)
+  index_ = 0;  // see spatial_index(int)
+  index_valid_ = false;
 
   // Subclasses may want to construct child objects as part of their
   // constructor, so make sure they are add()'d to this object.
@@ -437,6 +642,7 @@ Fl_Group::~Fl_Group() {
   if (current_ == this)
     end();
   clear();
+  delete index_;
 }
 
 /**
@@ -679,6 +885,7 @@ void Fl_Group::init_sizes() {
   bounds_ = 0;
   delete[] sizes_;      // FLTK 1.3 compatibility
   sizes_ = 0;           // FLTK 1.3 compatibility
+  index_valid_ = false; // rebuild the spatial index
 }
 
 /**
@@ -911,7 +1118,14 @@ void Fl_Group::draw_children() {
                  h() - Fl::box_dh(box()));
   }
 
-  if (damage() & ~FL_DAMAGE_CHILD) { // redraw the entire thing:
+  std::vector<int> list;
+  if ((damage() & ~FL_DAMAGE_CHILD) && visible_children(list)) { // redraw children in the clip region:
+    for (size_t i = 0; i < list.size(); i++) {
+      Fl_Widget& o = *a[list[i]];
+      draw_child(o);
+      draw_outside_label(o);
+    }
+  } else if (damage() & ~FL_DAMAGE_CHILD) { // redraw the entire thing:
     for (int i = children(); i--;) {
       Fl_Widget& o = **a++;
       draw_child(o);
@@ -944,6 +1158,7 @@ void Fl_Group::draw() {
 void Fl_Group::update_child(Fl_Widget& widget) const {
   if (widget.damage() && widget.visible() && widget.type() < FL_WINDOW &&
       fl_not_clipped(widget.x(), widget.y(), widget.w(), widget.h())) {
+    FL_TRACE_SCOPE("draw", &widget);
     widget.draw();
     widget.clear_damage();
   }
@@ -960,6 +1175,7 @@ void Fl_Group::draw_child(Fl_Widget& widget) const {
       fl_not_clipped(widget.x(), widget.y(), widget.w(), widget.h())) {
     // The following call clears all damage flags and then *sets* FL_DAMAGE_ALL
     widget.clear_damage(FL_DAMAGE_ALL);
+    FL_TRACE_SCOPE("draw", &widget);
     widget.draw();
     widget.clear_damage();
   }
@@ -336,7 +336,7 @@ bool Fl_Image::register_images_done = false;
 //
 size_t Fl_RGB_Image::max_size_ = ~((size_t)0);
 
-int fl_convert_pixmap(const char*const* cdata, uchar* out, Fl_Color bg);
+int fl_convert_pixmap_cached_(const Fl_Pixmap *pxm, uchar* out, Fl_Color bg);
 
 
 /**
@@ -446,7 +446,7 @@ Fl_RGB_Image::Fl_RGB_Image(const Fl_Pixmap *pxm, Fl_Color bg):
   if (pxm && pxm->data_w() > 0 && pxm->data_h() > 0) {
     array = new uchar[data_w() * data_h() * d()];
     alloc_array = 1;
-    fl_convert_pixmap(pxm->data(), (uchar*)array, bg);
+    fl_convert_pixmap_cached_(pxm, (uchar*)array, bg);
   }
   data((const char **)&array, 1);
   scale(pxm->w(), pxm->h(), 0, 1);
@@ -1,7 +1,7 @@
 //
 // Internal (Image) Reader class for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 2020-2021 by Bill Spitzak and others.
+// Copyright 2020-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -173,3 +173,88 @@ long Fl_Image_Reader::tell() const {
   }
   return 0;
 }
+
+// Number of rows per band if the image isn't decoded into one buffer
+static const int BAND_ROWS = 16;
+
+Fl_Image_Band::Fl_Image_Band(Fl_Image_Rows_Cb cb, void *data)
+  : cb_(cb)
+  , data_(data)
+  , buffer_(0L)
+  , own_(0L)
+  , ld_(0)
+  , full_(false)
+  , band_rows_(BAND_ROWS)
+  , band_y_(-1)
+  , band_done_(0)
+  , result_(0) {
+  memset(&rows_, 0, sizeof(rows_));
+}
+
+Fl_Image_Band::~Fl_Image_Band() {
+  delete[] own_;
+}
+
+// Call the callback with n = 0 to announce the size of the image, then
+// use the buffer it set or allocate one. If full is set, the buffer holds
+// all rows of the image.
+
+int Fl_Image_Band::begin(int w, int h, int d, int passes, bool full) {
+  rows_.w = w;
+  rows_.h = h;
+  rows_.d = d;
+  rows_.passes = passes;
+  if (cb_(&rows_, data_)) return result_ = Fl_Image_Rows::STOP;
+  if (rows_.target) {
+    buffer_ = rows_.target;
+    ld_ = rows_.target_ld ? rows_.target_ld : w * d;
+    full_ = true;
+  } else {
+    full_ = full;
+    if (!full_ && band_rows_ > h) band_rows_ = h;
+    ld_ = w * d;
+    size_t size = (size_t)ld_ * (full_ ? h : band_rows_);
+    if (size > Fl_RGB_Image::max_size()) return 0; // error() is set
+    own_ = buffer_ = new uchar[size];
+  }
+  return 0;
+}
+
+// Count the rows done in the current band and deliver it when all its
+// rows are there. If row y starts another band, deliver the rows done
+// so far first.
+
+int Fl_Image_Band::done(int y) {
+  int band_y = y - y % band_rows_;
+  if (band_y != band_y_) {
+    int ret = finish();
+    if (ret) return ret;
+    band_y_ = band_y;
+    band_done_ = 0;
+  }
+  int n = rows_.h - band_y_;
+  if (n > band_rows_) n = band_rows_;
+  if (++band_done_ < n) return 0;
+  band_done_ = 0;
+  band_y_ = -1;
+  return deliver(band_y, n);
+}
+
+int Fl_Image_Band::deliver(int y, int n, int pass) {
+  rows_.pass = pass;
+  rows_.y = y;
+  rows_.n = n;
+  rows_.pixels = buffer_ + (full_ ? y * ld_ : 0);
+  rows_.ld = ld_;
+  return result_ = (cb_(&rows_, data_) ? Fl_Image_Rows::STOP : 0);
+}
+
+int Fl_Image_Band::finish() {
+  if (band_y_ < 0 || !band_done_) return 0;
+  int n = rows_.h - band_y_;
+  if (n > band_rows_) n = band_rows_;
+  int y = band_y_;
+  band_y_ = -1;
+  band_done_ = 0;
+  return deliver(y, n);
+}
@@ -1,7 +1,7 @@
 //
 // Internal (Image) Reader class for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 2020-2021 by Bill Spitzak and others.
+// Copyright 2020-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -27,6 +27,7 @@
 #ifndef FL_IMAGE_READER_H
 #define FL_IMAGE_READER_H
 
+#include <FL/Fl_Image.H> // Fl_Image_Rows
 #include <stdio.h>
 
 class Fl_Image_Reader {
@@ -123,4 +124,62 @@ private:
   int error_;
 };
 
+/*
+  This internal (undocumented) class delivers decoded rows of an image in
+  bands to an Fl_Image_Rows_Cb, for the decode() functions of Fl_PNG_Image,
+  Fl_JPEG_Image and Fl_BMP_Image.
+
+  Decoders write each row to the address returned by row() and report it
+  with done(). Rows may come top-down or bottom-up, but a band must be
+  complete before rows of the next band are written. A band is passed
+  to the callback as soon as all of its rows are done. Rows go to the buffer
+  set by the callback, or to a buffer of a few rows that is reused for each
+  band. Decoders that need the whole image at once (interlaced images, masks
+  applied at the end) call begin() with full set and deliver() the rows
+  themselves.
+
+  Functions returning int return 0 or the value returned by the callback,
+  in which case decoding must stop.
+*/
+
+class Fl_Image_Band {
+public:
+  Fl_Image_Band(Fl_Image_Rows_Cb cb, void *data);
+  ~Fl_Image_Band();
+
+  // Announce the size of the image to the callback and set up the buffer
+  int begin(int w, int h, int d, int passes = 1, bool full = false);
+
+  // Where to decode row y, counted from the top
+  uchar *row(int y) { return buffer_ + (full_ ? y : y % band_rows_) * ld_; }
+
+  // Report that row y is decoded
+  int done(int y);
+
+  // Pass n rows from row y on to the callback, for pass number pass
+  int deliver(int y, int n, int pass = 0);
+
+  // Pass remaining rows of an incomplete band on to the callback
+  int finish();
+
+  // Return 1 if begin() couldn't allocate the buffer
+  int error() const { return !buffer_; }
+
+  // Return Fl_Image_Rows::STOP if the callback stopped decoding, otherwise 0
+  int result() const { return result_; }
+
+private:
+  Fl_Image_Rows_Cb cb_;
+  void *data_;
+  Fl_Image_Rows rows_;
+  uchar *buffer_;       // target of the callback, or own buffer
+  uchar *own_;          // own buffer, deleted by the destructor
+  int ld_;              // bytes per row of buffer_
+  bool full_;           // buffer_ holds all rows of the image
+  int band_rows_;       // rows per band
+  int band_y_;          // first row of the current band, -1 before the first row
+  int band_done_;       // rows of the current band that are done
+  int result_;          // value returned by the callback to stop decoding
+};
+
 #endif // FL_IMAGE_READER_H
@@ -19,12 +19,16 @@
 #include <FL/Fl_Window.H>
 #include "Fl_Screen_Driver.H"
 #include <FL/fl_draw.H>
+#include <FL/Fl_Device.H>
+#include <FL/Fl_Graphics_Driver.H>
 #include <FL/fl_ask.H>
 #include <math.h>
 #include <FL/fl_utf8.h>
 #include "flstring.h"
 #include <stdlib.h>
 #include <ctype.h>
+#include <algorithm>
+#include <vector>
 
 #define MAXBUF 1024
 static int l_secret;
@@ -120,6 +124,98 @@ public:
   }
 };
 
+/* \internal
+  Display lines of the text of an Fl_Input_, as split by expand(): line n
+  starts at index start[n] of the text and ends at index end[n], where
+  expand() stopped.
+
+  Lines are split at newlines and, with word wrapping, at spaces depending on
+  the font and the width of the widget. An edit only splits the paragraphs
+  it changed again, see Fl_Input_::layout_changed().
+*/
+class Fl_Input_Layout {
+public:
+  Fl_Input_Layout() :
+  valid(false),
+  text(NULL),
+  text_size(0),
+  type(0),
+  width(0),
+  font(0),
+  size(0),
+  driver(NULL),
+  scale(0),
+  mu_e(-1)
+  { }
+
+  std::vector<int> start;
+  std::vector<int> end;
+  bool valid;
+
+  // the layout must be computed again if one of these changed:
+  const char *text;     // value() and size() of the widget
+  int text_size;
+  int type;             // type() of the widget
+  int width;            // width for word wrapping, or 0
+  Fl_Font font;         // font for word wrapping
+  Fl_Fontsize size;
+  // graphics driver and scale the text was measured with for word wrapping,
+  // because text widths differ between the display and other surfaces
+  const Fl_Graphics_Driver *driver;
+  float scale;
+
+  // Index after which the text was neither changed nor moved to other
+  // lines since it was drawn, or -1. See Fl_Input_::replace().
+  int mu_e;
+
+  // whether the layout is valid for the current text and settings of the widget
+  bool matches(const Fl_Input_ &in) const {
+    return text == in.value() && text_size == in.size() && settings_match(in);
+  }
+
+  bool settings_match(const Fl_Input_ &in) const {
+    return valid && type == in.type() && width == wrap_width(in)
+        && font == (in.wrap() ? in.textfont() : 0)
+        && size == (in.wrap() ? in.textsize() : 0)
+        && driver == wrap_driver(in) && scale == wrap_scale(in);
+  }
+
+  void set_valid(const Fl_Input_ &in) {
+    text = in.value();
+    text_size = in.size();
+    type = in.type();
+    width = wrap_width(in);
+    font = in.wrap() ? in.textfont() : 0;
+    size = in.wrap() ? in.textsize() : 0;
+    driver = wrap_driver(in);
+    scale = wrap_scale(in);
+    valid = true;
+  }
+
+  // the width used by Fl_Input_::expand() for word wrapping
+  static int wrap_width(const Fl_Input_ &in) {
+    return in.wrap() ? in.w() - Fl::box_dw(in.box()) - 4 : 0;
+  }
+
+  // the driver and scale that measure text for word wrapping, or NULL and 0
+  static Fl_Graphics_Driver *wrap_driver(const Fl_Input_ &in) {
+    return in.wrap() ? Fl_Surface_Device::surface()->driver() : NULL;
+  }
+  static float wrap_scale(const Fl_Input_ &in) {
+    return in.wrap() ? Fl_Surface_Device::surface()->driver()->scale() : 0;
+  }
+
+  int lines() const {
+    return (int)start.size();
+  }
+
+  // index of the line that contains index i of the text
+  int line_of(int i) const {
+    int n = (int)(std::upper_bound(start.begin(), start.end(), i) - start.begin()) - 1;
+    return n < 0 ? 0 : n;
+  }
+};
+
 
 /** \internal
   Converts a given text segment into the text that will be rendered on screen.
@@ -247,6 +343,7 @@ double Fl_Input_::expandpos(
   \param [in] p start of update range
 */
 void Fl_Input_::minimal_update(int p) {
+  layout_->mu_e = -1;
   if (damage() & FL_DAMAGE_ALL) return; // don't waste time if it won't be done
   if (damage() & FL_DAMAGE_EXPOSE) {
     if (p < mu_p) mu_p = p;
@@ -287,6 +384,90 @@ void Fl_Input_::setfont() const {
   fl_font(textfont(), textsize());
 }
 
+/** \internal
+  Splits the text into display lines, starting at index \p i.
+
+  The lines are appended to \p l. This stops at the end of a line that ends
+  at a newline at or after index \p stop, or at the end of the text.
+  The current font must be set, see setfont().
+*/
+void Fl_Input_::layout_lines(int i, int stop, Fl_Input_Layout &l) const {
+  char buf[MAXBUF];
+  const char *p = value_ + i;
+  for (;;) {
+    const char *e = expand(p, buf);
+    l.start.push_back((int)(p - value_));
+    l.end.push_back((int)(e - value_));
+    if (e >= value_ + size_) break;
+    if (*e == '\n' && e - value_ >= stop) break;
+    if (*e == '\n' || *e == ' ') e++;
+    p = e;
+  }
+}
+
+/** \internal
+  Splits the text into display lines if it wasn't done yet, or if the
+  type, the font or the width of the widget changed, or if word wrapping
+  text is measured on another surface or at another scale.
+
+  drawtext() and handle_mouse() use the lines to find the line of the
+  cursor and the visible lines without expanding all text before them.
+  The current font must be set, see setfont().
+*/
+void Fl_Input_::update_layout() {
+  Fl_Input_Layout &l = *layout_;
+  if (l.matches(*this)) return;
+  l.start.clear();
+  l.end.clear();
+  layout_lines(0, size_ + 1, l);
+  l.set_valid(*this);
+}
+
+/** \internal
+  Splits the paragraphs of the text changed by an edit into display lines
+  again, and moves the following lines by the size difference.
+
+  \param [in] b, e range of the text that was replaced, before the edit
+  \param [in] ilen number of bytes inserted at \p b
+  \return index of the end of the changed lines if the edit didn't change
+    the number of lines, else -1
+*/
+int Fl_Input_::layout_changed(int b, int e, int ilen) {
+  Fl_Input_Layout &l = *layout_;
+  int delta = ilen - (e - b);
+  if (l.text_size + delta != size_ || !l.settings_match(*this)) {
+    l.valid = false;
+    return -1;
+  }
+  l.text = value_;
+  l.text_size = size_;
+  int n = l.lines();
+  // first line of the paragraph that contains b:
+  int k0 = l.line_of(b);
+  while (k0 > 0 && value_[l.start[k0] - 1] != '\n') k0--;
+  // last line of the paragraph that contained e:
+  int k1 = l.line_of(e);
+  while (k1 < n - 1 && value_[l.end[k1] + delta] != '\n') k1++;
+  Fl_Input_Layout changed;
+  if (wrap()) setfont();
+  layout_lines(l.start[k0], l.end[k1] + delta, changed);
+  for (int k = k1 + 1; k < n; k++) {
+    l.start[k] += delta;
+    l.end[k] += delta;
+  }
+  int count = changed.lines();
+  if (count == k1 - k0 + 1) {
+    std::copy(changed.start.begin(), changed.start.end(), l.start.begin() + k0);
+    std::copy(changed.end.begin(), changed.end.end(), l.end.begin() + k0);
+    return changed.end.back();
+  }
+  l.start.erase(l.start.begin() + k0, l.start.begin() + k1 + 1);
+  l.start.insert(l.start.begin() + k0, changed.start.begin(), changed.start.end());
+  l.end.erase(l.end.begin() + k0, l.end.begin() + k1 + 1);
+  l.end.insert(l.end.begin() + k0, changed.end.begin(), changed.end.end());
+  return -1;
+}
+
 /**
  Draws the text in the passed bounding box.
 
@@ -339,38 +520,36 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H, bool draw_active) {
   const char *p, *e;
   char buf[MAXBUF];
 
-  // count how many lines and put the last one into the buffer:
-  // And figure out where the cursor is:
+  // find the line of the cursor and put it into the buffer:
   int height = fl_height();
   int threshold = height/2;
-  int lines;
+  update_layout();
+  Fl_Input_Layout &layout = *layout_;
+  int lines = layout.lines();
+  int curline = layout.line_of(insert_position());
   int curx, cury;
-  for (p=value(), curx=cury=lines=0; ;) {
+  {
+    p = value() + layout.start[curline];
     e = expand(p, buf);
-    if (insert_position() >= p-value() && insert_position() <= e-value()) {
-      curx = int(expandpos(p, value()+insert_position(), buf, 0)+.5);
-      if (draw_active && !was_up_down) up_down_pos = curx;
-      cury = lines*height;
-      int newscroll = xscroll_;
-      if (curx > newscroll+W-threshold) {
-        // figure out scrolling so there is space after the cursor:
-        newscroll = curx+threshold-W;
-        // figure out the furthest left we ever want to scroll:
-        int ex = int(expandpos(p, e, buf, 0))+4-W;
-        // use minimum of both amounts:
-        if (ex < newscroll) newscroll = ex;
-      } else if (curx < newscroll+threshold) {
-        newscroll = curx-threshold;
-      }
-      if (newscroll < 0) newscroll = 0;
-      if (newscroll != xscroll_) {
-        xscroll_ = newscroll;
-        mu_p = 0; erase_cursor_only = 0;
-      }
+    curx = int(expandpos(p, value()+insert_position(), buf, 0)+.5);
+    if (draw_active && !was_up_down) up_down_pos = curx;
+    cury = curline*height;
+    int newscroll = xscroll_;
+    if (curx > newscroll+W-threshold) {
+      // figure out scrolling so there is space after the cursor:
+      newscroll = curx+threshold-W;
+      // figure out the furthest left we ever want to scroll:
+      int ex = int(expandpos(p, e, buf, 0))+4-W;
+      // use minimum of both amounts:
+      if (ex < newscroll) newscroll = ex;
+    } else if (curx < newscroll+threshold) {
+      newscroll = curx-threshold;
+    }
+    if (newscroll < 0) newscroll = 0;
+    if (newscroll != xscroll_) {
+      xscroll_ = newscroll;
+      mu_p = 0; erase_cursor_only = 0; layout.mu_e = -1;
     }
-    lines++;
-    if (e >= value_+size_) break;
-    p = e+1;
   }
 
   // adjust the scrolling:
@@ -379,7 +558,7 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H, bool draw_active) {
     if (cury < newy) newy = cury;
     if (cury > newy+H-height) newy = cury-H+height;
     if (newy < -1) newy = -1;
-    if (newy != yscroll_) {yscroll_ = newy; mu_p = 0; erase_cursor_only = 0;}
+    if (newy != yscroll_) {yscroll_ = newy; mu_p = 0; erase_cursor_only = 0; layout.mu_e = -1;}
   } else {
     yscroll_ = -(H-height)/2;
   }
@@ -387,22 +566,28 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H, bool draw_active) {
   fl_push_clip(X, Y, W, H);
   Fl_Color tc = active_r() ? textcolor() : fl_inactive(textcolor());
 
-  p = value();
-  // visit each line and draw it:
+  // visit each visible line and draw it, lines above are clipped off:
   int desc = height-fl_descent();
   float xpos = (float)(X - xscroll_ + 1);
-  int ypos = -yscroll_;
+  int line = yscroll_ > 0 ? yscroll_/height : 0;
+  if (line >= lines) line = lines-1;
+  int ypos = line*height - yscroll_;
   int ypos_cur = 0; //fix issue #270
+  p = value() + layout.start[line];
+  int buf_line = curline; // the line in buf
   for (; ypos < H;) {
 
-    // re-expand line unless it is the last one calculated above:
-    if (lines>1) e = expand(p, buf);
-
-    if (ypos <= -height) goto CONTINUE; // clipped off top
+    // re-expand line unless it is the one calculated last:
+    if (line != buf_line) {
+      e = expand(p, buf);
+      buf_line = line;
+    }
 
     if (do_mu) {        // for minimal update:
       const char* pp = value()+mu_p; // pointer to where minimal update starts
       if (e < pp) goto CONTINUE2; // this line is before the changes
+      // this line is after the changes and was not moved:
+      if (layout.mu_e >= 0 && p > value()+layout.mu_e) goto CONTINUE2;
       if (readonly()) erase_cursor_only = 0; // this isn't the most efficient way
       if (erase_cursor_only && p > pp) goto CONTINUE2; // this line is after
       // calculate area to erase:
@@ -491,15 +676,13 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H, bool draw_active) {
       ypos_cur = ypos+height; //fix issue #270
     }
 
-  CONTINUE:
     ypos += height;
-    if (e >= value_+size_) break;
-    if (*e == '\n' || *e == ' ') e++;
-    p = e;
+    if (++line >= lines) break;
+    p = value() + layout.start[line];
   }
 
   // for minimal update, erase all lines below last one if necessary:
-  if (input_type()==FL_MULTILINE_INPUT && do_mu && ypos<H
+  if (input_type()==FL_MULTILINE_INPUT && do_mu && ypos<H && layout.mu_e < 0
       && (!erase_cursor_only || p <= value()+mu_p)) {
     if (ypos < 0) ypos = 0;
     fl_push_clip(X, Y+ypos, W, H-ypos);
@@ -509,6 +692,7 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H, bool draw_active) {
   }
 
   fl_pop_clip();
+  layout.mu_e = -1;
   if (draw_active) {
     fl_set_spot(textfont(), textsize(),
                 (int)xpos+curx, Y+ypos_cur-fl_descent(), W, H, window()); //fix issue #270
@@ -649,12 +833,11 @@ void Fl_Input_::handle_mouse(int X, int Y, int /*W*/, int /*H*/, int drag) {
     (Fl::event_y()-Y+yscroll_)/fl_height() : 0;
 
   int newpos = 0;
-  for (p=value();; ) {
-    e = expand(p, buf);
-    theline--; if (theline < 0) break;
-    if (e >= value_+size_) break;
-    p = e+1;
-  }
+  update_layout();
+  if (theline >= layout_->lines()) theline = layout_->lines()-1;
+  if (theline < 0) theline = 0;
+  p = value() + layout_->start[theline];
+  e = expand(p, buf);
   const char *l, *r, *t; double f0 = Fl::event_x()-X+xscroll_;
   for (l = p, r = e; l<r; ) {
     double f;
@@ -989,6 +1172,7 @@ int Fl_Input_::replace(int b, int e, const char* text, int ilen) {
     memcpy(buffer+b, text, ilen);
     size_ += ilen;
   }
+  int changed_e = layout_changed(b, e, ilen);
   om = mark_;
   op = position_;
   mark_ = position_ = undo_->undoat = b+ilen;
@@ -1013,7 +1197,11 @@ int Fl_Input_::replace(int b, int e, const char* text, int ilen) {
   if (om < b) b = om;
   if (op < b) b = op;
 
+  int pending = damage() & (FL_DAMAGE_ALL|FL_DAMAGE_EXPOSE);
   minimal_update(b);
+  // the lines after the changed paragraphs need no redraw if they didn't move:
+  if (!pending && changed_e >= 0 && om <= e && op <= e)
+    layout_->mu_e = changed_e;
 
   mark_ = position_ = undo_->undoat;
 
@@ -1056,6 +1244,8 @@ int Fl_Input_::apply_undo() {
     size_ -= xlen;
   }
 
+  layout_changed(b1, b1+xlen, ilen);
+
   undo_->undocut = xlen;
   if (xlen) undo_->undoyankcut = xlen;
   undo_->undoinsert = ilen;
@@ -1311,6 +1501,7 @@ Fl_Input_::Fl_Input_(int X, int Y, int W, int H, const char* l)
   undo_list_ = new Fl_Input_Undo_Action_List();
   redo_list_ = new Fl_Input_Undo_Action_List();
   undo_ = new Fl_Input_Undo_Action();
+  layout_ = new Fl_Input_Layout();
   set_flag(SHORTCUT_LABEL);
   set_flag(MAC_USE_ACCENTS_MENU);
   set_flag(NEEDS_KEYBOARD);
@@ -1377,6 +1568,7 @@ void Fl_Input_::put_in_buffer(int len) {
 */
 int Fl_Input_::static_value(const char* str, int len) {
   clear_changed();
+  layout_->valid = false;
   undo_->clear();
   undo_list_->clear();
   redo_list_->clear();
@@ -1531,6 +1723,7 @@ Fl_Input_::~Fl_Input_() {
   delete undo_list_;
   delete redo_list_;
   delete undo_;
+  delete layout_;
   if (bufsize) free((void*)buffer);
 }
 
@@ -4,7 +4,7 @@
 // Copyright 1997-2011 by Easy Software Products.
 // Image support by Matthias Melcher, Copyright 2000-2009.
 //
-// Copyright 2013-2025 by Bill Spitzak and others.
+// Copyright 2013-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -29,6 +29,7 @@
 #include <FL/Fl_Shared_Image.H>
 #include <FL/fl_utf8.h>
 #include <FL/Fl.H>
+#include "Fl_Image_Reader.h"
 #include <config.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -104,6 +105,33 @@ Fl_JPEG_Image::Fl_JPEG_Image(const char *filename)
   load_jpg_(filename, 0L, 0L);
 }
 
+/**
+ \brief The constructor loads the JPEG image from the given jpeg filename
+ with a reduced resolution.
+
+ The image is decoded at 1/2, 1/4 or 1/8 of its size if the result still
+ has at least \p W x \p H pixels. libjpeg does this while decoding the
+ image, which is much faster than decoding all pixels and reducing the
+ image afterwards, for instance to show thumbnails of large photos.
+ w() and h() of the image are the size of the decoded data, which is
+ the full size of the file if it can't be reduced. Use Fl_Image::copy()
+ or Fl_Image::scale() to get exactly the size needed.
+
+ See Fl_JPEG_Image::Fl_JPEG_Image(const char *filename) on how to check
+ for errors.
+
+ \param[in] filename a full path and name pointing to a valid jpeg file.
+ \param[in] W, H minimum size of the decoded image in pixels
+
+ \see Fl_Shared_Image::get(const char *name, int W, int H)
+ \version 1.5.0
+ */
+Fl_JPEG_Image::Fl_JPEG_Image(const char *filename, int W, int H)
+: Fl_RGB_Image(0,0,0)
+{
+  load_jpg_(filename, 0L, 0L, -1, W, H);
+}
+
 /**
  \brief The constructor loads the JPEG image from memory.
 
@@ -136,6 +164,52 @@ Fl_JPEG_Image::Fl_JPEG_Image(const char *name, const unsigned char *data, int da
 }
 
 
+/**
+ \brief Decodes a JPEG image file row by row without creating an image.
+
+ The callback gets the size of the image first and then bands of decoded
+ rows, as described for Fl_Image_Rows. Unless the callback sets its own
+ target buffer, only a few rows are kept in memory at any time, so this
+ works for images that are too large for Fl_JPEG_Image (see
+ Fl_RGB_Image::max_size()).
+
+ \param[in] filename  name of the JPEG file
+ \param[in] cb        callback that receives the decoded rows
+ \param[in] data      user data passed to \p cb
+ \return 0 on success, Fl_Image::ERR_FILE_ACCESS or Fl_Image::ERR_FORMAT on
+    errors, or Fl_Image_Rows::STOP if \p cb stopped decoding
+
+ \see Fl_PNG_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+ \version 1.5.0
+ */
+int Fl_JPEG_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+{
+  Fl_Image_Band band(cb, data);
+  Fl_JPEG_Image img;
+  img.load_jpg_(filename, 0L, 0L, -1, 0, 0, &band);
+  return band.result() ? band.result() : img.ld();
+}
+
+/**
+ \brief Decodes a JPEG image in memory row by row without creating an image.
+ \param[in] buffer       start of the JPEG image in memory
+ \param[in] data_length  size in bytes of the JPEG image in memory, or -1 if
+    it is unknown, as for Fl_JPEG_Image(const char *, const unsigned char *, int)
+ \param[in] cb           callback that receives the decoded rows
+ \param[in] data         user data passed to \p cb
+ \return 0 on success, Fl_Image::ERR_FILE_ACCESS or Fl_Image::ERR_FORMAT on
+    errors, or Fl_Image_Rows::STOP if \p cb stopped decoding
+ \see Fl_JPEG_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+ \version 1.5.0
+ */
+int Fl_JPEG_Image::decode(const unsigned char *buffer, int data_length, Fl_Image_Rows_Cb cb, void *data)
+{
+  Fl_Image_Band band(cb, data);
+  Fl_JPEG_Image img;
+  img.load_jpg_(0L, 0L, buffer, data_length, 0, 0, &band);
+  return band.result() ? band.result() : img.ld();
+}
+
 // data source manager for reading jpegs from memory
 // init_source (j_decompress_ptr cinfo)
 // fill_input_buffer (j_decompress_ptr cinfo)
@@ -233,9 +307,13 @@ struct load_stat {
  This method reads JPEG image data and creates an RGB or grayscale image.
  To avoid code duplication, we set filename if we want to read from a file
  or data to read from memory instead. Sharename can be set if the image is
- supposed to be added to the Fl_Shared_Image list.
+ supposed to be added to the Fl_Shared_Image list. If W and H are given,
+ the image is decoded at the lowest resolution that has at least W x H pixels.
+ If band is given, rows are passed to its callback instead of being stored
+ in the image.
  */
-void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const unsigned char *data, int data_length)
+void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const unsigned char *data, int data_length,
+                              int W, int H, Fl_Image_Band *band)
 {
 #ifdef HAVE_LIBJPEG
   jpeg_decompress_struct  dinfo;    // Decompressor info
@@ -314,12 +392,46 @@ void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const
   dinfo.out_color_components = 3;
   dinfo.output_components    = 3;
 
+  if (W > 0 && H > 0) {
+    // let libjpeg scale the image down in the DCT domain as far as possible
+    unsigned int denom = 8;
+    while (denom > 1 && ((dinfo.image_width + denom - 1) / denom < (unsigned)W ||
+                         (dinfo.image_height + denom - 1) / denom < (unsigned)H))
+      denom /= 2;
+    if (denom > 1) {
+      dinfo.scale_num           = 1;
+      dinfo.scale_denom         = denom;
+      dinfo.dct_method          = JDCT_IFAST;
+      dinfo.do_fancy_upsampling = (boolean)FALSE;
+      // tell Fl_Shared_Image::get() that this isn't the full image
+      if (Fl_Shared_Image::load_w_) Fl_Shared_Image::load_reduced_ = 1;
+    }
+  }
+
   jpeg_calc_output_dimensions(&dinfo);
 
   w(dinfo.output_width);
   h(dinfo.output_height);
   d(dinfo.output_components);
 
+  if (band) {
+    int stop = band->begin(w(), h(), d());
+    if (!stop && band->error()) longjmp(jerr.errhand_, 1);
+    if (!stop) {
+      jpeg_start_decompress(&dinfo);
+      while (!stop && dinfo.output_scanline < dinfo.output_height) {
+        int y = (int)dinfo.output_scanline;
+        row = (JSAMPROW)band->row(y);
+        jpeg_read_scanlines(&dinfo, &row, (JDIMENSION)1);
+        stop = band->done(y);
+      }
+      if (!stop) jpeg_finish_decompress(&dinfo);
+    }
+    jpeg_destroy_decompress(&dinfo);
+    delete lstat;
+    return;
+  }
+
   if (((size_t)w()) * h() * d() > max_size() ) longjmp(jerr.errhand_, 1);
   array = new uchar[w() * h() * d()];
   alloc_array = 1;
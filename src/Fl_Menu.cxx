@@ -27,7 +27,9 @@
 #include <FL/Fl_Menu_.H>
 #include <FL/fl_draw.H>
 #include <stdio.h>
+#include "Fl_Menu_Item_Sizes.H"
 #include "flstring.h"
+#include <vector>
 
 // This file will declare:
 class Menu_Window_Basetype;
@@ -50,6 +52,11 @@ extern char fl_draw_shortcut;
 // appearance of current menus are pulled from this parent widget:
 static const Fl_Menu_* button = nullptr;
 
+// Size of a menu item and its shortcut, see item_size()
+typedef Fl_Menu_Item_Sizes::Size Menu_Item_Size;
+
+static Menu_Item_Size item_size(const Fl_Menu_Item* m);
+
 //
 // ==== Declarations ===========================================================
 //
@@ -128,6 +135,16 @@ struct Menu_State
   // handle FL_SHORTCUT in any of the menu windows
   int handle_shortcut();
 
+  // select the next item whose label starts with the typed text
+  int handle_type_ahead();
+
+  // scroll the menu window under the mouse
+  int handle_wheel();
+
+  // text typed by handle_type_ahead() and when it was typed
+  char typed[32] { 0 };
+  Fl_Timestamp typed_time { };
+
   // move menu item selection left
   int handle_left();
 
@@ -298,6 +315,21 @@ public:
   // Scroll so item i is visible on screen. This may move the entire window..
   void autoscroll(item_index_t i);
 
+  // Scroll a menu that is taller than the screen by dy pixels.
+  bool scroll(int dy);
+
+  // Return the visible item n, or nullptr if there is none
+  const Fl_Menu_Item* item(item_index_t n) const {
+    return (n >= 0 && n < num_items) ? items[n] : nullptr;
+  }
+
+  // Find the range of items that are on the screen if the window is at Y.
+  void visible_items(int Y, item_index_t &first, item_index_t &last);
+
+  // Measure the items that are on the screen if the window is at Y, and
+  // make the window wider if needed.
+  void measure_visible(int Y);
+
   // Also reposition the title (relative to the parent_ window?)
   void position(int x, int y);
 
@@ -334,11 +366,91 @@ public:
 
   // Used by the window driver
   int offset_y { 0 };
+
+private:
+
+  // Measure items first to last, return true if the window must get wider.
+  bool measure_items(item_index_t first, item_index_t last);
+
+  // Width of the window needed by the items measured so far
+  int needed_w();
+
+  // The visible items of the menu, so that item n is found quickly
+  std::vector<const Fl_Menu_Item*> items;
+
+  // Items that were measured, empty if all items were measured
+  std::vector<bool> measured;
+
+  // Widest label, including the submenu arrow
+  int labels_w { 0 };
+
+  // Widest shortcut modifiers
+  int modifiers_w { 0 };
+
+  // Minimum width of the window for the title or the Fl_Menu_
+  int min_w { 0 };
 };
 
 //
 // ==== Implementations ========================================================
 //
+//
+// ---- Menu_Item_Size ---------------------------------------------------------
+//
+
+/* Return the cache of item sizes of an Fl_Menu_, and create it if needed. */
+Fl_Menu_Item_Sizes *Fl_Menu_Item_Sizes::of(const Fl_Menu_ *menu) {
+  if (!menu->sizes_) menu->sizes_ = new Fl_Menu_Item_Sizes;
+  return menu->sizes_;
+}
+
+// FNV-1a hash of a label, so that a label changed in place is noticed
+static unsigned label_hash(const char *s) {
+  unsigned h = 2166136261u;
+  for (; *s; s++) h = (h ^ (uchar)*s) * 16777619u;
+  return h;
+}
+
+/* Measure a menu item and its shortcut, or find its size in the cache of
+ the Fl_Menu_ `button`. Items with images or multi labels, and items of
+ menus popped up without an Fl_Menu_, are always measured.
+ \param[in] m the menu item, uses the font of the current Fl_Menu_ `button`
+ \return the size of the item
+ */
+static Menu_Item_Size item_size(const Fl_Menu_Item* m) {
+  Fl_Menu_Item_Sizes::Key key;
+  Fl_Menu_Item_Sizes *cache = nullptr;
+  if (button && m->text && m->labeltype_ < _FL_MULTI_LABEL) {
+    cache = Fl_Menu_Item_Sizes::of(button);
+    key.text = m->text;
+    key.hash = label_hash(m->text);
+    key.font = m->labelsize_ || m->labelfont_ ? (Fl_Font)m->labelfont_ : button->textfont();
+    key.size = m->labelsize_ ? m->labelsize_ : button->textsize();
+    key.labeltype = m->labeltype_;
+    key.flags = m->flags & (FL_MENU_TOGGLE|FL_MENU_RADIO);
+    key.shortcut = m->shortcut_;
+    key.scale = Fl::screen_scale(Fl_Window_Driver::menu_parent()->screen_num());
+    const Menu_Item_Size *found = cache->find(m, key);
+    if (found) return *found;
+  }
+  Menu_Item_Size sz;
+  sz.w = m->measure(&sz.h, button);
+  if (m->shortcut_) {
+    // s is a pointer to the UTF-8 string for the entire shortcut
+    // k points only to the key part (minus the modifier keys)
+    const char *k, *s = fl_shortcut_label(m->shortcut_, &k);
+    if (fl_utf_nb_char((const unsigned char*)k, (int) strlen(k))<=4) {
+      sz.modifiers_w = int(fl_width(s, (int) (k-s)));
+      sz.key_w = int(fl_width(k))+4;
+    } else {
+      sz.modifiers_w = -1;
+      sz.key_w = int(fl_width(s))+4;
+    }
+  }
+  if (cache) cache->store(m, key, sz);
+  return sz;
+}
+
 //
 // ---- Menu_State -------------------------------------------------------------
 //
@@ -371,7 +483,7 @@ void Menu_State::set_current_item(const Fl_Menu_Item* i, menu_index_t m, item_in
   \param[in] n index into visible item in that menu window
 */
 void Menu_State::set_current_item(menu_index_t m, item_index_t n) {
-  current_item = (n >= 0) ? menu_window[m]->menu->next(n) : 0;
+  current_item = menu_window[m]->item(n);
   current_menu_ix = m;
   current_item_ix = n;
 }
@@ -390,7 +502,7 @@ bool Menu_State::next_item(menu_index_t menu) { // go to next item in menu menu
   bool wrapped = false;
   do {
     while (++item < m.num_items) {
-      const Fl_Menu_Item* m1 = m.menu->next(item);
+      const Fl_Menu_Item* m1 = m.item(item);
       if (m1->selectable()) {
         set_current_item(m1, menu, item);
         return true;
@@ -418,7 +530,7 @@ bool Menu_State::prev_item(menu_index_t menu) { // previous item in menu menu if
   bool wrapped = false;
   do {
     while (--item >= 0) {
-      const Fl_Menu_Item* m1 = m.menu->next(item);
+      const Fl_Menu_Item* m1 = m.item(item);
       if (m1->selectable()) {
         set_current_item(m1, menu, item);
         return true;
@@ -450,6 +562,76 @@ int Menu_State::handle_shortcut() {
   return 0;
 }
 
+/* Compare the start of a label to typed text, ignoring case and single '&'.
+  \return true if the label starts with the text
+*/
+static bool label_starts_with(const char *label, const char *text) {
+  const char *label_end = label + strlen(label), *text_end = text + strlen(text);
+  while (*text) {
+    if (*label == '&' && label[1] != '&') label++;
+    if (!*label) return false;
+    int n1, n2;
+    unsigned c1 = fl_utf8decode(label, label_end, &n1);
+    unsigned c2 = fl_utf8decode(text, text_end, &n2);
+    if (fl_tolower(c1) != fl_tolower(c2)) return false;
+    label += n1;
+    text += n2;
+  }
+  return true;
+}
+
+/* Handle FL_SHORTCUT events that are not a shortcut of a menu item: select
+  the next item in the current menu whose label starts with the text typed
+  within the last second, so that long menus can be searched by typing.
+  Only for menus of an Fl_Menu_ with Fl_Menu_::type_ahead() enabled.
+  \return 1 if an item was found
+*/
+int Menu_State::handle_type_ahead() {
+  if (!button || !button->type_ahead()) return 0;
+  const char *text = Fl::event_text();
+  int len = Fl::event_length();
+  if (len < 1 || (unsigned char)text[0] < ' ' || Fl::event_state(FL_ALT|FL_CTRL|FL_META))
+    return 0;
+  menu_index_t mymenu = current_menu_ix;
+  if (mymenu < 0 || mymenu >= num_menus) mymenu = num_menus - 1;
+  if (in_menubar && mymenu == 0) mymenu = num_menus - 1;
+  if (mymenu < 0 || (in_menubar && mymenu == 0)) return 0;
+  size_t used = strlen(typed);
+  if (Fl::seconds_since(typed_time) > 1.0 || used + len >= sizeof(typed))
+    used = 0;
+  memcpy(typed + used, text, len);
+  typed[used + len] = 0;
+  typed_time = Fl::now();
+  Menu_Window &mw = *(menu_window[mymenu]);
+  item_index_t start = (mymenu == current_menu_ix) ? current_item_ix : mw.selected;
+  // a single character finds the next match, more characters can match the current item
+  if (used == 0 || start < 0) start++;
+  for (item_index_t i = 0; i < mw.num_items; i++) {
+    item_index_t n = (start + i) % mw.num_items;
+    const Fl_Menu_Item *m = mw.item(n);
+    if (m->selectable() && m->labeltype_ < _FL_MULTI_LABEL && label_starts_with(m->text, typed)) {
+      set_current_item(m, mymenu, n);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Handle FL_MOUSEWHEEL events: scroll the menu window under the mouse if it
+  is taller than the screen.
+  \return 1 if the window was scrolled
+*/
+int Menu_State::handle_wheel() {
+  int dy = Fl::event_dy();
+  if (!dy) return 0;
+  for (menu_index_t i = num_menus - 1; i >= 0; i--) {
+    Menu_Window &mw = *(menu_window[i]);
+    if (mw.item_height && mw.is_inside(Fl::event_x_root(), Fl::event_y_root()))
+      return mw.scroll(dy * 3 * mw.item_height) ? 1 : 0;
+  }
+  return 0;
+}
+
 /* Move menu item selection left.
   \return 1
 */
@@ -770,6 +952,7 @@ Menu_Window::Menu_Window(const Fl_Menu_Item* m, int X, int Y, int Wp, int Hp,
   {
     item_index_t j = 0;
     if (m) for (const Fl_Menu_Item* m1=m; ; m1 = m1->next(), j++) {
+      if (m1->text) items.push_back(m1);
       if (picked) {
         if (m1 == picked) {
           selected = j;
@@ -793,52 +976,26 @@ Menu_Window::Menu_Window(const Fl_Menu_Item* m, int X, int Y, int Wp, int Hp,
 
   item_height = 1;
 
-  int shortcuts_w = 0;  // maximum width in pixels of all shortcut texts w/o modifiers
-  int modifiers_w = 0;  // maximum width of all shortcut modifiers texts
   int titile_w = 0;     // width of the title window
   int title_h = 0;      // height of the title window
   if (t) titile_w = t->measure(&title_h, button) + 12;
-  int W = 0;
-  if (m) for (; m->text; m = m->next()) {
-    int hh;
-    int w1 = m->measure(&hh, button);
-    if (hh+Fl::menu_linespacing()>item_height) item_height = hh+Fl::menu_linespacing();
-    if (m->flags&(FL_SUBMENU|FL_SUBMENU_POINTER))
-      w1 += FL_NORMAL_SIZE;
-    if (w1 > W) W = w1;
-    // calculate the maximum width of all shortcuts
-    if (m->shortcut_) {
-      // s is a pointer to the UTF-8 string for the entire shortcut
-      // k points only to the key part (minus the modifier keys)
-      const char *k, *s = fl_shortcut_label(m->shortcut_, &k);
-      if (fl_utf_nb_char((const unsigned char*)k, (int) strlen(k))<=4) {
-        // a regular shortcut has a right-justified modifier followed by a left-justified key
-        w1 = int(fl_width(s, (int) (k-s)));
-        if (w1 > modifiers_w) modifiers_w = w1;
-        w1 = int(fl_width(k))+4;
-        if (w1 > shortcuts_w) shortcuts_w = w1;
-      } else {
-        // a shortcut with a long modifier is right-justified to the menu
-        w1 = int(fl_width(s))+4;
-        if (w1 > (modifiers_w+shortcuts_w)) {
-          modifiers_w = w1-shortcuts_w;
-        }
-      }
-    }
+  // A menu that doesn't fit on the screen and has only plain text labels of
+  // the same height measures its items only when they are scrolled into
+  // view, see measure_visible().
+  bool uniform = (num_items > 0);
+  for (item_index_t i = 0; uniform && i < num_items; i++) {
+    const Fl_Menu_Item *mi = items[i];
+    uniform = (mi->labeltype_ == FL_NORMAL_LABEL && !mi->labelfont_ && !mi->labelsize_
+               && mi->text[0] && !strchr(mi->text, '\n'));
+  }
+  if (uniform) {
+    item_height = item_size(items[0]).h + Fl::menu_linespacing();
+    if (num_items * item_height > scr_h)
+      measured.assign(num_items, false);
   }
-  shortcut_width = shortcuts_w;
-  if (selected >= 0 && !Wp) X -= W/2;
+  if (measured.empty() && num_items)
+    measure_items(0, num_items-1);
   int BW = Fl::box_dx(box());
-  W += shortcuts_w+modifiers_w+2*BW+7;
-  if (Wp > W) W = Wp;
-  if (titile_w > W) W = titile_w;
-
-  if (X < scr_x) X = scr_x;
-  // this change improves popup submenu positioning at right screen edge,
-  // but it makes right_edge argument useless
-  //if (X > scr_x+scr_w-W) X = right_edge-W;
-  if (X > scr_x+scr_w-W) X = scr_x+scr_w-W;
-  x(X); w(W);
   h((num_items ? item_height*num_items-4 : 0)+2*BW+3);
   if (selected >= 0) {
     Y = Y+(Hp-item_height)/2-selected*item_height-BW;
@@ -868,6 +1025,22 @@ Menu_Window::Menu_Window(const Fl_Menu_Item* m, int X, int Y, int Wp, int Hp,
       }
     }
   }
+  if (!measured.empty()) {
+    item_index_t first, last;
+    visible_items(Y, first, last);
+    measure_items(first, last);
+  }
+
+  if (selected >= 0 && !Wp) X -= labels_w/2;
+  min_w = (Wp > titile_w) ? Wp : titile_w;
+  int W = needed_w();
+
+  if (X < scr_x) X = scr_x;
+  // this change improves popup submenu positioning at right screen edge,
+  // but it makes right_edge argument useless
+  //if (X > scr_x+scr_w-W) X = right_edge-W;
+  if (X > scr_x+scr_w-W) X = scr_x+scr_w-W;
+  x(X); w(W);
   if (m) y(Y); else {y(Y-2); w(1); h(1);}
 
   if (t) {
@@ -885,6 +1058,81 @@ Menu_Window::Menu_Window(const Fl_Menu_Item* m, int X, int Y, int Wp, int Hp,
   }
 }
 
+/* Measure menu items and update the widths of labels and shortcuts.
+ \param[in] first, last range of visible items, items that were measured
+    before are skipped
+ \return true if the window is now too narrow for the measured items
+ */
+bool Menu_Window::measure_items(item_index_t first, item_index_t last) {
+  int W = needed_w();
+  for (item_index_t i = first; i <= last; i++) {
+    if (!measured.empty()) {
+      if (measured[i]) continue;
+      measured[i] = true;
+    }
+    const Fl_Menu_Item *mi = items[i];
+    Menu_Item_Size sz = item_size(mi);
+    if (sz.h+Fl::menu_linespacing()>item_height) item_height = sz.h+Fl::menu_linespacing();
+    int w1 = sz.w;
+    if (mi->flags&(FL_SUBMENU|FL_SUBMENU_POINTER))
+      w1 += FL_NORMAL_SIZE;
+    if (w1 > labels_w) labels_w = w1;
+    // calculate the maximum width of all shortcuts
+    if (mi->shortcut_) {
+      if (sz.modifiers_w >= 0) {
+        // a regular shortcut has a right-justified modifier followed by a left-justified key
+        if (sz.modifiers_w > modifiers_w) modifiers_w = sz.modifiers_w;
+        if (sz.key_w > shortcut_width) shortcut_width = sz.key_w;
+      } else if (sz.key_w > modifiers_w+shortcut_width) {
+        // a shortcut with a long modifier is right-justified to the menu
+        modifiers_w = sz.key_w-shortcut_width;
+      }
+    }
+  }
+  return needed_w() > W;
+}
+
+/* Return the width of the window for the items that were measured. */
+int Menu_Window::needed_w() {
+  int W = labels_w+shortcut_width+modifiers_w+2*Fl::box_dx(box())+7;
+  return (min_w > W) ? min_w : W;
+}
+
+/* Find the items that are on the screen if the top of the window is at Y.
+ \param[in] Y vertical position of the window on the screen
+ \param[out] first, last range of visible items, first > last if there is none
+ */
+void Menu_Window::visible_items(int Y, item_index_t &first, item_index_t &last) {
+  // the area the window driver keeps menu windows in, in the coordinates of
+  // y(): under Wayland, a tall menu is placed relative to its parent window
+  int sx, sy, sw, sh;
+  Fl_Window_Driver::driver(this)->menu_window_area(sx, sy, sw, sh, screen_num());
+  int top = sy - Y - Fl::box_dy(box()) - 1;
+  int bottom = sy + sh - Y - Fl::box_dy(box()) - 1;
+  first = (top > 0 && item_height) ? top/item_height - 1 : 0;
+  last = (item_height ? bottom/item_height + 1 : num_items);
+  if (first < 0) first = 0;
+  if (last > num_items-1) last = num_items-1;
+}
+
+/* Measure the items that will be on the screen if the top of the window
+ is at Y, if they were not measured yet, and make the window wider if needed.
+ \param[in] Y vertical position of the window on the screen
+ */
+void Menu_Window::measure_visible(int Y) {
+  if (measured.empty()) return;
+  item_index_t first, last;
+  visible_items(Y, first, last);
+  if (first > last || !measure_items(first, last)) return;
+  int scr_x, scr_y, scr_w, scr_h;
+  Fl_Window_Driver::driver(this)->menu_window_area(scr_x, scr_y, scr_w, scr_h, screen_num());
+  int W = needed_w(), X = x();
+  if (X > scr_x+scr_w-W) X = scr_x+scr_w-W;
+  if (X < scr_x) X = scr_x;
+  if (X != x()) position(X, y());
+  size(W, h());
+}
+
 /* Destroy this window. */
 Menu_Window::~Menu_Window() {
   hide();
@@ -943,7 +1191,10 @@ int Menu_Window::handle_part1(int e) {
       if (pp.handle_keyboard_event()) return 1;
       break;
     case FL_SHORTCUT:
-      if (pp.handle_shortcut()) return 1;
+      if (pp.handle_shortcut() || pp.handle_type_ahead()) return 1;
+      break;
+    case FL_MOUSEWHEEL:
+      if (pp.handle_wheel()) return 1;
       break;
     case FL_MOVE:
     case FL_ENTER:
@@ -988,13 +1239,13 @@ int Menu_Window::handle_part2(int e, int ret) {
 void Menu_Window::set_selected(item_index_t n) {
   if (n != selected) {
     if ((selected!=-1) && (menu)) {
-      const Fl_Menu_Item *mi = menu->next(selected);
+      const Fl_Menu_Item *mi = item(selected);
       if ((mi) && (mi->callback_) && (mi->flags & FL_MENU_CHATTY))
         mi->do_callback(this, FL_REASON_LOST_FOCUS);
     }
     selected = n;
     if ((selected!=-1) && (menu)) {
-      const Fl_Menu_Item *mi = menu->next(selected);
+      const Fl_Menu_Item *mi = item(selected);
       if ((mi) && (mi->callback_) && (mi->flags & FL_MENU_CHATTY))
         mi->do_callback(this, FL_REASON_GOT_FOCUS);
     }
@@ -1016,7 +1267,7 @@ item_index_t Menu_Window::find_selected(int mx, int my) {
     const Fl_Menu_Item* m = menu->first();
     for (; ; m = m->next(), n++) {
       if (!m->text) return -1;
-      xx += m->measure(0, button) + 16;
+      xx += item_size(m).w + 16;
       if (xx > mx) break;
     }
     return n;
@@ -1034,7 +1285,7 @@ int Menu_Window::titlex(int n) {
   const Fl_Menu_Item* m;
   int xx = 3;
   for (m=menu->first(); n--; m = m->next())
-    xx += m->measure(0, button) + 16;
+    xx += item_size(m).w + 16;
   return xx;
 }
 
@@ -1057,8 +1308,30 @@ void Menu_Window::autoscroll(item_index_t n) {
     if (Y < 0) return;
     Y = -Y-10;
   }
+  measure_visible(y()+Y);
   Fl_Window_Driver::driver(this)->reposition_menu_window(x(), y()+Y);
   // y(y()+Y); // don't wait for response from X
+  redraw(); // items that were off the screen were not drawn
+}
+
+/* Scroll a menu that is taller than the screen, for instance with the mouse
+ wheel. The window is moved, but not farther than needed to show its first
+ or its last item.
+ \param[in] dy scroll the items up by this many pixels, or down if negative
+ \return true if the window was moved
+ */
+bool Menu_Window::scroll(int dy) {
+  int scr_x, scr_y, scr_w, scr_h;
+  Fl_Window_Driver::driver(this)->menu_window_area(scr_x, scr_y, scr_w, scr_h, screen_num());
+  if (h() <= scr_h) return false;
+  int Y = y() - dy;
+  if (Y < scr_y+scr_h-h()) Y = scr_y+scr_h-h();
+  if (Y > scr_y) Y = scr_y;
+  if (Y == y()) return false;
+  measure_visible(Y);
+  Fl_Window_Driver::driver(this)->reposition_menu_window(x(), Y);
+  redraw(); // items that were off the screen were not drawn
+  return true;
 }
 
 /* Set the position of this menu and its title window. */
@@ -1187,16 +1460,25 @@ void Menu_Window::draw() {
                   button ? button->color() : color());
     }
     fl_draw_box(box(), 0, 0, w(), h(), button ? button->color() : color());
-    if (menu) {
-      const Fl_Menu_Item* m; int j;
-      for (m=menu->first(), j=0; m->text; j++, m = m->next())
-        draw_entry(m, j, 0);
+    if (menu && num_items) {
+      // only draw the items in the clip region that are on the screen
+      item_index_t first, last;
+      visible_items(y(), first, last);
+      if (item_height) {
+        int X, Y, W, H, top = Fl::box_dy(box()) + 1;
+        fl_clip_box(0, 0, w(), h(), X, Y, W, H);
+        if (Y-top > first*item_height) first = (Y-top)/item_height - 1;
+        if ((Y+H-top)/item_height + 1 < last) last = (Y+H-top)/item_height + 1;
+        if (first < 0) first = 0;
+      }
+      for (item_index_t j = first; j <= last; j++)
+        draw_entry(items[j], j, 0);
     }
   } else {
     if (damage() & FL_DAMAGE_CHILD && selected!=drawn_selected) {
       // change selection
-      draw_entry(menu->next(drawn_selected), drawn_selected, 1);
-      draw_entry(menu->next(selected), selected, 1);
+      draw_entry(item(drawn_selected), drawn_selected, 1);
+      draw_entry(item(selected), selected, 1);
     }
   }
   drawn_selected = selected;
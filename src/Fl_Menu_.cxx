@@ -1,7 +1,7 @@
 //
 // Common menu code for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2024 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -23,6 +23,8 @@
 
 #include <FL/Fl.H>
 #include <FL/Fl_Menu_.H>
+#include "Fl_Menu_Index.H"
+#include "Fl_Menu_Item_Sizes.H"
 #include "flstring.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -74,7 +76,8 @@ int Fl_Menu_::item_pathname_(char *name,
   int level = 0;
   finditem = finditem ? finditem : mvalue();
   menu = menu ? menu : this->menu();
-  for ( int t=0; t<size(); t++ ) {
+  int n = size();
+  for ( int t=0; t<n; t++ ) {
     const Fl_Menu_Item *m = menu + t;
     if (m->submenu()) {                         // submenu? descend
       if (m->flags & FL_SUBMENU_POINTER) {
@@ -196,12 +199,96 @@ int Fl_Menu_::find_index(const Fl_Menu_Item *item) const {
  \see      find_index(const char*)
  */
 int Fl_Menu_::find_index(Fl_Callback *cb) const {
-  for ( int t=0; t < size(); t++ )
+  int n = size();
+  for ( int t=0; t < n; t++ )
     if (menu_[t].callback_==cb)
       return(t);
   return(-1);
 }
 
+/**
+  Sets whether the menu finds items by their path with an index.
+
+  Without the index, which is the default, add() and insert() search the
+  menu array for each submenu of the path of a new item, and find_index()
+  and find_item() compare the path of each item with the given one. This
+  takes a time proportional to the size of the menu, which is too slow to
+  make or search menus with thousands of items.
+
+  The path index is a hash table of the items by their path that finds
+  submenus and items in constant time, and is updated when add() or
+  insert() add items. The menu array is the same as without the index.
+  See also add(const Fl_Menu_Item*, int) to add many items at once.
+
+  The index is built on first use and rebuilt after the menu was changed
+  otherwise, e.g. with remove() or replace(). If you change the label
+  or the FL_SUBMENU flag of an item directly in the menu array, e.g.
+  with Fl_Menu_Item::label(), call invalidate_path_index().
+
+  \param[in] on non-zero to use a path index
+  \version 1.5.0
+*/
+void Fl_Menu_::path_index(int on) {
+  if (on && !index_) {
+    index_ = new Fl_Menu_Index;
+  } else if (!on) {
+    delete index_;
+    index_ = NULL;
+  }
+}
+
+/**
+  Makes the menu rebuild its path index before it is used again.
+  This is done automatically when the menu is changed with the methods
+  of Fl_Menu_. Call this if the label or the flags of an item were
+  changed otherwise.
+  \see path_index(int)
+  \version 1.5.0
+*/
+void Fl_Menu_::invalidate_path_index() {
+  if (index_) index_->invalidate();
+}
+
+// Checks that the path of the item at an index entry is exactly the
+// first len characters of pathname, as find_index(const char*) makes it
+static bool has_path(const Fl_Menu_Item *menu, const Fl_Menu_Index::Entry *e,
+                     const char *pathname, size_t len) {
+  const char *label = menu[e->pos].text;
+  if (!label || !*label) return false;
+  size_t n = strlen(label);
+  if (n > len || memcmp(pathname + len - n, label, n)) return false;
+  if (!e->parent) return n == len;
+  return n < len && pathname[len - n - 1] == '/' &&
+         has_path(menu, e->parent, pathname, len - n - 1);
+}
+
+// Finds a menu item by its path with the path index. Returns its index,
+// -1 if there is none, or -2 if the menu must be searched because an
+// indexed item has changed or has a similar label, e.g. with another '&',
+// or because a label contains a '/'.
+static int indexed_find(Fl_Menu_Index *mi, const Fl_Menu_Item *menu, const char *pathname) {
+  if (!mi->valid(menu)) mi->build(menu, menu->size());
+  if (mi->slashes()) return -2;
+  std::string path;
+  for (const char *p = pathname; *p; p++) {
+    if (*p == '/') path += '\0';
+    else if (*p != '&') path += *p;
+  }
+  path += '\0';
+  size_t len = strlen(pathname);
+  int found = -1;
+  for (int i = 0; i < 2; i++) {
+    Fl_Menu_Index::Entry *e = mi->find(i ? 'I' : 'S', path);
+    if (!e) continue;
+    if (e->pos >= mi->size() || !menu[e->pos].text ||
+        (i == 0) != ((menu[e->pos].flags & FL_SUBMENU) != 0) ||
+        !has_path(menu, e, pathname, len))
+      return -2;
+    if (found < 0 || e->pos < found) found = e->pos;
+  }
+  return found;
+}
+
 /**
  Find the menu item index for a given menu \p pathname, such as "Edit/Copy".
 
@@ -212,12 +299,17 @@ int Fl_Menu_::find_index(Fl_Callback *cb) const {
 
  \param[in] pathname The path and name of the menu item to find
  \returns        The index of the matching item, or -1 if not found.
- \see            item_pathname()
+ \see            item_pathname(), path_index(int)
 
 */
 int Fl_Menu_::find_index(const char *pathname) const {
+  if (index_ && menu_) {
+    int t = indexed_find(index_, menu_, pathname);
+    if (t >= -1) return t;
+  }
   char menupath[1024] = "";     // File/Export
-  for ( int t=0; t < size(); t++ ) {
+  int n = size();
+  for ( int t=0; t < n; t++ ) {
     Fl_Menu_Item *m = menu_ + t;
     if (m->flags&FL_SUBMENU) {
       // IT'S A SUBMENU
@@ -257,7 +349,8 @@ int Fl_Menu_::find_index(const char *pathname) const {
  \see find_item(const char*)
  */
 const Fl_Menu_Item * Fl_Menu_::find_item(Fl_Callback *cb) {
-  for ( int t=0; t < size(); t++ ) {
+  int n = size();
+  for ( int t=0; t < n; t++ ) {
     const Fl_Menu_Item *m = menu_ + t;
     if (m->callback_==cb) {
       return m;
@@ -274,7 +367,8 @@ const Fl_Menu_Item * Fl_Menu_::find_item(Fl_Callback *cb) {
  \see find_item(const char*)
  */
 const Fl_Menu_Item* Fl_Menu_::find_item_with_user_data(void *v) {
-  for ( int t=0; t < size(); t++ ) {
+  int n = size();
+  for ( int t=0; t < n; t++ ) {
     const Fl_Menu_Item *m = menu_ + t;
     if (m->user_data_==v) {
       return m;
@@ -291,7 +385,8 @@ const Fl_Menu_Item* Fl_Menu_::find_item_with_user_data(void *v) {
  \see find_item(const char*)
  */
 const Fl_Menu_Item* Fl_Menu_::find_item_with_argument(long v) {
-  for ( int t=0; t < size(); t++ ) {
+  int n = size();
+  for ( int t=0; t < n; t++ ) {
     const Fl_Menu_Item *m = menu_ + t;
     if (m->argument()==v) {
       return m;
@@ -497,6 +592,9 @@ Fl_Menu_::Fl_Menu_(int X,int Y,int W,int H,const char* l)
   menu_(NULL),
   value_(NULL),
   prev_value_(NULL),
+  index_(NULL),
+  sizes_(NULL),
+  type_ahead_(0),
   alloc(0),
   down_box_(FL_NO_BOX),
   menu_box_(FL_NO_BOX),
@@ -556,6 +654,8 @@ void Fl_Menu_::copy(const Fl_Menu_Item* m, void* ud) {
 
 Fl_Menu_::~Fl_Menu_() {
   clear();
+  delete index_;
+  delete sizes_;
 }
 
 // Fl_Menu::add() uses this to indicate the owner of the dynamically-
@@ -605,6 +705,8 @@ void Fl_Menu_::clear() {
   }
   menu_ = 0;
   value_ = prev_value_ = 0;
+  if (index_) index_->invalidate();
+  if (sizes_) sizes_->clear();
 }
 
 /**
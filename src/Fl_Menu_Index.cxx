@@ -0,0 +1,116 @@
+//
+// Path index of menu items for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include "Fl_Menu_Index.H"
+#include <stdio.h>
+
+Fl_Menu_Index::Entry *Fl_Menu_Index::new_entry(int pos, Entry *parent) {
+  Entry e = { pos, parent, 0 };
+  entries_.push_back(e);
+  return &entries_.back();
+}
+
+// Appends a label to a path, without '&' characters (see compare() in
+// Fl_Menu_add.cxx)
+void Fl_Menu_Index::append_label(std::string &path, const char *label) {
+  for (; *label; label++)
+    if (*label != '&') path += *label;
+  path += '\0';
+}
+
+// Items with image or multi labels don't have a text label, their key
+// can't match any text.
+void Fl_Menu_Index::append_label(std::string &path, const Fl_Menu_Item *item) {
+  if (item->labeltype_ == _FL_IMAGE_LABEL || item->labeltype_ == _FL_MULTI_LABEL) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "\001%p", (const void*)item->text);
+    path += buf;
+    path += '\0';
+  } else {
+    append_label(path, item->text);
+  }
+}
+
+// Indexes all items of a menu array of size items, including the terminator
+void Fl_Menu_Index::build(const Fl_Menu_Item *menu, int size) {
+  map_.clear();
+  entries_.clear();
+  at_.assign(size, (Entry*)0);
+  slashes_ = false;
+  std::string path;               // labels of the open submenus
+  std::vector<size_t> lengths;    // length of path before each open submenu
+  std::vector<Entry*> parents;    // the open submenus
+  std::vector<bool> shadowed;     // whether an open submenu isn't indexed
+  for (int i = 0; i < size; i++) {
+    const Fl_Menu_Item *m = menu + i;
+    Entry *e = new_entry(i, parents.empty() ? 0 : parents.back());
+    at_[i] = e;
+    if (!m->text) {
+      if (parents.empty()) continue; // end of the menu
+      parents.back()->end = e;
+      parents.pop_back();
+      shadowed.pop_back();
+      path.resize(lengths.back());
+      lengths.pop_back();
+      continue;
+    }
+    bool submenu = (m->flags & FL_SUBMENU) != 0;
+    size_t len = path.size();
+    append_label(path, m);
+    if (path.find('/', len) != std::string::npos) slashes_ = true;
+    bool first = false;
+    if (shadowed.empty() || !shadowed.back())
+      first = map_.insert(std::make_pair((submenu ? 'S' : 'I') + path, e)).second;
+    if (submenu) {
+      parents.push_back(e);
+      shadowed.push_back(!first);
+      lengths.push_back(len);
+    } else {
+      path.resize(len);
+    }
+  }
+  menu_ = menu;
+  valid_ = true;
+}
+
+Fl_Menu_Index::Entry *Fl_Menu_Index::find(char type, const std::string &path) const {
+  std::unordered_map<std::string, Entry*>::const_iterator it = map_.find(type + path);
+  return it == map_.end() ? 0 : it->second;
+}
+
+// Makes room for count items inserted at pos
+void Fl_Menu_Index::inserted(int pos, int count) {
+  at_.insert(at_.begin() + pos, count, (Entry*)0);
+  int size = (int)at_.size();
+  for (int i = pos + count; i < size; i++) at_[i]->pos = i;
+}
+
+// Adds the entry of an inserted item. The key is only indexed if it's new.
+Fl_Menu_Index::Entry *Fl_Menu_Index::add(char type, const std::string &path, int pos, Entry *parent) {
+  Entry *e = new_entry(pos, parent);
+  at_[pos] = e;
+  map_.insert(std::make_pair(type + path, e));
+  if (path.find('/') != std::string::npos) slashes_ = true;
+  return e;
+}
+
+// Adds the entries of an inserted submenu title at pos and its terminator
+Fl_Menu_Index::Entry *Fl_Menu_Index::add_submenu(const std::string &path, int pos, Entry *parent) {
+  Entry *e = add('S', path, pos, parent);
+  e->end = new_entry(pos + 1, e);
+  at_[pos + 1] = e->end;
+  return e;
+}
@@ -1,7 +1,7 @@
 //
 // Menu utilities for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2023 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -26,9 +26,13 @@
 
 #include <FL/Fl_Menu_.H>
 #include <FL/fl_string_functions.h>
+#include "Fl_Menu_Index.H"
 #include "flstring.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 // If the array is this, we will double-reallocate as necessary:
 static Fl_Menu_Item* local_array = 0;
@@ -92,6 +96,29 @@ static int compare(const char* a, const char* b) {
 }
 
 
+// Gets the next label of a menu path: a label starting with '/' is the
+// whole rest of the path, otherwise it is copied to buf up to the next '/',
+// changing \x to x, and a leading '_' sets FL_MENU_DIVIDER in flags.
+// Sets text to the rest of the path after the '/', or to NULL if this
+// is the label of the item itself.
+static const char *path_label(const char *&text, char *buf, int &flags) {
+  if (*text == '/') { // leading slash makes us assume it is a filename
+    const char *item = text;
+    text = 0;
+    return item;
+  }
+  // leading underscore causes divider line:
+  if (*text == '_') {text++; flags = FL_MENU_DIVIDER;}
+  // copy to buf, changing \x to x:
+  const char *p;
+  char *q = buf;
+  for (p=text; *p && *p != '/'; *q++ = *p++) if (*p=='\\' && p[1]) p++;
+  *q = 0;
+  text = (*p == '/') ? p+1 : 0;
+  return buf;
+}
+
+
 /** Adds a menu item.
 
   The text is split at '/' characters to automatically
@@ -142,8 +169,6 @@ int Fl_Menu_Item::insert(
 ) {
   Fl_Menu_Item *array = this;
   Fl_Menu_Item *m = this;
-  const char *p;
-  char *q;
   char buf[1024];
 
   int msize = array==local_array ? local_array_size : array->size();
@@ -153,21 +178,9 @@ int Fl_Menu_Item::insert(
   // split at slashes to make submenus:
   for (;;) {
 
-    // leading slash makes us assume it is a filename:
-    if (*mytext == '/') {item = mytext; break;}
-
-    // leading underscore causes divider line:
-    if (*mytext == '_') {mytext++; flags1 = FL_MENU_DIVIDER;}
-
-    // copy to buf, changing \x to x:
-    q = buf;
-    for (p=mytext; *p && *p != '/'; *q++ = *p++) if (*p=='\\' && p[1]) p++;
-    *q = 0;
-
-    item = buf;
-    if (*p != '/') break; /* not a menu title */
+    item = path_label(mytext, buf, flags1);
+    if (!mytext) break;   /* not a menu title */
     index = -1;           /* any submenu specified overrides insert position */
-    mytext = p+1;         /* point at item title */
 
     /* find a matching menu title: */
     for (; m->text; m = m->next())
@@ -211,6 +224,94 @@ int Fl_Menu_Item::insert(
 }
 
 
+// Same as Fl_Menu_Item::insert() on the local array of the menu owning it,
+// but finds the submenus and the item with the path index of the menu and
+// updates it. Returns -1 without changing the menu if an indexed item has
+// changed, the index must then be rebuilt.
+static int indexed_insert(
+  Fl_Menu_Index *mi,
+  int index,
+  const char *mytext,
+  int sc,
+  Fl_Callback *cb,
+  void *data,
+  int myflags
+) {
+  Fl_Menu_Item *array = local_array;
+  Fl_Menu_Item *m;
+  char buf[1024];
+
+  int msize = local_array_size;
+  int flags1 = 0;
+  const char* item;
+  std::string path;
+  Fl_Menu_Index::Entry *parent = 0, *e;
+
+  // split at slashes to make submenus:
+  for (;;) {
+
+    item = path_label(mytext, buf, flags1);
+    if (!mytext) break;   /* not a menu title */
+    index = -1;           /* any submenu specified overrides insert position */
+
+    /* find a matching menu title: */
+    Fl_Menu_Index::append_label(path, item);
+    e = mi->find('S', path);
+    if (e) {
+      m = array + e->pos;
+      if (!m->text || !(m->flags&FL_SUBMENU) || compare(item, m->text)) return -1;
+    } else { /* create a new menu */
+      int n = mi->end_of(parent);
+      array = array_insert(array, msize, n, item, FL_SUBMENU|flags1);
+      msize++;
+      array = array_insert(array, msize, n+1, 0, 0);
+      msize++;
+      mi->inserted(n, 2);
+      e = mi->add_submenu(path, n, parent);
+    }
+    parent = e;
+    flags1 = 0;
+  }
+
+  /* find a matching menu item: */
+  Fl_Menu_Index::append_label(path, item);
+  e = mi->find('I', path);
+  if (e) {
+    m = array + e->pos;
+    if (!m->text || (m->flags&FL_SUBMENU) || compare(m->text, item)) return -1;
+    if (myflags & FL_SUBMENU) mi->invalidate(); // the item becomes a submenu title
+  } else {              /* add a new menu item */
+    int n = (index==-1) ? mi->end_of(parent) : index;
+    array = array_insert(array, msize, n, item, myflags|flags1);
+    msize++;
+    if (myflags & FL_SUBMENU) { // add submenu delimiter
+      array = array_insert(array, msize, n+1, 0, 0);
+      msize++;
+    }
+    if (index != -1)
+      mi->invalidate(); // the parent of the item isn't known
+    else if (myflags & FL_SUBMENU) {
+      mi->inserted(n, 2);
+      mi->add_submenu(path, n, parent);
+    } else {
+      mi->inserted(n, 1);
+      mi->add('I', path, n, parent);
+    }
+    m = array+n;
+  }
+
+  /* fill it in */
+  m->shortcut_ = sc;
+  m->callback_ = cb;
+  m->user_data_ = data;
+  m->flags = myflags|flags1;
+
+  local_array_size = msize;
+  mi->moved(array);
+  return (int) (m-array);
+}
+
+
 /**
   Adds a new menu item.
 
@@ -416,7 +517,20 @@ int Fl_Menu_::insert(
     }
     fl_menu_array_owner = this;
   }
-  int r = menu_->insert(index,label,shortcut,callback,userdata,flags);
+  int r = -1;
+  if (index_) {
+    if (!index_->valid(local_array) || index_->size() != local_array_size)
+      index_->build(local_array, local_array_size);
+    r = indexed_insert(index_, index, label, shortcut, callback, userdata, flags);
+    if (r < 0) { // the menu was changed otherwise, try again with a new index
+      index_->build(local_array, local_array_size);
+      r = indexed_insert(index_, index, label, shortcut, callback, userdata, flags);
+    }
+  }
+  if (r < 0) {
+    r = menu_->insert(index,label,shortcut,callback,userdata,flags);
+    if (index_) index_->invalidate();
+  }
   // if it rellocated array we must fix the pointer:
   int value_offset = (int) (value_-menu_);
   menu_ = local_array; // in case it reallocated it
@@ -460,6 +574,187 @@ int Fl_Menu_::add(const char *str) {
 }
 
 
+// A new item of Fl_Menu_::add(const Fl_Menu_Item*, int) and its children
+struct Fl_Menu_Bulk_Node {
+  Fl_Menu_Item item;
+  int first, last;      // first and last child, or -1
+  int next;             // next sibling, or -1
+  int pos;              // position in the new menu array
+};
+
+// Appends node c to a list of nodes
+static void bulk_link(std::vector<Fl_Menu_Bulk_Node> &nodes, int &first, int &last, int c) {
+  if (last >= 0) nodes[last].next = c;
+  else first = c;
+  last = c;
+}
+
+// Copies a list of new items and their children to the menu array
+static void bulk_emit(std::vector<Fl_Menu_Bulk_Node> &nodes, int c, Fl_Menu_Item *array, int &n) {
+  for (; c >= 0; c = nodes[c].next) {
+    Fl_Menu_Bulk_Node &node = nodes[c];
+    node.pos = n;
+    array[n++] = node.item;
+    bulk_emit(nodes, node.first, array, n);
+    if (node.item.flags & FL_SUBMENU) memset(array + n++, 0, sizeof(Fl_Menu_Item));
+  }
+}
+
+/**
+  Adds many menu items at once.
+
+  This does the same as calling add(const char*, int, Fl_Callback*, void*, int)
+  with the text, shortcut, callback, user data and flags of each of the
+  \p n items in order: the text may be a path like "File/Recent/foo" to
+  make submenus, an item with the same path as an existing one replaces
+  it, and new items are added at the end of their submenu. Other members
+  of the items, e.g. the label type, are ignored, and items without text
+  are skipped.
+
+  Calling add() for each item searches the submenus and moves all
+  following items of the menu array for every new item, which takes
+  a time proportional to the square of the number of items. This method
+  finds the submenus and items with a hash table instead and builds the
+  new menu array in a single pass, so that menus with thousands of items,
+  e.g. lists of fonts or files, can be made quickly.
+
+  \param[in] items  the items to add
+  \param[in] n      the number of items
+  \returns the index into the menu() array of the last added item, or -1
+    if there was none
+  \see add(const char*, int, Fl_Callback*, void*, int)
+  \version 1.5.0
+*/
+int Fl_Menu_::add(const Fl_Menu_Item *items, int n) {
+  // make the menu array private, and not the local array of insert():
+  if (this == fl_menu_array_owner) menu_end();
+  if (menu_ && !alloc) copy(menu_);
+  Fl_Menu_Item empty;
+  memset(&empty, 0, sizeof(empty));
+  Fl_Menu_Item *old = menu_ ? menu_ : &empty;
+  int old_size = old->size();
+
+  Fl_Menu_Index index;
+  index.build(old, old_size);
+  std::unordered_map<std::string, int> keys; // new submenus and items
+  std::vector<Fl_Menu_Bulk_Node> nodes;
+  std::vector<int> first(old_size, -1), last(old_size, -1); // new items before each old one
+  int added = 0;        // number of new items, including terminators
+  int r_old = -1, r_new = -1;
+  char buf[1024];
+
+  for (int i = 0; i < n; i++) {
+    const char *mytext = items[i].text;
+    if (!mytext) continue;
+    int flags1 = 0;
+    const char *item;
+    std::string path;
+    Fl_Menu_Index::Entry *parent_entry = 0; // parent in the old array
+    int parent_node = -1;                   // or new parent
+    int c;
+
+    // split at slashes to make submenus:
+    for (;;) {
+      item = path_label(mytext, buf, flags1);
+      if (!mytext) break;
+      Fl_Menu_Index::append_label(path, item);
+      Fl_Menu_Index::Entry *e = (parent_node < 0) ? index.find('S', path) : 0;
+      if (e) {
+        parent_entry = e;
+      } else {
+        std::unordered_map<std::string, int>::iterator it = keys.find('S' + path);
+        if (it != keys.end()) {
+          c = it->second;
+        } else { // create a new menu
+          c = (int)nodes.size();
+          Fl_Menu_Bulk_Node node;
+          memset(&node.item, 0, sizeof(Fl_Menu_Item));
+          node.item.text = fl_strdup(item);
+          node.item.flags = FL_SUBMENU|flags1;
+          node.item.labelfont_ = FL_HELVETICA;
+          node.first = node.last = node.next = -1;
+          nodes.push_back(node);
+          if (parent_node >= 0) {
+            bulk_link(nodes, nodes[parent_node].first, nodes[parent_node].last, c);
+          } else {
+            int p = index.end_of(parent_entry);
+            bulk_link(nodes, first[p], last[p], c);
+          }
+          keys['S' + path] = c;
+          added += 2;
+        }
+        parent_node = c;
+      }
+      flags1 = 0;
+    }
+
+    // find a matching menu item:
+    Fl_Menu_Index::append_label(path, item);
+    int myflags = items[i].flags;
+    Fl_Menu_Index::Entry *e = (parent_node < 0) ? index.find('I', path) : 0;
+    Fl_Menu_Item *m;
+    if (e) {
+      m = old + e->pos;
+      r_old = e->pos;
+      r_new = -1;
+    } else {
+      std::unordered_map<std::string, int>::iterator it = keys.find('I' + path);
+      if (it != keys.end()) {
+        c = it->second;
+      } else { // add a new menu item
+        c = (int)nodes.size();
+        Fl_Menu_Bulk_Node node;
+        memset(&node.item, 0, sizeof(Fl_Menu_Item));
+        node.item.text = fl_strdup(item);
+        node.item.labelfont_ = FL_HELVETICA;
+        node.first = node.last = node.next = -1;
+        nodes.push_back(node);
+        if (parent_node >= 0) {
+          bulk_link(nodes, nodes[parent_node].first, nodes[parent_node].last, c);
+        } else {
+          int p = index.end_of(parent_entry);
+          bulk_link(nodes, first[p], last[p], c);
+        }
+        if (!(myflags & FL_SUBMENU))
+          keys['I' + path] = c;
+        else if (parent_node >= 0 || !index.find('S', path))
+          keys.insert(std::make_pair('S' + path, c)); // the first one is used
+        added += (myflags & FL_SUBMENU) ? 2 : 1;
+      }
+      m = &nodes[c].item;
+      r_new = c;
+    }
+
+    // fill it in:
+    m->shortcut_ = items[i].shortcut_;
+    m->callback_ = items[i].callback_;
+    m->user_data_ = items[i].user_data_;
+    m->flags = myflags|flags1;
+  }
+  if (r_old < 0 && r_new < 0) return -1;
+
+  // make the new menu array:
+  Fl_Menu_Item *array = new Fl_Menu_Item[old_size + added];
+  int value_pos = (value_ >= old && value_ < old + old_size) ? (int)(value_ - old) : -1;
+  int prev_pos = (prev_value_ >= old && prev_value_ < old + old_size) ? (int)(prev_value_ - old) : -1;
+  int k = 0, r = -1;
+  for (int i = 0; i < old_size; i++) {
+    bulk_emit(nodes, first[i], array, k);
+    if (i == value_pos) value_ = array + k;
+    if (i == prev_pos) prev_value_ = array + k;
+    if (i == r_old) r = k;
+    array[k++] = old[i];
+  }
+  if (r_new >= 0) r = nodes[r_new].pos;
+
+  if (old != &empty) delete[] old;
+  else alloc = 2; // indicates that the strings can be freed
+  menu_ = array;
+  if (index_) index_->invalidate();
+  return r;
+}
+
+
 
 /**
   Changes the text of item \p i.  This is the only way to get
@@ -472,6 +767,7 @@ int Fl_Menu_::add(const char *str) {
 void Fl_Menu_::replace(int i, const char *str) {
   if (i<0 || i>=size()) return;
   if (!alloc) copy(menu_);
+  if (index_) index_->invalidate();
   if (alloc > 1) {
     free((void *)menu_[i].text);
       str = fl_strdup(str?str:"");
@@ -503,6 +799,9 @@ void Fl_Menu_::remove(int i) {
   }
   // MRS: "n" is the menu size(), which includes the trailing NULL entry...
   memmove(item, next_item, (menu_+n-next_item)*sizeof(Fl_Menu_Item));
+  if (menu_ == local_array && this == fl_menu_array_owner)
+    local_array_size = n - (int)(next_item - item);
+  if (index_) index_->invalidate();
 }
 
 /**
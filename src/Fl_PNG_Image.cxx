@@ -4,7 +4,7 @@
 // Copyright 1997-2012 by Easy Software Products.
 // Image support by Matthias Melcher, Copyright 2000-2009.
 //
-// Copyright 2013-2022 by Bill Spitzak and others.
+// Copyright 2013-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -32,6 +32,7 @@
 #include <FL/Fl_PNG_Image.H>
 #include <FL/Fl_Shared_Image.H>
 #include <FL/fl_utf8.h>
+#include "Fl_Image_Reader.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -116,7 +117,56 @@ Fl_PNG_Image::Fl_PNG_Image (
 }
 
 
-void Fl_PNG_Image::load_png_(const char *name_png, int offset, const unsigned char *buffer_png, int maxsize)
+/**
+ Decodes a PNG image file row by row without creating an image.
+
+ The callback gets the size of the image first and then bands of decoded
+ rows, as described for Fl_Image_Rows. Unless the callback sets its own
+ target buffer, only a few rows are kept in memory at any time, so this
+ works for images that are too large for Fl_PNG_Image (see
+ Fl_RGB_Image::max_size()). Interlaced images are the exception: all rows are
+ kept and passed to the callback after each of the 7 passes, which can be
+ used to show the image while it is being loaded.
+
+ \param[in] filename  name of the PNG file
+ \param[in] cb        callback that receives the decoded rows
+ \param[in] data      user data passed to \p cb
+ \return 0 on success, Fl_Image::ERR_FILE_ACCESS or Fl_Image::ERR_FORMAT on
+    errors, or Fl_Image_Rows::STOP if \p cb stopped decoding
+
+ \version 1.5.0
+ */
+int Fl_PNG_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+{
+  Fl_Image_Band band(cb, data);
+  Fl_PNG_Image img;
+  img.load_png_(filename, 0, NULL, 0, &band);
+  return band.result() ? band.result() : img.ld();
+}
+
+/**
+ Decodes a PNG image in memory row by row without creating an image.
+ \param[in] buffer    start of the PNG image in memory
+ \param[in] datasize  size in bytes of the PNG image in memory
+ \param[in] cb        callback that receives the decoded rows
+ \param[in] data      user data passed to \p cb
+ \return 0 on success, Fl_Image::ERR_FORMAT on errors, or Fl_Image_Rows::STOP
+    if \p cb stopped decoding
+ \see Fl_PNG_Image::decode(const char *filename, Fl_Image_Rows_Cb cb, void *data)
+ \version 1.5.0
+ */
+int Fl_PNG_Image::decode(const unsigned char *buffer, int datasize, Fl_Image_Rows_Cb cb, void *data)
+{
+  Fl_Image_Band band(cb, data);
+  Fl_PNG_Image img;
+  img.load_png_(NULL, 0, buffer, datasize, &band);
+  return band.result() ? band.result() : img.ld();
+}
+
+// If band is given, rows are passed to its callback instead of being stored
+// in the image.
+void Fl_PNG_Image::load_png_(const char *name_png, int offset, const unsigned char *buffer_png, int maxsize,
+                             Fl_Image_Band *band)
 {
 #if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
   int i;                // Looping var
@@ -214,6 +264,26 @@ void Fl_PNG_Image::load_png_(const char *name_png, int offset, const unsigned ch
     png_set_tRNS_to_alpha(pp);
 #  endif // HAVE_PNG_GET_VALID && HAVE_PNG_SET_TRNS_TO_ALPHA
 
+  if (band) {
+    // Decode row by row. Rows of interlaced images are combined with
+    // those of earlier passes, so they need to stay in memory.
+    int passes = png_set_interlace_handling(pp);
+    int stop = band->begin(w(), h(), d(), passes, passes > 1);
+    if (!stop && band->error()) longjmp(png_jmpbuf(pp), 1);
+    for (int pass = 0; pass < passes && !stop; pass ++) {
+      for (i = 0; i < h() && !stop; i ++) {
+        png_read_row(pp, band->row(i), NULL);
+        if (passes == 1) stop = band->done(i);
+      }
+      if (passes > 1 && !stop) stop = band->deliver(0, h(), pass);
+    }
+    if (!stop) png_read_end(pp, info);
+    png_destroy_read_struct(&pp, &info, NULL);
+    if (!from_memory) fclose(*fp);
+    delete fp;
+    return;
+  }
+
   if (((size_t)w()) * h() * d() > max_size() ) longjmp(png_jmpbuf(pp), 1);
   array = new uchar[w() * h() * d()];
   alloc_array = 1;
@@ -56,7 +56,10 @@ Fl_Pixmap::~Fl_Pixmap() {
   delete_data();
 }
 
+void fl_uncache_pixmap_rgba_(const Fl_Pixmap *pxm);
+
 void Fl_Pixmap::uncache() {
+  fl_uncache_pixmap_rgba_(this);
   if (id_) {
     Fl_Graphics_Driver::default_driver().uncache_pixmap(id_);
     id_ = 0;
@@ -2,7 +2,7 @@
 // Preferences methods for the Fast Light Tool Kit (FLTK).
 //
 // Copyright 2002-2010 by Matthias Melcher.
-// Copyright 2011-2024 by Bill Spitzak and others.
+// Copyright 2011-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -1243,9 +1243,9 @@ char Fl_Preferences::get_userdata_path( char *path, int pathlen ) {
  database to disk.
 
  \return -1 if anything went wrong, i.e. file could not be opened, permissions
-    blocked writing, etc.
- \return 0 if the file was written to disk. This does not check if the disk ran
-    out of space and the file is truncated.
+    blocked writing, the disk ran out of space, etc. The previous file is kept
+    unchanged in that case.
+ \return 0 if the file was written to disk.
  \return 1 if no data was written to the database and no write attempt
     to disk was made.
  */
@@ -1336,6 +1336,7 @@ Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs, Root root, const char
   filename_(0L),
   vendor_(0L),
   application_(0L),
+  buffer_(0L),
   root_type_((Root)(root & ~CLEAR))
 {
   char *filename = Fl::system_driver()->preference_rootnode(prefs, root, vendor, application);
@@ -1353,6 +1354,7 @@ Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs, const char *path, con
   filename_(0L),
   vendor_(0L),
   application_(0L),
+  buffer_(0L),
   root_type_( (Root)(USER | (flags & C_LOCALE) ))
 {
 
@@ -1379,6 +1381,7 @@ Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs )
   filename_(0L),
   vendor_(0L),
   application_(0L),
+  buffer_(0L),
   root_type_(Fl_Preferences::MEMORY)
 {
 }
@@ -1401,6 +1404,10 @@ Fl_Preferences::RootNode::~RootNode() {
   }
   delete prefs_->node;
   prefs_->node = 0L;
+  if ( buffer_ ) {              // free the file contents after the nodes that point into it
+    free( buffer_ );
+    buffer_ = 0L;
+  }
 }
 
 // read a preference file and construct the group tree and all entry leaves
@@ -1423,35 +1430,43 @@ int Fl_Preferences::RootNode::read() {
     prefs_->node->clearDirtyFlags();
     return -1;
   }
-  char buf[1024];
   FILE *f = fl_fopen( filename_, "rb" );
   if ( !f )
     return -1;
-  if (fgets( buf, 1024, f )==0) { /* ignore: "; FLTK preferences file format 1.0" */ }
-  if (fgets( buf, 1024, f )==0) { /* ignore: "; vendor: ..." */ }
-  if (fgets( buf, 1024, f )==0) { /* ignore: "; application: ..." */ }
+  // Read the entire file into one buffer. Groups are only split into entries
+  // when they are first accessed, until then they point into this buffer.
+  fseek( f, 0, SEEK_END );
+  long size = ftell( f );
+  fseek( f, 0, SEEK_SET );
+  if ( size < 0 || buffer_ ) {
+    fclose( f );
+    return -1;
+  }
+  buffer_ = (char*)malloc( size+1 );
+  size = (long)fread( buffer_, 1, size, f );
+  buffer_[ size ] = 0;
+  fclose( f );
+  char *s = buffer_;
+  for ( int i = 0; i < 3 && *s; i++ ) {     // ignore: "; FLTK preferences file format 1.0",
+    char *e = strchr( s, '\n' );            // "; vendor: ...", and "; application: ..."
+    s = e ? e+1 : s+strlen( s );
+  }
   Node *nd = prefs_->node;
-  for (;;) {
-    if ( !fgets( buf, 1024, f ) ) break;        // EOF or Error
-    if ( buf[0]=='[' ) {                        // read a new group
-      size_t end = strcspn( buf+1, "]\n\r" );
-      buf[ end+1 ] = 0;
-      nd = prefs_->node->find( buf+1 );
-    } else if ( buf[0]=='+' ) {                 // value of previous name/value pair spans multiple lines
-      size_t end = strcspn( buf+1, "\n\r" );
-      if ( end != 0 ) {                         // if entry is not empty
-        buf[ end+1 ] = 0;
-        if (nd) nd->add( buf+1 );
-      }
-    } else {                                     // read a name/value pair
-      size_t end = strcspn( buf, "\n\r" );
-      if ( end != 0 ) {                         // if entry is not empty
-        buf[ end ] = 0;
-        if (nd) nd->set( buf );
-      }
+  char *body = s;
+  while ( *s ) {
+    char *e = strchr( s, '\n' );
+    char *next = e ? e+1 : s+strlen( s );
+    if ( s[0]=='[' ) {                          // read a new group
+      s[0] = 0;                                 // terminate the body of the previous group
+      if (nd) nd->setBody( body );
+      char *name = s+1;
+      name[ strcspn( name, "]\n\r" ) ] = 0;
+      nd = prefs_->node->find( name );
+      body = next;
     }
+    s = next;
   }
-  fclose( f );
+  if (nd) nd->setBody( body );
   prefs_->node->clearDirtyFlags();
   return 0;
 }
@@ -1471,14 +1486,27 @@ int Fl_Preferences::RootNode::write() {
   if ( ((root_type_&Fl_Preferences::ROOT_MASK)==Fl_Preferences::SYSTEM) && !(fileAccess_ & Fl_Preferences::SYSTEM_WRITE_OK) )
     return -1;
   fl_make_path_for_file(filename_);
-  FILE *f = fl_fopen( filename_, "wb" );
+  // Write to a new file next to the original first and replace the original
+  // file only if that succeeded, so an interrupted write never leaves a
+  // truncated file. A symbolic link to the file stays a link.
+  std::string target, tmpname;
+  FILE *f = Fl::system_driver()->open_replacement_file( filename_, target, tmpname );
   if ( !f )
     return -1;
   fprintf( f, "; FLTK preferences file format 1.0\n" );
   fprintf( f, "; vendor: %s\n", vendor_ );
   fprintf( f, "; application: %s\n", application_ );
   prefs_->node->write( f );
-  fclose( f );
+  int err = ferror( f );
+  if ( fclose( f ) != 0 )
+    err = 1;
+  if ( !err && Fl::system_driver()->replace_file( tmpname.c_str(), target.c_str() ) != 0 )
+    err = 1;
+  if ( err ) {
+    fl_unlink( tmpname.c_str() );
+    return -1;
+  }
+  prefs_->node->clearDirtyFlags();
   if (Fl::system_driver()->preferences_need_protection_check()) {
     // unix: make sure that system prefs are user-readable
     if (strncmp(filename_, "/etc/fltk/", 10) == 0) {
@@ -1547,6 +1575,16 @@ char Fl_Preferences::RootNode::getPath( char *path, int pathlen ) {
   return ret;
 }
 
+// hash a name for the entry and child lookup tables (FNV-1a)
+static unsigned int hash_name( const char *name, size_t len ) {
+  unsigned int h = 2166136261U;
+  for ( size_t i = 0; i < len; i++ ) {
+    h ^= (unsigned char)name[i];
+    h *= 16777619U;
+  }
+  return h;
+}
+
 // create a node that represents a group
 // - path must be a single word, preferable alnum(), dot and underscore only. Space is ok.
 Fl_Preferences::Node::Node( const char *path ) {
@@ -1554,11 +1592,17 @@ Fl_Preferences::Node::Node( const char *path ) {
   first_child_ = 0; next_ = 0; parent_ = 0;
   entry_ = 0;
   nEntry_ = NEntry_ = 0;
+  body_ = 0;
   dirty_ = 0;
+  dirty_subtree_ = 0;
   top_ = 0;
   indexed_ = 0;
   index_ = 0;
   nIndex_ = NIndex_ = 0;
+  entryHash_ = 0;
+  NEntryHash_ = 0;
+  childHash_ = 0;
+  NChildHash_ = nChildHash_ = 0;
 }
 
 void Fl_Preferences::Node::deleteAllChildren() {
@@ -1568,11 +1612,13 @@ void Fl_Preferences::Node::deleteAllChildren() {
     delete current_node;
   }
   first_child_ = NULL;
-  dirty_ = 1;
+  deleteChildHash();
+  setDirty();
   updateIndex();
 }
 
 void Fl_Preferences::Node::deleteAllEntries() {
+  body_ = NULL;
   if ( entry_ ) {
     for ( int i = 0; i < nEntry_; i++ ) {
       if ( entry_[i].name ) {
@@ -1589,7 +1635,8 @@ void Fl_Preferences::Node::deleteAllEntries() {
     nEntry_ = 0;
     NEntry_ = 0;
   }
-  dirty_ = 1;
+  deleteEntryHash();
+  setDirty();
 }
 
 // delete this and all depending nodes
@@ -1605,58 +1652,108 @@ Fl_Preferences::Node::~Node() {
   }
 }
 
-// recursively check if any entry is dirty (was changed after loading a fresh prefs file)
+// check if any entry in this node or below was changed after loading a fresh prefs file
 char Fl_Preferences::Node::dirty() {
-  if ( dirty_ ) return 1;
-  if ( next_ && next_->dirty() ) return 1;
-  if ( first_child_ && first_child_->dirty() ) return 1;
-  return 0;
+  return ( dirty_ || dirty_subtree_ );
 }
 
-// recursively clear all dirty flags
+// mark this node as changed, and all parent nodes as having a changed subtree
+void Fl_Preferences::Node::setDirty() {
+  dirty_ = 1;
+  for ( Node *nd = parent(); nd && !nd->dirty_subtree_; nd = nd->parent() )
+    nd->dirty_subtree_ = 1;
+}
+
+// recursively clear all dirty flags, skipping subtrees that were not changed
 void Fl_Preferences::Node::clearDirtyFlags() {
-  Fl_Preferences::Node *nd = this;
-  while (nd) {
-    nd->dirty_ = 0;
-    if ( nd->first_child_ ) nd->first_child_->clearDirtyFlags();
-    nd = nd->next_;
-  }
+  dirty_ = 0;
+  if ( !dirty_subtree_ ) return;
+  dirty_subtree_ = 0;
+  for ( Node *nd = first_child_; nd; nd = nd->next_ )
+    nd->clearDirtyFlags();
 }
 
-// write this node (recursively from the last neighbor back to this)
-// write all entries
-// write all children
+// write this node
+// write all entries, or the unchanged lines from the file if they were never read
+// write all children in the order they were created
 int Fl_Preferences::Node::write( FILE *f ) {
-  if ( next_ ) next_->write( f );
   fprintf( f, "\n[%s]\n\n", path_ );
-  for ( int i = 0; i < nEntry_; i++ ) {
-    char *src = entry_[i].value;
-    if ( src ) {                // hack it into smaller pieces if needed
-      fprintf( f, "%s:", entry_[i].name );
-      size_t cnt, written = 0;
-      for ( cnt = 0; cnt < 60; cnt++ )
-        if ( src[cnt]==0 ) break;
-      written += fwrite( src, cnt, 1, f );
-      fprintf( f, "\n" );
+  if ( body_ ) {
+    for ( const char *src = body_; *src; ) {
+      size_t cnt = strcspn( src, "\n\r" );
+      if ( cnt ) {
+        fwrite( src, cnt, 1, f );
+        fputc( '\n', f );
+      }
       src += cnt;
-      for (;*src;) {
-        for ( cnt = 0; cnt < 80; cnt++ )
+      if ( *src ) src++;
+    }
+  } else {
+    for ( int i = 0; i < nEntry_; i++ ) {
+      char *src = entry_[i].value;
+      if ( src ) {                // hack it into smaller pieces if needed
+        fprintf( f, "%s:", entry_[i].name );
+        size_t cnt, written = 0;
+        for ( cnt = 0; cnt < 60; cnt++ )
           if ( src[cnt]==0 ) break;
-        fputc( '+', f );
         written += fwrite( src, cnt, 1, f );
-        fputc( '\n', f );
+        fprintf( f, "\n" );
         src += cnt;
+        for (;*src;) {
+          for ( cnt = 0; cnt < 80; cnt++ )
+            if ( src[cnt]==0 ) break;
+          fputc( '+', f );
+          written += fwrite( src, cnt, 1, f );
+          fputc( '\n', f );
+          src += cnt;
+        }
+        (void)written; // silence warning
       }
-      (void)written; // silence warning
+      else
+        fprintf( f, "%s\n", entry_[i].name );
     }
-    else
-      fprintf( f, "%s\n", entry_[i].name );
   }
-  if ( first_child_ ) first_child_->write( f );
-  dirty_ = 0;
+  createIndex();
+  for ( int i = 0; i < nIndex_; i++ )
+    index_[i]->write( f );
   return 0;
 }
 
+// set the unparsed entries of this group as found in the file buffer
+// - the text is owned by the root node and is split into entries on first access
+void Fl_Preferences::Node::setBody( char *body ) {
+  if ( body_ ) parseBody();
+  body_ = body;
+  if ( nEntry_ ) parseBody();   // merge with the entries of an earlier group of the same name
+}
+
+// split the text from the file buffer into entries
+// - lines are split in place, so the caller may still use 'nameBuffer'
+void Fl_Preferences::Node::parseBody() {
+  char *s = body_;
+  body_ = NULL;
+  lastEntrySet = -1;
+  while ( s && *s ) {
+    char *e = strchr( s, '\n' );
+    char *next = e ? e+1 : NULL;
+    s[ strcspn( s, "\n\r" ) ] = 0;
+    if ( s[0]=='+' ) {                          // value of previous name/value pair spans multiple lines
+      if ( s[1] ) add( s+1 );
+    } else if ( s[0]==';' || s[0]=='#' ) {      // annotation
+      setEntry( s, 0 );
+    } else if ( s[0] ) {                        // read a name/value pair
+      char *c = strchr( s, ':' );
+      if ( c ) {
+        *c = 0;
+        setEntry( s, c+1 );
+      } else {
+        setEntry( s, "" );
+      }
+    }
+    s = next;
+  }
+}
+
 // set the parent node and create the full path
 void Fl_Preferences::Node::setParent( Node *pn ) {
   parent_ = pn;
@@ -1665,6 +1762,7 @@ void Fl_Preferences::Node::setParent( Node *pn ) {
   snprintf( nameBuffer, sizeof(nameBuffer), "%s/%s", pn->path_, path_ );
   free( path_ );
   path_ = fl_strdup( nameBuffer );
+  pn->addToChildHash( this );
 }
 
 // find the corresponding root node
@@ -1689,20 +1787,20 @@ Fl_Preferences::Node *Fl_Preferences::Node::addChild( const char *path ) {
 }
 
 // create and set, or change an entry within this node
-void Fl_Preferences::Node::set( const char *name, const char *value )
+// - returns 1 if the entry was created or its value changed
+char Fl_Preferences::Node::setEntry( const char *name, const char *value )
 {
-  for ( int i=0; i<nEntry_; i++ ) {
-    if ( strcmp( name, entry_[i].name ) == 0 ) {
-      if ( !value ) return; // annotation
-      if ( strcmp( value, entry_[i].value ) != 0 ) {
-        if ( entry_[i].value )
-          free( entry_[i].value );
-        entry_[i].value = fl_strdup( value );
-        dirty_ = 1;
-      }
-      lastEntrySet = i;
-      return;
+  int i = getEntry( name );
+  if ( i >= 0 ) {
+    if ( !value ) return 0; // annotation
+    lastEntrySet = i;
+    if ( !entry_[i].value || strcmp( value, entry_[i].value ) != 0 ) {
+      if ( entry_[i].value )
+        free( entry_[i].value );
+      entry_[i].value = fl_strdup( value );
+      return 1;
     }
+    return 0;
   }
   if ( NEntry_==nEntry_ ) {
     NEntry_ = NEntry_ ? NEntry_*2 : 10;
@@ -1712,16 +1810,22 @@ void Fl_Preferences::Node::set( const char *name, const char *value )
   entry_[ nEntry_ ].value = value?fl_strdup(value):0;
   lastEntrySet = nEntry_;
   nEntry_++;
-  dirty_ = 1;
+  addToEntryHash( nEntry_-1 );
+  return 1;
+}
+
+// create and set, or change an entry within this node
+void Fl_Preferences::Node::set( const char *name, const char *value )
+{
+  if ( setEntry( name, value ) )
+    setDirty();
 }
 
 // create or set a value (or annotation) from a single line in the file buffer
+// - this does not mark the node as changed
 void Fl_Preferences::Node::set( const char *line ) {
-  // hmm. If we assume that we always read this file in the beginning,
-  // we can handle the dirty flag 'quick and dirty'
-  char dirt = dirty_;
   if ( line[0]==';' || line[0]==0 || line[0]=='#' ) {
-    set( line, 0 );
+    setEntry( line, 0 );
   } else {
     const char *c = strchr( line, ':' );
     if ( c ) {
@@ -1729,12 +1833,11 @@ void Fl_Preferences::Node::set( const char *line ) {
       if ( len >= sizeof( nameBuffer ) )
         len = sizeof( nameBuffer );
       strlcpy( nameBuffer, line, len );
-      set( nameBuffer, c+1 );
+      setEntry( nameBuffer, c+1 );
     } else {
-      set( line, "" );
+      setEntry( line, "" );
     }
   }
-  dirty_ = dirt;
 }
 
 // Append data to an existing node. This is only used in read operations when
@@ -1742,6 +1845,7 @@ void Fl_Preferences::Node::set( const char *line ) {
 void Fl_Preferences::Node::add( const char *line ) {
   if ( lastEntrySet<0 || lastEntrySet>=nEntry_ ) return;
   char *&dst = entry_[ lastEntrySet ].value;
+  if ( !dst ) return;
   size_t a = strlen( dst );
   size_t b = strlen( line );
   dst = (char*)realloc( dst, a+b+1 );
@@ -1755,7 +1859,20 @@ const char *Fl_Preferences::Node::get( const char *name ) {
 }
 
 // find the index of an entry, returns -1 if no such entry
+// - groups with many entries use a hash table instead of comparing every name
 int Fl_Preferences::Node::getEntry( const char *name ) {
+  if ( body_ ) parseBody();
+  if ( !entryHash_ && nEntry_ >= 8 )
+    createEntryHash();
+  if ( entryHash_ ) {
+    unsigned int mask = NEntryHash_ - 1;
+    unsigned int h = hash_name( name, strlen( name ) ) & mask;
+    for ( int ix; ( ix = entryHash_[h] ) >= 0; h = ( h+1 ) & mask ) {
+      if ( strcmp( name, entry_[ix].name ) == 0 )
+        return ix;
+    }
+    return -1;
+  }
   for ( int i=0; i<nEntry_; i++ ) {
     if ( strcmp( name, entry_[i].name ) == 0 ) {
       return i;
@@ -1768,37 +1885,150 @@ int Fl_Preferences::Node::getEntry( const char *name ) {
 char Fl_Preferences::Node::deleteEntry( const char *name ) {
   int ix = getEntry( name );
   if ( ix == -1 ) return 0;
+  if ( entry_[ix].name ) ::free( entry_[ix].name );
+  if ( entry_[ix].value ) ::free( entry_[ix].value );
   memmove( entry_+ix, entry_+ix+1, (nEntry_-ix-1) * sizeof(Entry) );
   nEntry_--;
-  dirty_ = 1;
+  deleteEntryHash(); // indices have changed, the table is rebuilt when needed
+  setDirty();
   return 1;
 }
 
+// create a table of all entry indices, sized for at most 50% load
+void Fl_Preferences::Node::createEntryHash() {
+  int n = 16;
+  while ( n < nEntry_*2 ) n *= 2;
+  if ( n != NEntryHash_ ) {
+    if ( entryHash_ ) ::free( entryHash_ );
+    entryHash_ = (int*)malloc( n * sizeof(int) );
+    NEntryHash_ = n;
+  }
+  memset( entryHash_, 0xff, n * sizeof(int) );  // all slots -1
+  unsigned int mask = NEntryHash_ - 1;
+  for ( int i = 0; i < nEntry_; i++ ) {
+    unsigned int h = hash_name( entry_[i].name, strlen( entry_[i].name ) ) & mask;
+    while ( entryHash_[h] >= 0 ) h = ( h+1 ) & mask;
+    entryHash_[h] = i;
+  }
+}
+
+// add a new entry to the table, if there is one
+void Fl_Preferences::Node::addToEntryHash( int ix ) {
+  if ( !entryHash_ ) return;
+  if ( nEntry_*2 > NEntryHash_ ) {
+    createEntryHash();
+    return;
+  }
+  unsigned int mask = NEntryHash_ - 1;
+  unsigned int h = hash_name( entry_[ix].name, strlen( entry_[ix].name ) ) & mask;
+  while ( entryHash_[h] >= 0 ) h = ( h+1 ) & mask;
+  entryHash_[h] = ix;
+}
+
+void Fl_Preferences::Node::deleteEntryHash() {
+  if ( entryHash_ )
+    ::free( entryHash_ );
+  entryHash_ = NULL;
+  NEntryHash_ = 0;
+}
+
+// find a direct child by name
+// - groups with many children use a hash table instead of comparing every name
+Fl_Preferences::Node *Fl_Preferences::Node::findChild( const char *name, size_t len ) {
+  if ( childHash_ ) {
+    unsigned int mask = NChildHash_ - 1;
+    unsigned int h = hash_name( name, len ) & mask;
+    for ( Node *nd; ( nd = childHash_[h] ); h = ( h+1 ) & mask ) {
+      const char *n = nd->name();
+      if ( strncmp( name, n, len ) == 0 && n[len] == 0 )
+        return nd;
+    }
+    return 0;
+  }
+  int cnt = 0;
+  for ( Node *nd = first_child_; nd; nd = nd->next_, cnt++ ) {
+    const char *n = nd->name();
+    if ( strncmp( name, n, len ) == 0 && n[len] == 0 )
+      return nd;
+  }
+  if ( cnt >= 16 )
+    createChildHash();
+  return 0;
+}
+
+// create a table of all children, sized for at most 50% load
+void Fl_Preferences::Node::createChildHash() {
+  int cnt = 0;
+  for ( Node *nd = first_child_; nd; nd = nd->next_ )
+    cnt++;
+  int n = 32;
+  while ( n < cnt*2 ) n *= 2;
+  if ( n != NChildHash_ ) {
+    if ( childHash_ ) ::free( childHash_ );
+    childHash_ = (Node**)malloc( n * sizeof(Node*) );
+    NChildHash_ = n;
+  }
+  memset( childHash_, 0, n * sizeof(Node*) );
+  unsigned int mask = NChildHash_ - 1;
+  for ( Node *nd = first_child_; nd; nd = nd->next_ ) {
+    const char *name = nd->name();
+    unsigned int h = hash_name( name, strlen( name ) ) & mask;
+    while ( childHash_[h] ) h = ( h+1 ) & mask;
+    childHash_[h] = nd;
+  }
+  nChildHash_ = cnt;
+}
+
+// add a new child to the table, if there is one
+void Fl_Preferences::Node::addToChildHash( Node *nd ) {
+  if ( !childHash_ ) return;
+  nChildHash_++;
+  if ( nChildHash_*2 > NChildHash_ ) {
+    createChildHash();
+    return;
+  }
+  unsigned int mask = NChildHash_ - 1;
+  const char *name = nd->name();
+  unsigned int h = hash_name( name, strlen( name ) ) & mask;
+  while ( childHash_[h] ) h = ( h+1 ) & mask;
+  childHash_[h] = nd;
+}
+
+void Fl_Preferences::Node::deleteChildHash() {
+  if ( childHash_ )
+    ::free( childHash_ );
+  childHash_ = NULL;
+  NChildHash_ = nChildHash_ = 0;
+}
+
 // find a group somewhere in the tree starting here
 // - this method will always return a valid node (except for memory allocation problems)
 // - if the node was not found, 'find' will create the required branch
 Fl_Preferences::Node *Fl_Preferences::Node::find( const char *path ) {
-  int len = (int) strlen( path_ );
-  if ( strncmp( path, path_, len ) == 0 ) {
-    if ( path[ len ] == 0 )
-      return this;
-    if ( path[ len ] == '/' ) {
-      Node *nd;
-      for ( nd = first_child_; nd; nd = nd->next_ ) {
-        Node *nn = nd->find( path );
-        if ( nn ) return nn;
-      }
-      const char *s = path+len+1;
-      const char *e = strchr( s, '/' );
-      if (e) strlcpy( nameBuffer, s, e-s+1 );
-      else strlcpy( nameBuffer, s, sizeof(nameBuffer));
-      nd = new Node( nameBuffer );
-      nd->setParent( this );
-      dirty_ = 1;
-      return nd->find( path );
+  size_t len = strlen( path_ );
+  if ( strncmp( path, path_, len ) != 0 )
+    return 0;
+  if ( path[ len ] == 0 )
+    return this;
+  if ( path[ len ] != '/' )
+    return 0;
+  Node *nd = this;
+  const char *s = path+len+1;
+  for (;;) {
+    const char *e = strchr( s, '/' );
+    size_t n = e ? (size_t)(e-s) : strlen( s );
+    Node *nn = nd->findChild( s, n );
+    if ( !nn ) {
+      strlcpy( nameBuffer, s, n+1 < sizeof(nameBuffer) ? n+1 : sizeof(nameBuffer) );
+      nn = new Node( nameBuffer );
+      nn->setParent( nd );
+      nd->setDirty();
     }
+    nd = nn;
+    if ( !e )
+      return nd;
+    s = e+1;
   }
-  return 0;
 }
 
 // find a group somewhere in the tree starting here
@@ -1821,23 +2051,16 @@ Fl_Preferences::Node *Fl_Preferences::Node::search( const char *path, int offset
         return nn->search( path+2, 2 ); // do a relative search on the root node
       }
     }
-    offset = (int) strlen( path_ ) + 1;
-  }
-  int len = (int) strlen( path_ );
-  if ( len < offset-1 ) return 0;
-  len -= offset;
-  if ( ( len <= 0 ) || ( strncmp( path, path_+offset, len ) == 0 ) ) {
-    if ( len > 0 && path[ len ] == 0 )
-      return this;
-    if ( len <= 0 || path[ len ] == '/' ) {
-      for ( Node *nd = first_child_; nd; nd = nd->next_ ) {
-        Node *nn = nd->search( path, offset );
-        if ( nn ) return nn;
-      }
-      return 0;
-    }
   }
-  return 0;
+  Node *nd = this;
+  for (;;) {
+    const char *e = strchr( path, '/' );
+    size_t n = e ? (size_t)(e-path) : strlen( path );
+    nd = nd->findChild( path, n );
+    if ( !nd || !e )
+      return nd;
+    path = e+1;
+  }
 }
 
 // return the number of child nodes (groups)
@@ -1906,7 +2129,8 @@ char Fl_Preferences::Node::remove() {
         break;
       }
     }
-    parent_node->dirty_ = 1;
+    parent_node->deleteChildHash();
+    parent_node->setDirty();
     parent_node->updateIndex();
   }
   delete this;
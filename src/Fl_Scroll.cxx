@@ -169,10 +169,19 @@ void Fl_Scroll::draw_clip(void* v,int X, int Y, int W, int H) {
 
   // draw visible children
   Fl_Widget*const* a = s->array();
-  for (int i=s->children()-2; i--;) {
-    Fl_Widget& o = **a++;
-    s->draw_child(o);
-    s->draw_outside_label(o);
+  std::vector<int> list;
+  if (s->visible_children(list)) { // only those in the clip region
+    for (size_t i = 0; i < list.size() && list[i] < s->children() - 2; i++) {
+      Fl_Widget& o = *a[list[i]];
+      s->draw_child(o);
+      s->draw_outside_label(o);
+    }
+  } else {
+    for (int i=s->children()-2; i--;) {
+      Fl_Widget& o = **a++;
+      s->draw_child(o);
+      s->draw_outside_label(o);
+    }
   }
   fl_pop_clip();
 }
@@ -341,14 +350,13 @@ void Fl_Scroll::draw() {
 
   uchar d = damage();
 
-  // See: https://github.com/fltk/fltk/issues/1149#issuecomment-2511135611
-  float scale = Fl_Surface_Device::surface()->driver()->scale();
-  if ((d & FL_DAMAGE_ALL) || scale != int(scale)) { // full redraw
+  if (d & FL_DAMAGE_ALL) { // full redraw
     draw_box(box(),x(),y(),w(),h(),color());
     draw_clip(this, X, Y, W, H);
   } else {
     if (d & FL_DAMAGE_SCROLL) {
-      // scroll the contents:
+      // scroll the contents, fl_scroll() redraws them if the scale doesn't allow
+      // moving them by whole pixels (see issue #1149):
       fl_scroll(X, Y, W, H, oldx-xposition_, oldy-yposition_, draw_clip, this);
 
       // Erase the background as needed...
@@ -416,7 +424,7 @@ void Fl_Scroll::draw() {
   }
 
   // draw the scrollbars:
-  if ((d & FL_DAMAGE_ALL) || scale != int(scale)) {
+  if (d & FL_DAMAGE_ALL) {
     draw_child(scrollbar);
     draw_child(hscrollbar);
     if (scrollbar.visible() && hscrollbar.visible()) {
@@ -1,7 +1,7 @@
 //
 // Shared image code for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2025 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -37,6 +37,9 @@ int     Fl_Shared_Image::alloc_images_ = 0;     // Allocated shared images
 Fl_Shared_Handler *Fl_Shared_Image::handlers_ = 0;// Additional format handlers
 int     Fl_Shared_Image::num_handlers_ = 0;     // Number of format handlers
 int     Fl_Shared_Image::alloc_handlers_ = 0;   // Allocated format handlers
+int     Fl_Shared_Image::load_w_ = 0;           // Size requested while loading
+int     Fl_Shared_Image::load_h_ = 0;
+int     Fl_Shared_Image::load_reduced_ = 0;     // Loaded image has fewer pixels than the file
 
 
 //
@@ -556,6 +559,13 @@ Fl_Shared_Image* Fl_Shared_Image::find(const char *name, int W, int H) {
   copy with width \p W and height \p H is also added to the list of
   shared images.
 
+  JPEG images are an exception: if the image is smaller than half the size
+  of the file, the file is decoded at 1/2, 1/4 or 1/8 of its size (see
+  Fl_JPEG_Image::Fl_JPEG_Image(const char *filename, int W, int H)) before
+  it is resized, which is much faster for large photos. Only the resized
+  image is added to the list of shared images in this case, the original
+  image is loaded again if it is requested later.
+
   \note If the sizes differ, then \e two images are created as mentioned above.
         This is intentional so the original image is cached and preserved.
         If you request the same image with another size later, then the
@@ -591,12 +601,32 @@ Fl_Shared_Image* Fl_Shared_Image::get(const char *name, int W, int H) {
     temp_referenced = true;
   } else {
     // No original found, so we generate it by loading the file
+    if (W && H) {
+      load_w_ = W;
+      load_h_ = H;
+    }
+    load_reduced_ = 0;
     temp = new Fl_Shared_Image(name);
+    int reduced = load_reduced_;
+    load_w_ = load_h_ = load_reduced_ = 0;
     // We can't load the file or create the image, so return fail
     if (!temp->image_) {
       delete temp;
       return NULL;
     }
+    if (reduced) {
+      // The handler decoded fewer pixels than the file has, so this is not
+      // the original image. Keep only the copy with the requested size.
+      temp->original_ = 0;
+      if (temp->w() != W || temp->h() != H) {
+        Fl_Shared_Image *new_temp = temp->copy_(W, H);
+        delete temp;
+        if (!new_temp) return NULL;
+        temp = new_temp;
+      }
+      temp->add();
+      return temp;
+    }
     // Add the new image to the pool, refcount is already at 1
     temp->add();
   }
@@ -618,6 +648,23 @@ Fl_Shared_Image* Fl_Shared_Image::get(const char *name, int W, int H) {
   return temp;
 }
 
+/**
+  Returns the size requested from the image being loaded, for image handlers.
+
+  While Fl_Shared_Image::get(const char *name, int W, int H) loads an image
+  that isn't in the list of shared images yet, this returns the size \p W
+  and \p H the image is loaded for, otherwise 0 and 0. The handler for JPEG
+  images uses it to decode large images at a lower resolution.
+
+  \param[out] W, H requested size, or 0 if no size was requested
+  \see Fl_Shared_Handler
+  \version 1.5.0
+*/
+void Fl_Shared_Image::requested_size(int &W, int &H) {
+  W = load_w_;
+  H = load_h_;
+}
+
 /** Builds a shared image from a pre-existing Fl_RGB_Image.
 
  \param[in] rgb         an Fl_RGB_Image used to build a new shared image.
@@ -1,7 +1,7 @@
 //
 // A base class for platform specific system calls.
 //
-// Copyright 1998-2025 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -25,12 +25,15 @@
 #include "Fl_Timeout.h"
 #include <FL/Fl_File_Icon.H>
 #include <FL/fl_utf8.h>
+#include "utf8_internal.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
 #include "flstring.h"
 #include <time.h>
+#include <errno.h>
+#include <fcntl.h>             // for O_CREAT, O_EXCL
 
 
 int Fl_System_Driver::command_key = 0;
@@ -108,8 +111,14 @@ unsigned Fl_System_Driver::utf8towc(const char* src, unsigned srclen, wchar_t* d
       dst[count] = 0;
       return count;
     }
-    if (!(*p & 0x80)) { /* ascii */
-      dst[count] = *p++;
+    if (!(*p & 0x80)) { /* copy a run of ascii */
+      unsigned n = (unsigned)(fl_utf8_skip_ascii_(p, e) - p);
+      if (n > dstlen - count) n = dstlen - count;
+      for (unsigned i = 0; i < n; i++) dst[count + i] = (wchar_t)p[i];
+      p += n;
+      count += n;
+      if (count == dstlen) {dst[count-1] = 0; break;}
+      continue;
     } else {
       int len; unsigned ucs = fl_utf8decode(p,e,&len);
       p += len;
@@ -119,8 +128,12 @@ unsigned Fl_System_Driver::utf8towc(const char* src, unsigned srclen, wchar_t* d
   }
   /* we filled dst, measure the rest: */
   while (p < e) {
-    if (!(*p & 0x80)) p++;
-    else {
+    if (!(*p & 0x80)) {
+      const char *a = fl_utf8_skip_ascii_(p, e);
+      count += (unsigned)(a - p);
+      p = a;
+      continue;
+    } else {
       int len; fl_utf8decode(p,e,&len);
       p += len;
     }
@@ -328,6 +341,35 @@ FILE *Fl_System_Driver::fopen(const char* f, const char *mode) {
 void Fl_System_Driver::open_callback(void (*)(const char *)) {
 }
 
+FILE *Fl_System_Driver::open_replacement_file(const char *filename, std::string &target,
+                                              std::string &tmpname) {
+  static unsigned counter = 0;
+  target = filename;
+  for (int i = 0; i < 100; i++) {
+    char suffix[40];
+    snprintf(suffix, sizeof(suffix), ".%x%04x.tmp", (unsigned)time(NULL), (counter++ + rand()) & 0xffff);
+    tmpname = target + suffix;
+    // O_EXCL fails if the file exists, the umask applies to mode 0666
+    int fd = fl_open_ext(tmpname.c_str(), 1, O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+      if (errno == EEXIST) continue;
+      return NULL;
+    }
+    FILE *f = fdopen(fd, "wb");
+    if (!f) {
+      fl_close_fd(fd);
+      fl_unlink(tmpname.c_str());
+    }
+    return f;
+  }
+  return NULL;
+}
+
+int Fl_System_Driver::replace_file(const char *tmpname, const char *target) {
+  // the original file stays in place if this fails
+  return fl_rename(tmpname, target);
+}
+
 // Get elapsed time since Jan 1st, 1970.
 void Fl_System_Driver::gettime(time_t *sec, int *usec) {
   *sec =  time(NULL);
@@ -362,12 +404,14 @@ double Fl_System_Driver::wait(double time_to_wait) {
 
   // The idle function may turn off idle() if *all* idle callbacks
   // are removed from the callback queue (ring), we can then wait.
-  // Or it leaves Fl::idle() active and we set time_to_wait to 0.
-  if (Fl::idle()) {
+  // Or it leaves Fl::idle() active and we set time_to_wait to 0,
+  // unless idle callbacks used up their budget for this frame.
+  if (Fl::Private::idle_pending()) {
     time_to_wait = 0.0;
   } else {
-    // limit time by next timer interval
+    // limit time by next timer interval and next frame
     time_to_wait = Fl_Timeout::time_to_wait(time_to_wait);
+    time_to_wait = Fl::Private::frame_wait(time_to_wait);
   }
   return time_to_wait;
 }
@@ -3,7 +3,7 @@
 //
 // Copyright 2002 by Greg Ercolano.
 // Copyright (c) 2004 O'ksi'D
-// Copyright 2009-2025 by Bill Spitzak and others.
+// Copyright 2009-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -1291,6 +1291,7 @@ void Fl_Table::draw() {
   }
   // Clip all further drawing to the inner widget dimensions
   fl_push_clip(wix, wiy, wiw, wih);
+  fl_text_batch_begin();                        // send the text of all cells at once
   {
     // Only redraw a few cells?
     if ( ! ( damage() & FL_DAMAGE_ALL ) && _redraw_leftcol != -1 ) {
@@ -1386,6 +1387,7 @@ void Fl_Table::draw() {
       fl_rectf(vscrollbar->x(), hscrollbar->y(),
                vscrollbar->w(), hscrollbar->h(), color());
     }
+    fl_text_batch_end();
     draw_cell(CONTEXT_ENDPAGE, 0, 0,            // let user's drawing
               tix, tiy, tiw, tih);              // routines cleanup
 
@@ -19,6 +19,7 @@
 #include <FL/fl_utf8.h>
 #include <FL/fl_string_functions.h>
 #include "flstring.h"
+#include "utf8_internal.h"
 #include <ctype.h>
 #include <FL/Fl.H>
 #include <FL/Fl_Text_Buffer.H>
@@ -1974,6 +1975,14 @@ static int utf8_input_filter(char *buffer,              // result buffer we fill
       if (r == 0) return (int) (q - buffer);  // EOF? return bytes read into buffer[]
       p = line;
     }
+    if (!(*p & 0x80)) {                 // copy a run of ASCII characters unchanged
+      int n = (int) (fl_utf8_skip_ascii_(p, endline) - p);
+      if (n > buffer + buflen - q) n = (int) (buffer + buflen - q);
+      memcpy(q, p, n);
+      q += n;
+      p += n;
+      continue;
+    }
     // Predict length of utf8 sequence
     //    See if utf8 seq we're working on would extend off end of line buffer,
     //    and if so, adjust + load more data so that it doesn't.
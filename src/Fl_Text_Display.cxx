@@ -3986,7 +3986,8 @@ void Fl_Text_Display::draw(void) {
   update_child(*mVScrollBar);
   update_child(*mHScrollBar);
 
-  // draw all of the text
+  // draw all of the text, sent to the display at once
+  fl_text_batch_begin();
   if (damage() & (FL_DAMAGE_ALL | FL_DAMAGE_EXPOSE)) {
     //printf("drawing all text\n");
     int X = 0, Y = 0, W = 0, H = 0;
@@ -4014,6 +4015,7 @@ void Fl_Text_Display::draw(void) {
     damage_range2_start = damage_range2_end = -1;
     fl_pop_clip();
   }
+  fl_text_batch_end();
 
   // draw the text cursor
   int start, end;
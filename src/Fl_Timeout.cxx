@@ -2,7 +2,7 @@
 // Timeout support functions for the Fast Light Tool Kit (FLTK).
 //
 // Author: Albrecht Schlosser
-// Copyright 2021-2024 by Bill Spitzak and others.
+// Copyright 2021-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -19,6 +19,7 @@
 
 #include "Fl_Timeout.h"
 #include "Fl_System_Driver.H"
+#include "Fl_Trace.H"
 
 #include <stdio.h>
 #include <math.h> // for trunc()
@@ -535,6 +536,7 @@ void Fl_Timeout::do_timeouts() {
   }
 
   if (first_timeout) {
+    FL_TRACE_SCOPE("loop", "timeouts");
     Fl_Timeout::elapse_timeouts();
     while ((t = first_timeout)) {
       if (t->time > 0) break;
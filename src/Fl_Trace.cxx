@@ -0,0 +1,261 @@
+//
+// Tracing of the event loop for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/fl_utf8.h> // for fl_fopen()
+#include "Fl_Trace.H"
+
+#include <stdio.h>
+#include <string.h>
+
+#if FLTK_USE_TRACE
+
+#include <FL/Fl_Widget.H>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#if defined(__GNUC__)
+#  include <cxxabi.h>         // abi::__cxa_demangle()
+#  include <stdlib.h>         // free()
+#endif
+
+bool Fl_Trace_Scope::active_ = false;
+
+// One run of a traced scope, for the Chrome trace event file
+struct Trace_Event {
+  const char *category;
+  const char *name;
+  double start;       // seconds since tracing started
+  double duration;
+};
+
+typedef std::pair<const char *, const char *> Counter_Key; // category, name
+
+static std::map<Counter_Key, Fl::Trace::Counter> counters_;
+static std::vector<Fl::Trace::Counter> sorted_; // filled by Fl::Trace::counters()
+static std::vector<Trace_Event> events_;
+static size_t max_events_ = 0;
+static Fl_Timestamp trace_start_;
+static Fl_Trace_Scope *current_ = nullptr; // innermost running scope
+
+// Returns the readable class name of a widget. Names are demangled once per
+// class with abi::__cxa_demangle() (GCC, clang) and kept until the program
+// ends, because counters and events point to them. MSVC returns readable
+// names with a "class " prefix, which is removed.
+static const char *class_name(const Fl_Widget *widget) {
+  const char *name = typeid(*widget).name();
+#if defined(__GNUC__)
+  static std::map<const char *, std::string> names;
+  std::map<const char *, std::string>::iterator it = names.find(name);
+  if (it == names.end()) {
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    it = names.insert(std::make_pair(name, std::string(status == 0 && demangled ? demangled : name))).first;
+    free(demangled);
+  }
+  return it->second.c_str();
+#else
+  if (!strncmp(name, "class ", 6)) return name + 6;
+  return name;
+#endif
+}
+
+Fl_Trace_Scope::Fl_Trace_Scope(const char *category, const Fl_Widget *widget) : on_(active_) {
+  if (on_) begin(category, class_name(widget));
+}
+
+void Fl_Trace_Scope::begin(const char *category, const char *name) {
+  category_ = category;
+  name_ = name;
+  children_ = 0;
+  parent_ = current_;
+  current_ = this;
+  start_ = Fl::now();
+}
+
+void Fl_Trace_Scope::end() {
+  double duration = Fl::seconds_since(start_);
+  current_ = parent_;
+  if (parent_) parent_->children_ += duration;
+  if (!active_) return; // tracing was stopped within this scope
+  Fl::Trace::Counter &c = counters_[Counter_Key(category_, name_)];
+  if (!c.count) {
+    c.category = category_;
+    c.name = name_;
+  }
+  c.count++;
+  c.total += duration;
+  c.self += duration - children_;
+  if (duration > c.max) c.max = duration;
+  if (events_.size() < max_events_) {
+    Trace_Event e = { category_, name_, Fl::seconds_between(start_, trace_start_), duration };
+    events_.push_back(e);
+  }
+}
+
+// Writes a string as a JSON string literal
+static void write_json_string(FILE *f, const char *s) {
+  putc('"', f);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') putc('\\', f);
+    if ((unsigned char)*s < 0x20) fprintf(f, "\\u%04x", *s);
+    else putc(*s, f);
+  }
+  putc('"', f);
+}
+
+#endif // FLTK_USE_TRACE
+
+/**
+  Returns whether the library was built with tracing.
+  If not, all other functions of Fl::Trace do nothing.
+*/
+bool Fl::Trace::available() {
+  return FLTK_USE_TRACE;
+}
+
+/**
+  Starts tracing.
+
+  Counters go on from their current values, use Fl::Trace::reset() to
+  clear them. Single events are stored, up to \p max_events, for
+  Fl::Trace::write_json(); pass 0 to only update the counters.
+
+  \param[in] max_events maximum number of events stored
+*/
+void Fl::Trace::start(int max_events) {
+#if FLTK_USE_TRACE
+  if (!Fl_Trace_Scope::active_ && events_.empty())
+    trace_start_ = Fl::now();
+  max_events_ = (max_events > 0 ? size_t(max_events) : 0);
+  Fl_Trace_Scope::active_ = true;
+#else
+  (void)max_events;
+#endif
+}
+
+/** Stops tracing. Counters and events are kept. */
+void Fl::Trace::stop() {
+#if FLTK_USE_TRACE
+  Fl_Trace_Scope::active_ = false;
+#endif
+}
+
+/** Returns whether tracing is on. */
+bool Fl::Trace::active() {
+#if FLTK_USE_TRACE
+  return Fl_Trace_Scope::active_;
+#else
+  return false;
+#endif
+}
+
+/** Clears all counters and stored events. */
+void Fl::Trace::reset() {
+#if FLTK_USE_TRACE
+  counters_.clear();
+  sorted_.clear();
+  events_.clear();
+  trace_start_ = Fl::now();
+#endif
+}
+
+/**
+  Collects the counters of all traced scopes, those that took longest first.
+  Scopes are ordered by Counter::self, the time spent in them without
+  the time of nested scopes, e.g. a group's draw() without the draw()
+  methods of its children. Read them with Fl::Trace::counter().
+  \code
+  int n = Fl::Trace::counters();
+  for (int i = 0; i < n && i < 10; i++) {
+    const Fl::Trace::Counter *c = Fl::Trace::counter(i);
+    printf("%-6s %-30s %8lu %10.6f\n", c->category, c->name, c->count, c->self);
+  }
+  \endcode
+  \return number of counters
+*/
+int Fl::Trace::counters() {
+#if FLTK_USE_TRACE
+  sorted_.clear();
+  // the same name may come from string literals in different files
+  for (std::map<Counter_Key, Counter>::const_iterator it = counters_.begin(); it != counters_.end(); ++it) {
+    const Counter &c = it->second;
+    size_t i;
+    for (i = 0; i < sorted_.size(); i++) {
+      if (!strcmp(sorted_[i].category, c.category) && !strcmp(sorted_[i].name, c.name)) break;
+    }
+    if (i == sorted_.size()) { sorted_.push_back(c); continue; }
+    sorted_[i].count += c.count;
+    sorted_[i].total += c.total;
+    sorted_[i].self += c.self;
+    if (c.max > sorted_[i].max) sorted_[i].max = c.max;
+  }
+  std::sort(sorted_.begin(), sorted_.end(),
+            [](const Counter &a, const Counter &b) { return a.self > b.self; });
+  return (int)sorted_.size();
+#else
+  return 0;
+#endif
+}
+
+/**
+  Returns one of the counters collected by the last Fl::Trace::counters().
+  The counters are a snapshot: they don't change while tracing goes on
+  until counters() is called again. The returned pointer is valid until
+  the next call of counters() or Fl::Trace::reset().
+  \param[in] i index from 0 to counters() - 1
+  \return the counter, or NULL if \p i is out of range
+*/
+const Fl::Trace::Counter *Fl::Trace::counter(int i) {
+#if FLTK_USE_TRACE
+  if (i >= 0 && (size_t)i < sorted_.size()) return &sorted_[i];
+#else
+  (void)i;
+#endif
+  return nullptr;
+}
+
+/**
+  Writes the stored events to a file in the Chrome trace event format.
+  \param[in] filename name of the file, in UTF-8
+  \return 0 on success, -1 if the file could not be written or tracing
+    is not available
+*/
+int Fl::Trace::write_json(const char *filename) {
+#if FLTK_USE_TRACE
+  FILE *f = fl_fopen(filename, "w");
+  if (!f) return -1;
+  fputs("{\"traceEvents\":[\n", f);
+  for (size_t i = 0; i < events_.size(); i++) {
+    const Trace_Event &e = events_[i];
+    fputs("{\"name\":", f);
+    write_json_string(f, e.name);
+    fputs(",\"cat\":", f);
+    write_json_string(f, e.category);
+    fprintf(f, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}%s\n",
+            e.start * 1e6, e.duration * 1e6, i + 1 < events_.size() ? "," : "");
+  }
+  fputs("],\"displayTimeUnit\":\"ms\"}\n", f);
+  int err = ferror(f);
+  if (fclose(f) || err) return -1;
+  return 0;
+#else
+  (void)filename;
+  return -1;
+#endif
+}
@@ -1,7 +1,7 @@
 //
 // Base widget class for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2025 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -228,6 +228,7 @@ Fl_Widget::Fl_Widget(int X, int Y, int W, int H, const char* L) {
 
 void Fl_Widget::resize(int X, int Y, int W, int H) {
   x_ = X; y_ = Y; w_ = W; h_ = H;
+  if (parent_) parent_->invalidate_spatial_index();
 }
 
 // this is useful for parent widgets to call to resize children:
@@ -24,6 +24,7 @@ extern "C" {
 #include "Fl_Window_Driver.H"
 #include "Fl_Screen_Driver.H"
 #include "Fl_Timeout.h"
+#include "Fl_Private.H"
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Tooltip.H>
 #include <FL/Fl_Image_Surface.H>
@@ -819,11 +820,13 @@ double Fl_Darwin_System_Driver::wait(double time_to_wait)
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
   if (fl_mac_os_version < 101100) NSDisableScreenUpdates(); // deprecated 10.11
-  Fl::flush();
+  Fl::Private::flush_frame();
   if (fl_mac_os_version < 101100) NSEnableScreenUpdates(); // deprecated 10.11
 #pragma clang diagnostic pop
-  if (Fl::idle()) // 'idle' may have been set within flush()
+  if (Fl::Private::idle_pending()) // 'idle' may have been set within flush()
     time_to_wait = 0.0;
+  else
+    time_to_wait = Fl::Private::frame_wait(time_to_wait);
   int retval = do_queued_events(time_to_wait);
 
   Fl_Cocoa_Window_Driver::q_release_context();
@@ -57,6 +57,8 @@ void fl_cleanup_dc_list(void);
 #include "Fl_Window_Driver.H"
 #include "Fl_Screen_Driver.H"
 #include "Fl_Timeout.h"
+#include "Fl_Private.H"
+#include "Fl_Trace.H"
 #include "print_button.h"
 #include <FL/Fl_Graphics_Driver.H> // for fl_graphics_driver
 #include "drivers/WinAPI/Fl_WinAPI_Window_Driver.H"
@@ -354,6 +356,7 @@ MSG fl_msg;
 // A local helper function to flush any pending callback requests
 // from the awake ring-buffer
 static void process_awake_handler_requests(void) {
+  FL_TRACE_SCOPE("loop", "awake handlers");
   Fl_Awake_Handler func;
   void *data;
   while (Fl_WinAPI_System_Driver::pop_awake_handler(func, data) == 0) {
@@ -402,8 +405,10 @@ double Fl_WinAPI_System_Driver::wait(double time_to_wait) {
     }
   }
 
-  if (Fl::idle() || Fl::damage())
+  if (Fl::Private::idle_pending() || (Fl::damage() && Fl::frame_rate() <= 0))
     time_to_wait = 0.0;
+  else // with a frame rate, wait until the next frame is due
+    time_to_wait = Fl::Private::frame_wait(time_to_wait);
 
   // if there are no more windows and this timer is set
   // to FOREVER, continue through or look up indefinitely
@@ -466,7 +471,7 @@ double Fl_WinAPI_System_Driver::wait(double time_to_wait) {
     process_awake_handler_requests();
   }
 
-  Fl::flush();
+  Fl::Private::flush_frame();
 
   // This should return 0 if only timer events were handled:
   return 1;
@@ -30,6 +30,7 @@
 #  include <FL/Fl.H>
 #  include <FL/platform.H>
 #  include "Fl_Window_Driver.H"
+#  include "Fl_Private.H"
 #  include <FL/Fl_Window.H>
 #  include <FL/fl_utf8.h>
 #  include <FL/Fl_Tooltip.H>
@@ -106,15 +107,39 @@ extern int fl_send_system_handlers(void *e);
 static Fl_Window *send_motion;
 #endif
 
+// Merges the MotionNotify events queued right after xevent for the same
+// window and state into it, keeping the positions of all but the last one
+// for Fl::event_motion_history().
+static void coalesce_motion(XEvent &xevent) {
+  Fl_Window *win = fl_find(xevent.xmotion.window);
+  if (!win) return;
+  float s = 1;
+#if USE_XFT || FLTK_USE_CAIRO
+  s = Fl::screen_driver()->scale(Fl_Window_Driver::driver(win)->screen_num());
+#endif
+  XEvent next;
+  while (XEventsQueued(fl_display, QueuedAfterReading)) {
+    XPeekEvent(fl_display, &next);
+    if (next.type != MotionNotify || next.xmotion.window != xevent.xmotion.window ||
+        next.xmotion.state != xevent.xmotion.state)
+      break;
+    Fl::Private::add_motion_history(int(xevent.xmotion.x / s), int(xevent.xmotion.y / s));
+    Fl::Private::motion_coalesced_++;
+    XNextEvent(fl_display, &xevent);
+  }
+}
+
 static bool in_a_window; // true if in any of our windows, even destroyed ones
 static void do_queued_events() {
   in_a_window = true;
   while (XEventsQueued(fl_display,QueuedAfterReading)) {
     XEvent xevent;
     XNextEvent(fl_display, &xevent);
-    if (fl_send_system_handlers(&xevent))
-      continue;
-    fl_handle(xevent);
+    if (xevent.type == MotionNotify && Fl::Private::motion_compression_)
+      coalesce_motion(xevent);
+    if (!fl_send_system_handlers(&xevent))
+      fl_handle(xevent);
+    Fl::Private::clear_motion_history();
   }
   // we send FL_LEAVE only if the mouse did not enter some other window:
   if (!in_a_window) {
@@ -2166,6 +2191,7 @@ int fl_handle(const XEvent& thisevent)
     return 0;
 #endif // FLTK_CONSOLIDATE_MOTION
 
+    Fl::Private::motion_delivered_++;
     event = FL_MOVE;
     break;
 
@@ -383,7 +383,7 @@ void Fl_Cocoa_Gl_Window_Driver::apply_scissor() {
 /* Some old Apple hardware doesn't implement the GL_EXT_texture_rectangle extension.
  For it, draw_string_legacy_glut() is used to draw text. */
 
-char *Fl_Cocoa_Gl_Window_Driver::alpha_mask_for_string(const char *str, int n, int w, int h, Fl_Fontsize fs)
+char *Fl_Cocoa_Gl_Window_Driver::alpha_mask_for_string(const char *str, int n, int w, int h, Fl_Fontsize fs, int x)
 {
   // write str to a bitmap just big enough
   Fl_Image_Surface *surf = new Fl_Image_Surface(w, h);
@@ -391,7 +391,7 @@ char *Fl_Cocoa_Gl_Window_Driver::alpha_mask_for_string(const char *str, int n, i
   Fl_Surface_Device::push_current(surf);
   fl_color(FL_WHITE);
   fl_font(f, fs);
-  fl_draw(str, n, 0, fl_height() - fl_descent());
+  fl_draw(str, n, x, fl_height() - fl_descent());
   // get the alpha channel only of the bitmap
   char *alpha_buf = new char[w*h], *r = alpha_buf, *q;
   q = (char*)CGBitmapContextGetData((CGContextRef)surf->offscreen());
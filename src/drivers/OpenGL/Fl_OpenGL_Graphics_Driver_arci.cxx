@@ -39,6 +39,7 @@ void Fl_OpenGL_Graphics_Driver::arc(int x,int y,int w,int h,double a1,double a2)
   int nSeg = (int)(10 * sqrt(rMax))+1;
   double incr = (a2-a1)/(double)nSeg;
 
+  flush_batch();
   glBegin(GL_LINE_STRIP);
   for (int i=0; i<=nSeg; i++) {
     glVertex2d(cx+cos(a1)*rx, cy-sin(a1)*ry);
@@ -61,6 +62,7 @@ void Fl_OpenGL_Graphics_Driver::pie(int x,int y,int w,int h,double a1,double a2)
   int nSeg = (int)(10 * sqrt(rMax))+1;
   double incr = (a2-a1)/(double)nSeg;
 
+  flush_batch();
   glBegin(GL_TRIANGLE_FAN);
   glVertex2d(cx, cy);
   for (int i=0; i<=nSeg; i++) {
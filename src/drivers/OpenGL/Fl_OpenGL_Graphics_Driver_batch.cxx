@@ -0,0 +1,124 @@
+//
+// Primitive batching for the OpenGL graphics driver of the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+/**
+ \file Fl_OpenGL_Graphics_Driver_batch.cxx
+ \brief Collects points, lines and filled shapes to send them to OpenGL in few draw calls.
+ */
+
+#include "Fl_OpenGL_Graphics_Driver.H"
+#include <FL/gl.h>
+#include <string.h> // for memcpy()
+
+/* Between gl_shape_batch_begin() and gl_shape_batch_end(), points, lines and
+ filled shapes are not drawn immediately by the driver.
+ Their vertices are collected, together with the current color, in an array
+ that is sent to OpenGL with a single glDrawArrays() call when:
+   - the kind of primitive changes (points, lines, triangles),
+   - some other GL state they depend on changes (clipping, line style),
+   - something else is drawn (text, images, primitives drawn immediately),
+   - drawing with the FLTK API ends (gl_shape_batch_end(), Fl_Gl_Window::draw_end()),
+   - the array becomes large.
+ Changing the color doesn't interrupt a batch.
+ Otherwise, each primitive goes through the same array but is drawn as soon
+ as it is complete, so it keeps its place among direct GL calls of the program.
+ It is then sent with glBegin()/glEnd() like before batching existed: for
+ a handful of vertices, this costs less than setting up a vertex array.
+ */
+
+// number of vertices that triggers drawing the batch
+static const size_t batch_max = 65536;
+
+// Returns room for count vertices of the given primitive kind
+Fl_OpenGL_Graphics_Driver::batch_vertex *Fl_OpenGL_Graphics_Driver::batch_add(GLenum mode, int count) {
+  if (mode != batch_mode_ || batch_.size() + count > batch_max) {
+    flush_batch();
+    batch_mode_ = mode;
+  }
+  size_t first = batch_.size();
+  batch_.resize(first + count);
+  batch_vertex *v = &batch_[first];
+  // outside a batch, all vertices use the current GL color
+  if (batch_level_) for (int i = 0; i < count; i++) memcpy(v[i].rgba, rgba_, 4);
+  return v;
+}
+
+// Adds a filled rectangle as 2 triangles
+void Fl_OpenGL_Graphics_Driver::batch_rect(float x, float y, float r, float b) {
+  batch_vertex *v = batch_add(GL_TRIANGLES, 6);
+  v[0].x = x; v[0].y = y;
+  v[1].x = r; v[1].y = y;
+  v[2].x = r; v[2].y = b;
+  v[3].x = x; v[3].y = y;
+  v[4].x = r; v[4].y = b;
+  v[5].x = x; v[5].y = b;
+}
+
+// Adds a polyline, closed or not.
+// Dashed lines are drawn immediately so their pattern runs along the whole line.
+void Fl_OpenGL_Graphics_Driver::batch_lines(const XPOINT *p, int count, bool closed) {
+  if (count < 2) return;
+  if (line_stipple_ != FL_SOLID) {
+    flush_batch();
+    glBegin(closed ? GL_LINE_LOOP : GL_LINE_STRIP);
+    for (int i = 0; i < count; i++) glVertex2f(p[i].x, p[i].y);
+    glEnd();
+    return;
+  }
+  int segments = closed ? count : count - 1;
+  batch_vertex *v = batch_add(GL_LINES, 2 * segments);
+  for (int i = 0; i < segments; i++) {
+    const XPOINT &a = p[i], &b = p[(i + 1) % count];
+    v[0].x = a.x; v[0].y = a.y;
+    v[1].x = b.x; v[1].y = b.y;
+    v += 2;
+  }
+}
+
+// Adds a convex polygon as a fan of triangles
+void Fl_OpenGL_Graphics_Driver::batch_fan(const XPOINT *p, int count) {
+  if (count < 3) return;
+  batch_vertex *v = batch_add(GL_TRIANGLES, 3 * (count - 2));
+  for (int i = 1; i < count - 1; i++) {
+    v[0].x = p[0].x; v[0].y = p[0].y;
+    v[1].x = p[i].x; v[1].y = p[i].y;
+    v[2].x = p[i+1].x; v[2].y = p[i+1].y;
+    v += 3;
+  }
+}
+
+/**
+ Draws all collected primitives.
+ Must be called before changing GL state that affects them, or drawing with
+ GL directly. The driver does so itself when needed.
+ */
+void Fl_OpenGL_Graphics_Driver::flush_batch() {
+  if (batch_.empty()) return;
+  if (!batch_level_) { // a single primitive
+    glBegin(batch_mode_);
+    for (size_t i = 0; i < batch_.size(); i++) glVertex2f(batch_[i].x, batch_[i].y);
+    glEnd();
+    batch_.clear();
+    return;
+  }
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glInterleavedArrays(GL_C4UB_V2F, 0, &batch_[0]);
+  glDrawArrays(batch_mode_, 0, (GLsizei)batch_.size());
+  glPopClientAttrib();
+  // the current color is undefined after using a color array
+  glColor4ubv(rgba_);
+  batch_.clear();
+}
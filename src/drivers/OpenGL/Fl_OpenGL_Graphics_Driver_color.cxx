@@ -33,18 +33,21 @@
 extern unsigned fl_cmap[256]; // defined in fl_color.cxx
 
 void Fl_OpenGL_Graphics_Driver::color(Fl_Color i) {
+  unsigned rgba;
   if (i & 0xffffff00) {
-    unsigned rgba = ((unsigned)i)^0x000000ff;
+    rgba = ((unsigned)i)^0x000000ff;
     Fl_Graphics_Driver::color(i);
-    glColor4ub(rgba>>24, rgba>>16, rgba>>8, rgba);
   } else {
-    unsigned rgba = ((unsigned)fl_cmap[i])^0x000000ff;
+    rgba = ((unsigned)fl_cmap[i])^0x000000ff;
     Fl_Graphics_Driver::color(fl_cmap[i]);
-    glColor4ub(rgba>>24, rgba>>16, rgba>>8, rgba);
   }
+  // also memorized for the vertices of batched primitives
+  rgba_[0] = rgba>>24; rgba_[1] = rgba>>16; rgba_[2] = rgba>>8; rgba_[3] = rgba;
+  glColor4ubv(rgba_);
 }
 
 void Fl_OpenGL_Graphics_Driver::color(uchar r, uchar g, uchar b) {
   Fl_Graphics_Driver::color( fl_rgb_color(r, g, b) );
-  glColor3ub(r,g,b);
+  rgba_[0] = r; rgba_[1] = g; rgba_[2] = b; rgba_[3] = 0xff;
+  glColor4ubv(rgba_);
 }
@@ -188,6 +188,7 @@ void Fl_OpenGL_Graphics_Driver::draw(const char *str, int n, float x, float y) {
 void Fl_OpenGL_Graphics_Driver::draw(int angle, const char *str, int n, int x, int y) {}
 
 void Fl_OpenGL_Graphics_Driver::draw(const char* str, int n, int x, int y) {
+  flush_batch();
   Fl_Surface_Device::push_current(Fl_Display_Device::display_device());
   gl_draw(str, n, x, y);
   Fl_Surface_Device::pop_current();
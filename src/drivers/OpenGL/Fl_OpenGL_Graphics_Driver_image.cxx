@@ -168,6 +168,7 @@ void Fl_OpenGL_Graphics_Driver::draw_rgb(Fl_RGB_Image *img,
   if (start_image(img, XP, YP, WP, HP, cx, cy, X, Y, W, H)) {
     return;
   }
+  flush_batch();
   if (!image_texture_map_) image_texture_map_ = new std::map<Fl_Image*, GLuint>;
   auto iter = image_texture_map_->find(img);
   GLuint texNum;
@@ -193,6 +194,7 @@ void Fl_OpenGL_Graphics_Driver::draw_pixmap(Fl_Pixmap *pxm,
   if (start_image(pxm, XP, YP, WP, HP, cx, cy, X, Y, W, H)) {
     return;
   }
+  flush_batch();
   if (!image_texture_map_) image_texture_map_ = new std::map<Fl_Image*, GLuint>;
   auto iter = image_texture_map_->find(pxm);
   GLuint texNum;
@@ -238,6 +240,7 @@ void Fl_OpenGL_Graphics_Driver::draw_bitmap(Fl_Bitmap *bm,
   if (start_image(bm, XP, YP, WP, HP, cx, cy, X, Y, W, H)) {
     return;
   }
+  flush_batch();
   if (!image_texture_map_) image_texture_map_ = new std::map<Fl_Image*, GLuint>;
   GLuint texNum;
   auto iter = image_texture_map_->find(bm);
@@ -1,7 +1,7 @@
 //
 // Rectangle drawing routines for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2020 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -29,32 +29,36 @@
 #include <FL/math.h>
 
 // --- line and polygon drawing with integer coordinates
+// These are collected and drawn in batches between gl_shape_batch_begin() and
+// gl_shape_batch_end(), see Fl_OpenGL_Graphics_Driver_batch.cxx
 
 void Fl_OpenGL_Graphics_Driver::point(int x, int y) {
   if (line_width_ == 1.0f) {
-    glBegin(GL_POINTS);
-    glVertex2f(x+0.5f, y+0.5f);
-    glEnd();
+    batch_vertex *v = batch_add(GL_POINTS, 1);
+    v->x = x+0.5f; v->y = y+0.5f;
   } else {
     float offset = line_width_ / 2.0f;
     float xx = x+0.5f, yy = y+0.5f;
-    glRectf(xx-offset, yy-offset, xx+offset, yy+offset);
+    batch_rect(xx-offset, yy-offset, xx+offset, yy+offset);
   }
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::rect(int x, int y, int w, int h) {
   float offset = line_width_ / 2.0f;
   float xx = x+0.5f, yy = y+0.5f;
   float rr = x+w-0.5f, bb = y+h-0.5f;
-  glRectf(xx-offset, yy-offset, rr+offset, yy+offset);
-  glRectf(xx-offset, bb-offset, rr+offset, bb+offset);
-  glRectf(xx-offset, yy-offset, xx+offset, bb+offset);
-  glRectf(rr-offset, yy-offset, rr+offset, bb+offset);
+  batch_rect(xx-offset, yy-offset, rr+offset, yy+offset);
+  batch_rect(xx-offset, bb-offset, rr+offset, bb+offset);
+  batch_rect(xx-offset, yy-offset, xx+offset, bb+offset);
+  batch_rect(rr-offset, yy-offset, rr+offset, bb+offset);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::rectf(int x, int y, int w, int h) {
   if (w<=0 || h<=0) return;
-  glRectf((GLfloat)x, (GLfloat)y, (GLfloat)(x+w), (GLfloat)(y+h));
+  batch_rect((float)x, (float)y, (float)(x+w), (float)(y+h));
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::line(int x, int y, int x1, int y1) {
@@ -70,23 +74,18 @@ void Fl_OpenGL_Graphics_Driver::line(int x, int y, int x1, int y1) {
   float xx = x+0.5f, xx1 = x1+0.5f;
   float yy = y+0.5f, yy1 = y1+0.5f;
   if (line_width_==1.0f) {
-    glBegin(GL_LINE_STRIP);
-    glVertex2f(xx, yy);
-    glVertex2f(xx1, yy1);
-    glEnd();
+    batch_vertex *v = batch_add(GL_LINES, 2);
+    v[0].x = xx; v[0].y = yy;
+    v[1].x = xx1; v[1].y = yy1;
   } else {
     float dx = xx1-xx, dy = yy1-yy;
     float len = sqrtf(dx*dx+dy*dy);
     dx = dx/len*line_width_*0.5f;
     dy = dy/len*line_width_*0.5f;
-
-    glBegin(GL_TRIANGLE_STRIP);
-    glVertex2f(xx-dy, yy+dx);
-    glVertex2f(xx+dy, yy-dx);
-    glVertex2f(xx1-dy, yy1+dx);
-    glVertex2f(xx1+dy, yy1-dx);
-    glEnd();
+    XPOINT p[4] = { {xx-dy, yy+dx}, {xx+dy, yy-dx}, {xx1+dy, yy1-dx}, {xx1-dy, yy1+dx} };
+    batch_fan(p, 4);
   }
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::line(int x, int y, int x1, int y1, int x2, int y2) {
@@ -98,80 +97,79 @@ void Fl_OpenGL_Graphics_Driver::line(int x, int y, int x1, int y1, int x2, int y
 void Fl_OpenGL_Graphics_Driver::xyline(int x, int y, int x1) {
   float offset = line_width_ / 2.0f;
   float xx = (float)x, yy = y+0.5f, rr = x1+1.0f;
-  glRectf(xx, yy-offset, rr, yy+offset);
+  batch_rect(xx, yy-offset, rr, yy+offset);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::xyline(int x, int y, int x1, int y2) {
   float offset = line_width_ / 2.0f;
   float xx = (float)x, yy = y+0.5f, rr = x1+0.5f, bb = y2+1.0f;
-  glRectf(xx, yy-offset, rr+offset, yy+offset);
-  glRectf(rr-offset, yy+offset, rr+offset, bb);
+  batch_rect(xx, yy-offset, rr+offset, yy+offset);
+  batch_rect(rr-offset, yy+offset, rr+offset, bb);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::xyline(int x, int y, int x1, int y2, int x3) {
   float offset = line_width_ / 2.0f;
   float xx = (float)x, yy = y+0.5f, xx1 = x1+0.5f, rr = x3+1.0f, bb = y2+0.5f;
-  glRectf(xx, yy-offset, xx1+offset, yy+offset);
-  glRectf(xx1-offset, yy+offset, xx1+offset, bb+offset);
-  glRectf(xx1+offset, bb-offset, rr, bb+offset);
+  batch_rect(xx, yy-offset, xx1+offset, yy+offset);
+  batch_rect(xx1-offset, yy+offset, xx1+offset, bb+offset);
+  batch_rect(xx1+offset, bb-offset, rr, bb+offset);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::yxline(int x, int y, int y1) {
   float offset = line_width_ / 2.0f;
   float xx = x+0.5f, yy = (float)y, bb = y1+1.0f;
-  glRectf(xx-offset, yy, xx+offset, bb);
+  batch_rect(xx-offset, yy, xx+offset, bb);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::yxline(int x, int y, int y1, int x2) {
   float offset = line_width_ / 2.0f;
   float xx = x+0.5f, yy = (float)y, rr = x2+1.0f, bb = y1+0.5f;
-  glRectf(xx-offset, yy, xx+offset, bb+offset);
-  glRectf(xx+offset, bb-offset, rr, bb+offset);
+  batch_rect(xx-offset, yy, xx+offset, bb+offset);
+  batch_rect(xx+offset, bb-offset, rr, bb+offset);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::yxline(int x, int y, int y1, int x2, int y3) {
   float offset = line_width_ / 2.0f;
   float xx = x+0.5f, yy = (float)y, yy1 = y1+0.5f, rr = x2+0.5f, bb = y3+1.0f;
-  glRectf(xx-offset, yy, xx+offset, yy1+offset);
-  glRectf(xx+offset, yy1-offset, rr+offset, yy1+offset);
-  glRectf(rr-offset, yy1+offset, rr+offset, bb);
+  batch_rect(xx-offset, yy, xx+offset, yy1+offset);
+  batch_rect(xx+offset, yy1-offset, rr+offset, yy1+offset);
+  batch_rect(rr-offset, yy1+offset, rr+offset, bb);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::loop(int x0, int y0, int x1, int y1, int x2, int y2) {
-  glBegin(GL_LINE_LOOP);
-  glVertex2i(x0, y0);
-  glVertex2i(x1, y1);
-  glVertex2i(x2, y2);
-  glEnd();
+  XPOINT p[3] = { {(float)x0, (float)y0}, {(float)x1, (float)y1}, {(float)x2, (float)y2} };
+  batch_lines(p, 3, true);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::loop(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3) {
-  glBegin(GL_LINE_LOOP);
-  glVertex2i(x0, y0);
-  glVertex2i(x1, y1);
-  glVertex2i(x2, y2);
-  glVertex2i(x3, y3);
-  glEnd();
+  XPOINT p[4] = { {(float)x0, (float)y0}, {(float)x1, (float)y1},
+    {(float)x2, (float)y2}, {(float)x3, (float)y3} };
+  batch_lines(p, 4, true);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2) {
-  glBegin(GL_POLYGON);
-  glVertex2i(x0, y0);
-  glVertex2i(x1, y1);
-  glVertex2i(x2, y2);
-  glEnd();
+  XPOINT p[3] = { {(float)x0, (float)y0}, {(float)x1, (float)y1}, {(float)x2, (float)y2} };
+  batch_fan(p, 3);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3) {
-  glBegin(GL_POLYGON);
-  glVertex2i(x0, y0);
-  glVertex2i(x1, y1);
-  glVertex2i(x2, y2);
-  glVertex2i(x3, y3);
-  glEnd();
+  XPOINT p[4] = { {(float)x0, (float)y0}, {(float)x1, (float)y1},
+    {(float)x2, (float)y2}, {(float)x3, (float)y3} };
+  batch_fan(p, 4);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::focus_rect(int x, int y, int w, int h) {
+  flush_batch();
   float width = line_width_;
   int stipple = line_stipple_;
   line_style(FL_DOT, 1);
@@ -256,6 +254,7 @@ static Fl_Gl_Region gl_rstack[FL_REGION_STACK_SIZE];
  and apply the new clipping area.
  */
 void Fl_OpenGL_Graphics_Driver::push_clip(int x, int y, int w, int h) {
+  flush_batch();
   if (gl_rstackptr==gl_region_stack_max) {
     Fl::warning("Fl_OpenGL_Graphics_Driver::push_clip: clip stack overflow!\n");
     return;
@@ -273,6 +272,7 @@ void Fl_OpenGL_Graphics_Driver::push_clip(int x, int y, int w, int h) {
  Remove the current clipping area and apply the previous one on the stack.
  */
 void Fl_OpenGL_Graphics_Driver::pop_clip() {
+  flush_batch();
   if (gl_rstackptr==0) {
     glDisable(GL_SCISSOR_TEST);
     Fl::warning("Fl_OpenGL_Graphics_Driver::pop_clip: clip stack underflow!\n");
@@ -286,6 +286,7 @@ void Fl_OpenGL_Graphics_Driver::pop_clip() {
  Push a full area onton the stack, so no clipping will take place.
  */
 void Fl_OpenGL_Graphics_Driver::push_no_clip() {
+  flush_batch();
   if (gl_rstackptr==gl_region_stack_max) {
     Fl::warning("Fl_OpenGL_Graphics_Driver::push_no_clip: clip stack overflow!\n");
     return;
@@ -307,6 +308,7 @@ Fl_Region Fl_OpenGL_Graphics_Driver::clip_region() {
  we can.
  */
 void Fl_OpenGL_Graphics_Driver::clip_region(Fl_Region r) {
+  flush_batch();
   if (r==NULL) {
     glDisable(GL_SCISSOR_TEST);
   } else {
@@ -318,6 +320,7 @@ void Fl_OpenGL_Graphics_Driver::clip_region(Fl_Region r) {
  Apply the current clipping rect.
  */
 void Fl_OpenGL_Graphics_Driver::restore_clip() {
+  flush_batch();
   if (gl_rstackptr==0) {
     glDisable(GL_SCISSOR_TEST);
   } else {
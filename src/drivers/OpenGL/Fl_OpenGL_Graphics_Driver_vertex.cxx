@@ -1,7 +1,7 @@
 //
 // Portable drawing routines for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2016 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -57,50 +57,59 @@
 // double Fl_OpenGL_Graphics_Driver::transform_dx(double x, double y)
 // double Fl_OpenGL_Graphics_Driver::transform_dy(double x, double y)
 
+// Vertices of points, lines, loops and polygons are collected in xpoint
+// and added to the batch of primitives by the matching end_xxx() function.
+
 void Fl_OpenGL_Graphics_Driver::begin_points() {
   n = 0; gap_ = 0;
   what = POINTS;
-  glBegin(GL_POINTS);
 }
 
 void Fl_OpenGL_Graphics_Driver::end_points() {
-  glEnd();
+  batch_vertex *v = batch_add(GL_POINTS, n);
+  for (int i = 0; i < n; i++) {
+    v[i].x = xpoint[i].x; v[i].y = xpoint[i].y;
+  }
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::begin_line() {
   n = 0; gap_ = 0;
   what = LINE;
-  glBegin(GL_LINE_STRIP);
 }
 
 void Fl_OpenGL_Graphics_Driver::end_line() {
-  glEnd();
+  batch_lines(xpoint, n, false);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::begin_loop() {
   n = 0; gap_ = 0;
   what = LOOP;
-  glBegin(GL_LINE_LOOP);
 }
 
 void Fl_OpenGL_Graphics_Driver::end_loop() {
-  glEnd();
+  fixloop();
+  batch_lines(xpoint, n, true);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::begin_polygon() {
   n = 0; gap_ = 0;
   what = POLYGON;
-  glBegin(GL_POLYGON);
 }
 
 void Fl_OpenGL_Graphics_Driver::end_polygon() {
-  glEnd();
+  fixloop();
+  batch_fan(xpoint, n);
+  batch_done();
 }
 
 void Fl_OpenGL_Graphics_Driver::begin_complex_polygon() {
   n = 0;
   what = COMPLEX_POLYGON;
 #ifndef SLOW_COMPLEX_POLY
+  flush_batch();
   glBegin(GL_POLYGON);
 #endif
 }
@@ -209,7 +218,7 @@ void Fl_OpenGL_Graphics_Driver::end_complex_polygon()
           x0 = xMin;
         if (x1 > xMax)
           x1 = xMax;
-        glRectf((GLfloat)(x0-0.25f), (GLfloat)(y), (GLfloat)(x1+0.25f), (GLfloat)(y+1.0f));
+        batch_rect(x0-0.25f, (float)y, x1+0.25f, y+1.0f);
 //        glVertex2f((GLfloat)x0, (GLfloat)y);
 //        glVertex2f((GLfloat)x1, (GLfloat)y);
       }
@@ -218,6 +227,7 @@ void Fl_OpenGL_Graphics_Driver::end_complex_polygon()
   }
 
   ::free(nodeX);
+  batch_done();
 }
 
 #else
@@ -232,18 +242,18 @@ void Fl_OpenGL_Graphics_Driver::end_complex_polygon() {
 
 
 // remove equal points from closed path
-void Fl_OpenGL_Graphics_Driver::fixloop() { }
+void Fl_OpenGL_Graphics_Driver::fixloop() {
+  Fl_Graphics_Driver::fixloop();
+}
 
 void Fl_OpenGL_Graphics_Driver::transformed_vertex(double xf, double yf) {
-#ifdef SLOW_COMPLEX_POLY
+#ifndef SLOW_COMPLEX_POLY
   if (what==COMPLEX_POLYGON) {
-    Fl_Graphics_Driver::transformed_vertex(xf, yf);
-  } else {
     glVertex2d(xf, yf);
+    return;
   }
-#else
-  glVertex2d(xf, yf);
 #endif
+  Fl_Graphics_Driver::transformed_vertex(xf, yf);
 }
 
 void Fl_OpenGL_Graphics_Driver::circle(double cx, double cy, double r) {
@@ -260,7 +270,7 @@ void Fl_OpenGL_Graphics_Driver::circle(double cx, double cy, double r) {
   double x = r; //we start at angle = 0
   double y = 0;
 
-  glBegin(GL_LINE_LOOP);
+  // the vertices are drawn by the enclosing fl_end_xxx() call
   for(int ii = 0; ii < num_segments; ii++) {
     vertex(x + cx, y + cy); // output vertex
     double tx = -y;
@@ -270,6 +280,6 @@ void Fl_OpenGL_Graphics_Driver::circle(double cx, double cy, double r) {
     x *= radial_factor;
     y *= radial_factor;
   }
-  glEnd();
+  if (what==LINE) vertex(r + cx, cy); // close the circle
 
 }
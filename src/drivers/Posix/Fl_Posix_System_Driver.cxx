@@ -1,7 +1,7 @@
 //
 // Definition of Posix system driver (used by the X11, Wayland and macOS platforms).
 //
-// Copyright 1998-2023 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -17,6 +17,7 @@
 #include <config.h>
 #include "Fl_Posix_System_Driver.H"
 #include "../../flstring.h"
+#include "../../Fl_Trace.H"
 #include <FL/Fl_File_Icon.H>
 #include <FL/filename.H>
 #include <FL/fl_string_functions.h>
@@ -90,6 +91,20 @@ const char *Fl_Posix_System_Driver::getpwnam(const char *login) {
   return pwd ? pwd->pw_dir : NULL;
 }
 
+// The replacement is made next to the file a symbolic link points to, so that
+// rename() replaces that file rather than the link, and gets the file's mode.
+FILE *Fl_Posix_System_Driver::open_replacement_file(const char *filename, std::string &target,
+                                                    std::string &tmpname) {
+  char *resolved = realpath(filename, NULL); // NULL if the file doesn't exist yet
+  std::string path = resolved ? resolved : filename;
+  free(resolved);
+  // a new file gets mode 0666 masked by the umask
+  FILE *f = Fl_System_Driver::open_replacement_file(path.c_str(), target, tmpname);
+  struct stat st;
+  if (f && ::stat(target.c_str(), &st) == 0) fchmod(fileno(f), st.st_mode & 07777);
+  return f;
+}
+
 
 void Fl_Posix_System_Driver::gettime(time_t *sec, int *usec) {
   struct timeval tv;
@@ -402,6 +417,7 @@ static void thread_awake_cb(int fd, void*) {
     if (read(fd, &dummy, 1)==0) { /* This should never happen */ }
     pipe_mutex.unlock();
   }
+  FL_TRACE_SCOPE("loop", "awake handlers");
   Fl_Awake_Handler func;
   void *data;
   while (Fl_System_Driver::pop_awake_handler(func, data)==0) {
@@ -471,6 +487,50 @@ void Fl_Posix_System_Driver::lock_ring() {
   pthread_mutex_lock(ring_mutex);
 }
 
+// Function and argument of a thread started by start_thread()
+struct thread_start {
+  void (*func)(void *);
+  void *data;
+};
+
+static void *thread_main(void *arg) {
+  thread_start start = *(thread_start*)arg;
+  delete (thread_start*)arg;
+  start.func(start.data);
+  return NULL;
+}
+
+int Fl_Posix_System_Driver::start_thread(void (*func)(void *), void *data) {
+  thread_start *start = new thread_start;
+  start->func = func;
+  start->data = data;
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, thread_main, start)) {
+    delete start;
+    return -1;
+  }
+  pthread_detach(thread);
+  return 0;
+}
+
+void *Fl_Posix_System_Driver::start_joinable_thread(void (*func)(void *), void *data) {
+  thread_start *start = new thread_start;
+  start->func = func;
+  start->data = data;
+  pthread_t *thread = new pthread_t;
+  if (pthread_create(thread, NULL, thread_main, start)) {
+    delete start;
+    delete thread;
+    return NULL;
+  }
+  return thread;
+}
+
+void Fl_Posix_System_Driver::join_thread(void *thread) {
+  pthread_join(*(pthread_t*)thread, NULL);
+  delete (pthread_t*)thread;
+}
+
 #else // ! HAVE_PTHREAD
 
 void Fl_Posix_System_Driver::awake(void*) {}
@@ -1,7 +1,7 @@
 //
 // Classes Fl_PostScript_File_Device and Fl_PostScript_Graphics_Driver for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 2010-2024 by Bill Spitzak and others.
+// Copyright 2010-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -351,6 +351,7 @@ static const char * prolog =
 "/SRGB { setrgbcolor } bind def\n"
 
 "/A85RLE { /ASCII85Decode filter /RunLengthDecode filter } bind def\n" // ASCII85Decode followed by RunLengthDecode filters
+"/IDS { currentfile A85RLE } bind def\n" // image data source, changed by UFI for images defined earlier
 
 //  color images
 
@@ -380,7 +381,7 @@ static const char * prolog =
 "translate \n"
 "sx sy scale px py true \n"
 "[ px 0 0 py neg 0 py ]\n"
-"currentfile A85RLE\n"
+"IDS\n"
 "imagemask GR\n"
 "} bind def\n"
 
@@ -419,6 +420,18 @@ static const char * prolog =
 
 static const char * prolog_2 =  // prolog relevant only if lang_level >1
 
+// images drawn several times on a page
+// usage: /name size DFI <image data> def
+// reads size bytes of image data into an array of strings
+"/DFI { /fln exch def currentfile /ASCII85Decode filter dup /RunLengthDecode filter /fls exch def\n"
+"[ { fln 0 le { exit } if fls fln 65535 gt { 65535 } { fln } ifelse string readstring pop\n"
+"dup length dup 0 eq { pop pop exit } if fln exch sub /fln exch def } loop ]\n"
+"exch flushfile } bind def\n"
+// usage: save name UFI <image command> restore
+// makes the next image command read its data from an array of DFI
+"/UFI { /FLsa exch def /FLsi 0 def\n"
+"/IDS { { FLsa FLsi get /FLsi FLsi 1 add def } } def } bind def\n"
+
 // color image dictionaries
 "/CII {GS /inter exch def /py exch def /px exch def /sy exch def /sx exch def \n"
 "translate \n"
@@ -431,7 +444,7 @@ static const char * prolog_2 =  // prolog relevant only if lang_level >1
 "/Height py def\n"
 "/BitsPerComponent 8 def\n"
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource IDS def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 "/Decode [ 0 1 0 1 0 1 ] def\n"
@@ -451,7 +464,7 @@ static const char * prolog_2 =  // prolog relevant only if lang_level >1
 "/BitsPerComponent 8 def\n"
 
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource IDS def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 "/Decode [ 0 1 ] def\n"
@@ -596,7 +609,7 @@ static const char * prolog_3 = // prolog relevant only if lang_level >2
 "/Height py def\n"
 "/BitsPerComponent 8 def\n"
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource IDS def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 
@@ -637,7 +650,7 @@ static const char * prolog_3 = // prolog relevant only if lang_level >2
 "/Height py def\n"
 "/BitsPerComponent 8 def\n"
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource IDS def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 
@@ -778,6 +791,7 @@ void Fl_PostScript_Graphics_Driver::recover(){
 
 void Fl_PostScript_Graphics_Driver::reset(){
   gap_=1;
+  page_images_.clear(); // their definitions end with the page
   clip_=0;
   cr_=cg_=cb_=0;
   Fl_Graphics_Driver::font(FL_HELVETICA, 12);
@@ -1,7 +1,7 @@
 //
 // Postscript image drawing implementation for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2023 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -345,6 +345,84 @@ void Fl_PostScript_Graphics_Driver::close_rle85(void *data) // stop doing RLE+AS
 // End of implementation of the /RunLengthEncode + /ASCII85Encode PostScript filter
 //
 
+//
+// Images with the same data drawn several times on a page, e.g. the icons
+// of a table or browser, are defined once with DFI and then drawn with UFI.
+// The data of larger images, and with language level 1, are written inline.
+//
+
+static const size_t max_page_image_size = 256 * 1024; // in bytes of uncompressed data
+
+struct ps_image_data {
+  const char *command; // the PostScript command drawing the image
+  uchar *bytes;        // the data of an image that may be reused, or NULL
+  size_t count;
+  void *rle85;         // aux data for inline RLE+ASCII85 encoding
+};
+
+// FNV-1a hash of image data
+static unsigned long long hash_bytes(const uchar *p, size_t n) {
+  unsigned long long h = 14695981039346656037ULL;
+  for (size_t i = 0; i < n; i++) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// starts an image of size bytes of data, drawn by command
+void *Fl_PostScript_Graphics_Driver::begin_image(const char *command, size_t size)
+{
+  ps_image_data *img = new ps_image_data;
+  img->command = command;
+  img->count = 0;
+  if (lang_level_ > 1 && size <= max_page_image_size) {
+    img->bytes = new uchar[size];
+    img->rle85 = NULL;
+  } else {
+    img->bytes = NULL;
+    fprintf(output, "save\n%s", command);
+    img->rle85 = prepare_rle85();
+  }
+  return img;
+}
+
+void Fl_PostScript_Graphics_Driver::image_byte(uchar b, void *data) // sends one byte of image data
+{
+  ps_image_data *img = (ps_image_data *)data;
+  if (img->bytes) img->bytes[img->count++] = b;
+  else write_rle85(b, img->rle85);
+}
+
+// finishes an image, defining its data first if it's new on this page
+void Fl_PostScript_Graphics_Driver::end_image(void *data)
+{
+  ps_image_data *img = (ps_image_data *)data;
+  if (!img->bytes) {
+    close_rle85(img->rle85);
+    fprintf(output, "\nrestore\n");
+    delete img;
+    return;
+  }
+  std::pair<unsigned long long, size_t> key(hash_bytes(img->bytes, img->count), img->count);
+  std::map<std::pair<unsigned long long, size_t>, int>::iterator it = page_images_.find(key);
+  int n;
+  if (it != page_images_.end()) {
+    n = it->second;
+  } else {
+    n = (int)page_images_.size() + 1;
+    page_images_[key] = n;
+    fprintf(output, "/FLi%d %lu DFI\n", n, (unsigned long)img->count);
+    void *rle85 = prepare_rle85();
+    for (size_t i = 0; i < img->count; i++) write_rle85(img->bytes[i], rle85);
+    close_rle85(rle85);
+    fprintf(output, "\ndef\n");
+  }
+  fprintf(output, "save\nFLi%d UFI\n%srestore\n", n, img->command);
+  delete[] img->bytes;
+  delete img;
+}
+
 
 int Fl_PostScript_Graphics_Driver::alpha_mask(const uchar * data, int w, int h, int D, int LD){
 
@@ -505,32 +583,33 @@ void Fl_PostScript_Graphics_Driver::draw_image(Fl_Draw_Image_Cb call, void *data
   double x = ix, y = iy, w = iw, h = ih;
 
   int level2_mask = 0;
-  fprintf(output,"save\n");
+  char command[200];
   int i,j,k;
   const char * interpol;
   if (lang_level_ > 1) {
     if (interpolate_) interpol="true";
     else interpol="false";
     if (mask && lang_level_ > 2) {
-      fprintf(output, "%g %g %g %g %i %i %i %i %s CIM\n", x , y+h , w , -h , iw , ih, mx, my, interpol);
+      snprintf(command, sizeof(command), "%g %g %g %g %i %i %i %i %s CIM\n", x , y+h , w , -h , iw , ih, mx, my, interpol);
     }
     else if (mask && lang_level_ == 2) {
       level2_mask = 1; // use method for drawing masked color image with PostScript level 2
-      fprintf(output, " %g %g %g %g %d %d pixmap_plot\n", x, y, w, h, iw, ih);
+      snprintf(command, sizeof(command), " %g %g %g %g %d %d pixmap_plot\n", x, y, w, h, iw, ih);
     }
     else {
-      fprintf(output, "%g %g %g %g %i %i %s CII\n", x , y+h , w , -h , iw , ih, interpol);
+      snprintf(command, sizeof(command), "%g %g %g %g %i %i %s CII\n", x , y+h , w , -h , iw , ih, interpol);
     }
   } else {
-    fprintf(output , "%g %g %g %g %i %i CI", x , y+h , w , -h , iw , ih);
+    snprintf(command, sizeof(command), "%g %g %g %g %i %i CI", x , y+h , w , -h , iw , ih);
   }
 
   int LD=iw*abs(D);
   uchar *rgbdata=new uchar[LD];
   uchar *curmask=mask;
-  void *big = prepare_rle85();
 
-  if (level2_mask) {
+  if (level2_mask) { // two data streams, always written inline
+    fprintf(output, "save\n%s", command);
+    void *big = prepare_rle85();
     for (j = ih - 1; j >= 0; j--) { // output full image data
       call(data, 0, j, iw, rgbdata);
       uchar *curdata = rgbdata;
@@ -550,13 +629,18 @@ void Fl_PostScript_Graphics_Driver::draw_image(Fl_Draw_Image_Cb call, void *data
         }
       }
     }
+    close_rle85(big);
+    fprintf(output,"\nrestore\n");
   }
   else {
+    size_t size = (size_t)iw * ih * 3;
+    if (mask && lang_level_ > 2) size += (size_t)ih * (my/ih) * ((mx+7)/8);
+    void *img = begin_image(command, size);
     for (j=0; j<ih;j++) {
       if (mask && lang_level_ > 2) {  // InterleaveType 2 mask data
         for (k=0; k<my/ih;k++) { //for alpha pseudo-masking
           for (i=0; i<((mx+7)/8);i++) {
-            write_rle85(swap_byte(*curmask), big);
+            image_byte(swap_byte(*curmask), img);
             curmask++;
           }
         }
@@ -576,21 +660,20 @@ void Fl_PostScript_Graphics_Driver::draw_image(Fl_Draw_Image_Cb call, void *data
           b = (a2 * b + bg_b * a)/255;
         }
 
-        write_rle85(r, big); write_rle85(g, big); write_rle85(b, big);
+        image_byte(r, img); image_byte(g, img); image_byte(b, img);
         curdata +=D;
       }
 
     }
+    end_image(img);
   }
-  close_rle85(big);
-  fprintf(output,"\nrestore\n");
   delete[] rgbdata;
 }
 
 void Fl_PostScript_Graphics_Driver::draw_image_mono(const uchar *data, int ix, int iy, int iw, int ih, int D, int LD) {
   double x = ix, y = iy, w = iw, h = ih;
 
-  fprintf(output,"save\n");
+  char command[200];
 
   int i,j, k;
 
@@ -601,11 +684,11 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(const uchar *data, int ix, i
     else
       interpol="false";
     if (mask && lang_level_>2)
-      fprintf(output, "%g %g %g %g %i %i %i %i %s GIM\n", x , y+h , w , -h , iw , ih, mx, my, interpol);
+      snprintf(command, sizeof(command), "%g %g %g %g %i %i %i %i %s GIM\n", x , y+h , w , -h , iw , ih, mx, my, interpol);
     else
-      fprintf(output, "%g %g %g %g %i %i %s GII\n", x , y+h , w , -h , iw , ih, interpol);
+      snprintf(command, sizeof(command), "%g %g %g %g %i %i %s GII\n", x , y+h , w , -h , iw , ih, interpol);
   }else
-    fprintf(output , "%g %g %g %g %i %i GI", x , y+h , w , -h , iw , ih);
+    snprintf(command, sizeof(command), "%g %g %g %g %i %i GI", x , y+h , w , -h , iw , ih);
 
 
   if (!LD) LD = iw*abs(D);
@@ -614,12 +697,14 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(const uchar *data, int ix, i
   int bg = (bg_r + bg_g + bg_b)/3;
 
   uchar *curmask=mask;
-  void *big = prepare_rle85();
+  size_t size = (size_t)iw * ih;
+  if (mask) size += (size_t)ih * (my/ih) * ((mx+7)/8);
+  void *img = begin_image(command, size);
   for (j=0; j<ih;j++){
     if (mask){
       for (k=0;k<my/ih;k++){
         for (i=0; i<((mx+7)/8);i++){
-          write_rle85(swap_byte(*curmask), big);
+          image_byte(swap_byte(*curmask), img);
           curmask++;
         }
       }
@@ -633,13 +718,12 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(const uchar *data, int ix, i
         unsigned int a = 255-a2;
         r = (a2 * r + bg * a)/255;
       }
-      write_rle85(r, big);
+      image_byte(r, img);
       curdata +=D;
     }
 
   }
-  close_rle85(big);
-  fprintf(output,"restore\n");
+  end_image(img);
 }
 
 
@@ -647,29 +731,31 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(const uchar *data, int ix, i
 void Fl_PostScript_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb call, void *data, int ix, int iy, int iw, int ih, int D) {
   double x = ix, y = iy, w = iw, h = ih;
 
-  fprintf(output,"save\n");
+  char command[200];
   int i,j,k;
   const char * interpol;
   if (lang_level_>1){
     if (interpolate_) interpol="true";
     else interpol="false";
     if (mask && lang_level_>2)
-      fprintf(output, "%g %g %g %g %i %i %i %i %s GIM\n", x , y+h , w , -h , iw , ih, mx, my, interpol);
+      snprintf(command, sizeof(command), "%g %g %g %g %i %i %i %i %s GIM\n", x , y+h , w , -h , iw , ih, mx, my, interpol);
     else
-      fprintf(output, "%g %g %g %g %i %i %s GII\n", x , y+h , w , -h , iw , ih, interpol);
+      snprintf(command, sizeof(command), "%g %g %g %g %i %i %s GII\n", x , y+h , w , -h , iw , ih, interpol);
   } else
-    fprintf(output , "%g %g %g %g %i %i GI", x , y+h , w , -h , iw , ih);
+    snprintf(command, sizeof(command), "%g %g %g %g %i %i GI", x , y+h , w , -h , iw , ih);
 
   int LD=iw*D;
   uchar *rgbdata=new uchar[LD];
   uchar *curmask=mask;
-  void *big = prepare_rle85();
+  size_t size = (size_t)iw * ih;
+  if (mask && lang_level_>2) size += (size_t)ih * (my/ih) * ((mx+7)/8);
+  void *img = begin_image(command, size);
   for (j=0; j<ih;j++){
 
     if (mask && lang_level_>2){  // InterleaveType 2 mask data
       for (k=0; k<my/ih;k++){ //for alpha pseudo-masking
         for (i=0; i<((mx+7)/8);i++){
-          write_rle85(swap_byte(*curmask), big);
+          image_byte(swap_byte(*curmask), img);
           curmask++;
         }
       }
@@ -677,12 +763,11 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb call, void
     call(data,0,j,iw,rgbdata);
     uchar *curdata=rgbdata;
     for (i=0 ; i<iw ; i++) {
-      write_rle85(curdata[0], big);
+      image_byte(curdata[0], img);
       curdata +=D;
     }
   }
-  close_rle85(big);
-  fprintf(output,"restore\n");
+  end_image(img);
   delete[] rgbdata;
 }
 
@@ -725,15 +810,16 @@ void Fl_PostScript_Graphics_Driver::draw_bitmap(Fl_Bitmap * bitmap,int XP, int Y
   WP = bitmap->data_w(), HP = bitmap->data_h();
   const uchar * di = bitmap->array;
   int i, j, xx = (WP+7)/8;
-  fprintf(output , "%i %i %i %i %i %i MI\n", 0, HP, WP, -HP, WP, HP);
-  void *rle85 = prepare_rle85();
+  char command[100];
+  snprintf(command, sizeof(command), "%i %i %i %i %i %i MI\n", 0, HP, WP, -HP, WP, HP);
+  void *img = begin_image(command, (size_t)HP * xx);
   for (j=0; j<HP; j++){
     for (i=0; i<xx; i++){
-      write_rle85(swap_byte(*di), rle85);
+      image_byte(swap_byte(*di), img);
       di++;
     }
   }
-  close_rle85(rle85); fputc('\n', output);
+  end_image(img);
   clocale_printf("GR GR\n");
   pop_clip(); // matches push_no_clip in scale_for_image_
 }
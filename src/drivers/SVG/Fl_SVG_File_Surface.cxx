@@ -1,7 +1,7 @@
 //
 // Implementation of classes Fl_SVG_Graphics_Driver and Fl_SVG_File_Surface in the Fast Light Tool Kit (FLTK).
 //
-// Copyright 2020-2022 by Bill Spitzak and others.
+// Copyright 2020-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -32,6 +32,8 @@
 #include <FL/fl_string_functions.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <map>
+#include <tuple>
 
 extern "C" {
 #if defined(HAVE_LIBPNG)
@@ -47,6 +49,16 @@ extern "C" {
 #endif // HAVE_LIBJPEG
 }
 
+// Key of the dictionary of images defined in an SVG document
+struct Fl_SVG_Image_Key {
+  unsigned long long hash; // of the pixel data, and of the color of bitmaps
+  int data_w, data_h, d;   // d is 0 for bitmaps
+  int w, h;                // drawing size
+  bool operator<(const Fl_SVG_Image_Key &k) const {
+    return std::tie(hash, data_w, data_h, d, w, h) < std::tie(k.hash, k.data_w, k.data_h, k.d, k.w, k.h);
+  }
+};
+
 class Fl_SVG_Graphics_Driver : public Fl_Graphics_Driver {
   FILE *out_;
   int width_;
@@ -64,7 +76,8 @@ class Fl_SVG_Graphics_Driver : public Fl_Graphics_Driver {
   };
   Clip * clip_; // top of pile of clips
   int clip_count_; // to generate distinct SVG clip Ids
-  char *last_rgb_name_; // NULL or SVG Id of last defined RGB image
+  std::map<Fl_SVG_Image_Key, int> images_; // number of each image defined in <defs>
+  std::map<Fl_SVG_Image_Key, int> pixmaps_; // image numbers of pixmaps, by hash of their XPM data
   const char *family_;
   const char *bold_;
   const char *style_;
@@ -96,8 +109,10 @@ protected:
   int height() FL_OVERRIDE;
   int descent() FL_OVERRIDE;
   void draw_rgb(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy) FL_OVERRIDE;
-  void define_rgb_png(Fl_RGB_Image *rgb, const char *name, int x, int y);
-  void define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name, int x, int y);
+  int find_image(const uchar *data, int row_bytes, int ld, unsigned seed, Fl_Image *img, int d, bool &found);
+  void use_image(int n, Fl_Image *img, int XP, int YP, int WP, int HP, int cx, int cy);
+  void define_rgb_png(Fl_RGB_Image *rgb, int n);
+  void define_rgb_jpeg(Fl_RGB_Image *rgb, int n);
   void draw_pixmap(Fl_Pixmap *pxm,int XP, int YP, int WP, int HP, int cx, int cy) FL_OVERRIDE;
   void draw_bitmap(Fl_Bitmap *bm,int XP, int YP, int WP, int HP, int cx, int cy) FL_OVERRIDE;
   void draw_image(const uchar* buf, int x, int y, int w, int h, int d, int l) FL_OVERRIDE;
@@ -140,7 +155,6 @@ Fl_SVG_Graphics_Driver::Fl_SVG_Graphics_Driver(FILE *f) {
   user_dash_array_ = 0;
   dasharray_ = fl_strdup("none");
   p_size = 0;
-  last_rgb_name_ = NULL;
 }
 
 Fl_SVG_Graphics_Driver::~Fl_SVG_Graphics_Driver()
@@ -152,7 +166,6 @@ Fl_SVG_Graphics_Driver::~Fl_SVG_Graphics_Driver()
     clip_= clip_->prev;
     delete c;
   }
-  if (last_rgb_name_) free(last_rgb_name_);
 }
 
 
@@ -466,7 +479,8 @@ static void user_flush_data(png_structp png_ptr) {
   if (svg_base64_data->lbuf) to_base64(svg_base64_data->buff, svg_base64_data->lbuf, svg_base64_data);
 }
 
-/* How to define first the image data and next use it, possibly several times:
+/* How to define first the image data and next use it, possibly several times.
+ All images are drawn this way, the same pixels are defined once per document:
 <defs><image id="myimage"  width="64" height="64" href="data:image/png;base64,
 iVBORw0KGgoAAAANSUhEUgAAAEAAAABACAYAAACqaXHeAAAAnElEQVR4nO3UsQ3EIADAwEQgsf+S7ECB
 /sdwkfMEru7de/+eDzfvvfVD2hxj1A9pc61VP6TNc079kMYABjCAAfVDGgMYwAAG1A9pDGAAAxhQP6Qx
@@ -476,15 +490,8 @@ AxhQP6QxgAEM+LYBf9sdYcTRmp6pAAAAAElFTkSuQmCCAAAAAElFTkSuQmCC"/>
 <use href="#myimage" x="xxx" y="yyy"/>
 <use href="#myimage" x="xxx2" y="yyy2"/>
 */
-/* Specify image data and draw it in one go:
- <image x="xxx" y="yyy"  width="64" height="64" href="data:image/png;base64,
- iVBORw0KGgoAAAANSUhEUgAAAEAAAABACAYAAACqaXHeAAAAnElEQVR4nO3UsQ3EIADAwEQgsf+S7ECB
- /sdwkfMEru7de/+eDzfvvfVD2hxj1A9pc61VP6TNc079kMYABjCAAfVDGgMYwAAG1A9pDGAAAxhQP6Qx
- gAEMYED9kMYABjCAAfVDGgMYwAAG1A9pDGAAAxhQP6QxgAEMYED9kMYABjCAAfVDGgMYwAAG1A9pDGAA
- AxhQP6QxgAEM+LYBf9sdYcTRmp6pAAAAAElFTkSuQmCCAAAAAElFTkSuQmCC"/>
- */
-
-void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, const char *name, int x, int y) {
+
+void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, int n) {
   png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
   if (!png_ptr) return;
   png_infop info_ptr = png_create_info_struct(png_ptr);
@@ -492,13 +499,8 @@ void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, const char *name,
     png_destroy_write_struct(&png_ptr, (png_infopp)NULL);
     return;
   }
-  if (name) {
-    if (last_rgb_name_) free(last_rgb_name_);
-    last_rgb_name_ = fl_strdup(name);
-  }
   float f = rgb->data_w() > rgb->data_h() ? float(rgb->w()) / rgb->data_w(): float(rgb->h()) / rgb->data_h();
-  if (name) fprintf(out_, "<defs><image id=\"%s\" ", name);
-  else fprintf(out_, "<image x=\"%d\" y=\"%d\" ", x, y);
+  fprintf(out_, "<defs><image id=\"FLimg%d\" ", n);
   clocale_printf("width=\"%f\" height=\"%f\" href=\"data:image/png;base64,\n", f*rgb->data_w(), f*rgb->data_h());
   // Transforms the image into a stream of bytes in PNG format,
   // base64-encode this byte stream, and outputs the result to the svg FILE.
@@ -533,8 +535,7 @@ void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, const char *name,
   user_flush_data(png_ptr);
   png_destroy_write_struct(&png_ptr, &info_ptr);
   delete[] row_pointers;
-  if (name) fputs("\"/></defs>\n", out_);
-  else fputs("\"/>\n", out_);
+  fputs("\"/></defs>\n", out_);
 }
 
 #endif // HAVE_LIBPNG
@@ -580,14 +581,9 @@ static void term_destination(jpeg_compress_struct *cinfo) {
   }
 }
 
-void Fl_SVG_Graphics_Driver::define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name, int x, int y) {
-  if (name) {
-    if (last_rgb_name_) free(last_rgb_name_);
-    last_rgb_name_ = fl_strdup(name);
-  }
+void Fl_SVG_Graphics_Driver::define_rgb_jpeg(Fl_RGB_Image *rgb, int n) {
   float f = rgb->data_w() > rgb->data_h() ? float(rgb->w()) / rgb->data_w(): float(rgb->h()) / rgb->data_h();
-  if (name) fprintf(out_, "<defs><image id=\"%s\" ", name);
-  else fprintf(out_, "<image x=\"%d\" y=\"%d\" ", x, y);
+  fprintf(out_, "<defs><image id=\"FLimg%d\" ", n);
   clocale_printf("width=\"%f\" height=\"%f\" href=\"data:image/jpeg;base64,\n", f*rgb->data_w(), f*rgb->data_h());
   // Transforms the image into a stream of bytes in JPEG format,
   // base64-encode this byte stream, and outputs the result to the svg FILE.
@@ -620,69 +616,124 @@ void Fl_SVG_Graphics_Driver::define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name
   }
   jpeg_finish_compress(&cinfo);
   jpeg_destroy_compress(&cinfo);
-  if (name) fputs("\"/></defs>\n", out_);
-  else fputs("\"/>\n", out_);
+  fputs("\"/></defs>\n", out_);
 }
 #endif // HAVE_LIBJPEG
 
+// FNV-1a hash of the rows of an image
+static unsigned long long hash_rows(const uchar *p, int row_bytes, int rows, int ld, unsigned long long h) {
+  for (int j = 0; j < rows; j++, p += ld) {
+    for (int i = 0; i < row_bytes; i++) {
+      h ^= p[i];
+      h *= 1099511628211ULL;
+    }
+  }
+  return h;
+}
+
+// Returns the number of the definition of an image with these pixels and drawing size.
+// If the document has none yet, found is set to false and the caller must define it.
+int Fl_SVG_Graphics_Driver::find_image(const uchar *data, int row_bytes, int ld, unsigned seed,
+                                       Fl_Image *img, int d, bool &found) {
+  Fl_SVG_Image_Key key;
+  key.hash = hash_rows(data, row_bytes, img->data_h(), ld, 14695981039346656037ULL ^ seed);
+  key.data_w = img->data_w();
+  key.data_h = img->data_h();
+  key.d = d;
+  key.w = img->w();
+  key.h = img->h();
+  std::map<Fl_SVG_Image_Key, int>::iterator it = images_.find(key);
+  found = (it != images_.end());
+  if (found) return it->second;
+  int n = (int)images_.size() + 1;
+  images_[key] = n;
+  return n;
+}
+
+void Fl_SVG_Graphics_Driver::use_image(int n, Fl_Image *img, int XP, int YP, int WP, int HP, int cx, int cy) {
+  bool need_clip = (cx || cy || WP != img->w() || HP != img->h());
+  if (need_clip) push_clip(XP, YP, WP, HP);
+  fprintf(out_, "<use href=\"#FLimg%d\" x=\"%d\" y=\"%d\"/>\n", n, XP-cx, YP-cy);
+  if (need_clip) pop_clip();
+}
+
 void Fl_SVG_Graphics_Driver::draw_rgb(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy) {
 #if defined(HAVE_LIBPNG)
-  char name[24];
-  bool need_clip = (cx || cy || WP != rgb->w() || HP != rgb->h());
-  void *p = (void*)*Fl_Graphics_Driver::id(rgb);
-  if (p) snprintf(name, 24, "FLrgb%p", p); else name[0] = 0;
-  if (!p || !last_rgb_name_ || strcmp(name, last_rgb_name_) != 0) {
-    if (*name==0 && need_clip) push_clip(XP, YP, WP, HP);
+  bool found;
+  int ld = rgb->ld() ? rgb->ld() : rgb->data_w() * rgb->d();
+  int n = find_image(rgb->array, rgb->data_w() * rgb->d(), ld, 0, rgb, rgb->d(), found);
+  if (!found) {
 #if defined(HAVE_LIBJPEG)
-    if (rgb->d() == 3 || rgb->d() == 1) define_rgb_jpeg(rgb, *name ? name : NULL, XP-cx, YP-cy);
+    if (rgb->d() == 3 || rgb->d() == 1) define_rgb_jpeg(rgb, n);
     else
 #endif // HAVE_LIBJPEG
-      define_rgb_png(rgb, *name ? name : NULL, XP-cx, YP-cy);
-    if (*name==0 && need_clip) pop_clip();
-  }
-  if (*name) {
-    if (need_clip) push_clip(XP, YP, WP, HP);
-    fprintf(out_, "<use href=\"#%s\" x=\"%d\" y=\"%d\"/>\n", last_rgb_name_, XP-cx, YP-cy);
-    if (need_clip) pop_clip();
+      define_rgb_png(rgb, n);
   }
+  use_image(n, rgb, XP, YP, WP, HP, cx, cy);
 #endif // HAVE_LIBPNG
 }
 
+// FNV-1a hash of the XPM data of a pixmap, which is much smaller than its RGBA
+// pixels, or 0 if the data can't be hashed
+static unsigned long long hash_xpm(const char * const *data) {
+  int w, h, ncolors, cpp;
+  if (!data || sscanf(data[0], "%d %d %d %d", &w, &h, &ncolors, &cpp) != 4) return 0;
+  unsigned long long hv = hash_rows((const uchar*)data[0], (int)strlen(data[0]), 1, 0,
+                                    14695981039346656037ULL);
+  int line = 1;
+  if (ncolors < 0) { // the colormap is a single string of -ncolors * 4 bytes
+    hv = hash_rows((const uchar*)data[1], -ncolors * 4, 1, 0, hv);
+    line = 2;
+  } else {
+    for (; line <= ncolors; line++)
+      hv = hash_rows((const uchar*)data[line], (int)strlen(data[line]), 1, 0, hv);
+  }
+  for (int j = 0; j < h; j++)
+    hv = hash_rows((const uchar*)data[line + j], w * cpp, 1, 0, hv);
+  return hv;
+}
+
 void Fl_SVG_Graphics_Driver::draw_pixmap(Fl_Pixmap *pxm, int XP, int YP, int WP, int HP, int cx, int cy) {
 #if defined(HAVE_LIBPNG)
-  char name[24];
-  bool need_clip = (cx || cy || WP != pxm->w() || HP != pxm->h());
-  void *p = (void*)*Fl_Graphics_Driver::id(pxm);
-  if (p) snprintf(name, 24, "FLpx%p", p); else name[0] = 0;
-  if (!p || !last_rgb_name_ || strcmp(name, last_rgb_name_) != 0) {
+  // A pixmap drawn before is found by a hash of its XPM data, without converting
+  // it to RGBA again. Its address isn't enough: it may be that of data freed and
+  // reused for other pixels. Other pixmaps go through find_image(), which also
+  // finds images with the same pixels.
+  Fl_SVG_Image_Key key;
+  key.hash = hash_xpm(pxm->data());
+  key.data_w = pxm->data_w();
+  key.data_h = pxm->data_h();
+  key.d = 4;
+  key.w = pxm->w();
+  key.h = pxm->h();
+  std::map<Fl_SVG_Image_Key, int>::iterator it = key.hash ? pixmaps_.find(key) : pixmaps_.end();
+  int n;
+  if (it != pixmaps_.end()) {
+    n = it->second;
+  } else {
+    bool found;
     Fl_RGB_Image *rgb = new Fl_RGB_Image(pxm);
-    if (*name==0 && need_clip) push_clip(XP, YP, WP, HP);
-    define_rgb_png(rgb, *name ? name : NULL, XP-cx, YP-cy);
-    if (*name==0 && need_clip) pop_clip();
+    n = find_image(rgb->array, rgb->data_w() * 4, rgb->data_w() * 4, 0, pxm, 4, found);
+    if (!found) define_rgb_png(rgb, n);
     delete rgb;
+    if (key.hash) pixmaps_[key] = n;
   }
-  if (*name) {
-    if (need_clip) push_clip(XP, YP, WP, HP);
-    fprintf(out_, "<use href=\"#%s\" x=\"%d\" y=\"%d\"/>\n", last_rgb_name_, XP-cx, YP-cy);
-    if (need_clip) pop_clip();
-  }
+  use_image(n, pxm, XP, YP, WP, HP, cx, cy);
 #endif // HAVE_LIBPNG
 }
 
 void Fl_SVG_Graphics_Driver::draw_bitmap(Fl_Bitmap *bm, int XP, int YP, int WP, int HP, int cx, int cy) {
 #if defined(HAVE_LIBPNG)
-  char name[45];
-  bool need_clip = (cx || cy || WP != bm->w() || HP != bm->h());
-  void *p = (void*)*Fl_Graphics_Driver::id(bm);
-  if (p) snprintf(name, 45, "FLbm%p%X", p, fl_color()); else name[0] = 0;
-  if (!p || !last_rgb_name_ || strcmp(name, last_rgb_name_) != 0) {
+  bool found;
+  int rowBytes = (bm->data_w()+7)>>3 ;
+  int n = find_image(bm->array, rowBytes, rowBytes, fl_color(), bm, 0, found);
+  if (!found) {
     uchar R, G, B;
     Fl::get_color(fl_color(), R, G, B);
     uchar *data = new uchar[bm->data_w() * bm->data_h() * 4];
     memset(data, 0, bm->data_w() * bm->data_h() * 4);
     Fl_RGB_Image *rgb = new Fl_RGB_Image(data, bm->data_w(), bm->data_h(), 4);
     rgb->alloc_array = 1;
-    int rowBytes = (bm->data_w()+7)>>3 ;
     for (int j = 0; j < bm->data_h(); j++) {
       const uchar *p = bm->array + j*rowBytes;
       for (int i = 0; i < rowBytes; i++) {
@@ -698,16 +749,10 @@ void Fl_SVG_Graphics_Driver::draw_bitmap(Fl_Bitmap *bm, int XP, int YP, int WP,
         p++;
       }
     }
-    if (*name==0 && need_clip) push_clip(XP, YP, WP, HP);
-    define_rgb_png(rgb, *name ? name : NULL, XP-cx, YP-cy);
-    if (*name==0 && need_clip) pop_clip();
+    define_rgb_png(rgb, n);
     delete rgb;
   }
-  if (*name) {
-    if (need_clip) push_clip(XP, YP, WP, HP);
-    fprintf(out_, "<use href=\"#%s\" x=\"%d\" y=\"%d\"/>\n", last_rgb_name_, XP-cx, YP-cy);
-    if (need_clip) pop_clip();
-  }
+  use_image(n, bm, XP, YP, WP, HP, cx, cy);
 #endif // HAVE_LIBPNG
 }
 
@@ -1,7 +1,7 @@
 //
 // Definition of the part of the Screen interface shared by X11/Wayland
 //
-// Copyright 2022-2024 by Bill Spitzak and others.
+// Copyright 2022-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -17,6 +17,7 @@
 #include <config.h>
 #include <sys/time.h>
 #include "Fl_Unix_Screen_Driver.H"
+#include "../../Fl_Trace.H"
 
 #if USE_POLL
 pollfd *Fl_Unix_Screen_Driver::pollfds = NULL;
@@ -67,6 +68,7 @@ int Fl_Unix_Screen_Driver::poll_or_select_with_delay(double time_to_wait) {
   fl_lock_function();
 
   if (n > 0) {
+    FL_TRACE_SCOPE("loop", "fd callbacks");
     for (int i=0; i<nfds; i++) {
 #  if USE_POLL
       if (pollfds[i].revents) fd[i].cb(pollfds[i].fd, fd[i].arg);
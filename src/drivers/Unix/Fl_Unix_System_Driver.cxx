@@ -2,7 +2,7 @@
 // Definition of Unix/Linux system driver
 // for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 2010-2024 by Bill Spitzak and others.
+// Copyright 2010-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -22,6 +22,7 @@
 #include <FL/platform.H>
 #include "../../flstring.h"
 #include "../../Fl_Timeout.h"
+#include "../../Fl_Private.H"
 
 #include <locale.h>
 #include <time.h>
@@ -798,16 +799,17 @@ double Fl_Unix_System_Driver::wait(double time_to_wait)
   if (time_to_wait <= 0.0) {
     // do flush second so that the results of events are visible:
     int ret = scr_dr->poll_or_select_with_delay(0.0);
-    Fl::flush();
+    Fl::Private::flush_frame();
     return ret;
   } else {
     // do flush first so that user sees the display:
-    Fl::flush();
-    if (Fl::idle()) // 'idle_' may have been set within flush()
+    Fl::Private::flush_frame();
+    if (Fl::Private::idle_pending()) // 'idle_' may have been set within flush()
       time_to_wait = 0.0;
     else {
       Fl_Timeout::elapse_timeouts();
       time_to_wait = Fl_Timeout::time_to_wait(time_to_wait);
+      time_to_wait = Fl::Private::frame_wait(time_to_wait);
     }
     return scr_dr->poll_or_select_with_delay(time_to_wait);
   }
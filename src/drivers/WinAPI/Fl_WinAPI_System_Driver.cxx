@@ -1,7 +1,7 @@
 //
 // Definition of Windows system driver for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2025 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -312,6 +312,16 @@ int Fl_WinAPI_System_Driver::rename(const char *fnam, const char *newnam) {
   return _wrename(wbuf, wbuf1);
 }
 
+int Fl_WinAPI_System_Driver::replace_file(const char *tmpname, const char *target) {
+  utf8_to_wchar(tmpname, wbuf);
+  utf8_to_wchar(target, wbuf1);
+  // ReplaceFileW() keeps the attributes and the security descriptor of the replaced file
+  if (GetFileAttributesW(wbuf1) != INVALID_FILE_ATTRIBUTES &&
+      ReplaceFileW(wbuf1, wbuf, NULL, REPLACEFILE_IGNORE_MERGE_ERRORS, NULL, NULL))
+    return 0;
+  return MoveFileExW(wbuf, wbuf1, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+}
+
 // See Fl::args_to_utf8()
 int Fl_WinAPI_System_Driver::args_to_utf8(int argc, char ** &argv) {
   int i;
@@ -1,7 +1,7 @@
 //
 // Definition of X11 window driver.
 //
-// Copyright 1998-2025 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -18,11 +18,12 @@
 #include <config.h>
 #include "Fl_X11_Window_Driver.H"
 #include "Fl_X11_Screen_Driver.H"
+#include "../../Fl_Scalable_Graphics_Driver.H" // for floor()
 #if FLTK_USE_CAIRO
 #  include <cairo-xlib.h>
 #  include "../Cairo/Fl_X11_Cairo_Graphics_Driver.H"
 #else
-#  include "../Xlib/Fl_Xlib_Graphics_Driver.H"
+#  include "../Xlib/Fl_Xlib_Graphics_Driver.H" // also for the rectangles of a Region
 #endif // FLTK_USE_CAIRO
 
 #include <FL/Fl_Tooltip.H>
@@ -32,6 +33,7 @@
 #include <FL/Fl.H>
 #include <FL/platform.H>
 #include <string.h>
+#include <math.h> // for ceil()
 #if HAVE_DLFCN_H
 #include <dlfcn.h>
 #endif
@@ -167,26 +169,62 @@ void Fl_X11_Window_Driver::flush_double(int erase_overlay)
   if (!other_xid) {
     other_xid = new Fl_Image_Surface(w(), h(), 1);
     pWindow->clear_damage(FL_DAMAGE_ALL);
+    if (i->region) { // the new offscreen must be drawn entirely
+      fl_graphics_driver->XDestroyRegion(i->region);
+      i->region = 0;
+    }
   }
 #if FLTK_USE_CAIRO
   cairo_t *cairo_ = ((Fl_Cairo_Graphics_Driver*)other_xid->driver())->cr();
   ((Fl_X11_Cairo_Graphics_Driver*)fl_graphics_driver)->set_cairo(cairo_);
 #endif
-  bool use_clip_box = true;
+  // i->region, when not NULL, holds all damaged areas (exposed or redrawn
+  // widgets): only they are redrawn and copied to the window
+  fl_clip_region(i->region); i->region = 0;
   if (pWindow->damage() & ~FL_DAMAGE_EXPOSE) {
-    use_clip_box = false;
-    fl_clip_region(i->region); i->region = 0;
     fl_window = other_xid->offscreen();
 # if defined(FLTK_HAVE_CAIROEXT)
     if (Fl::cairo_autolink_context()) Fl::cairo_make_current(pWindow);
 # endif
     draw();
+#if !FLTK_USE_CAIRO
+    Fl_Xlib_Graphics_Driver::flush_text_batch();
+#endif
     fl_window = i->xid;
   }
   if (erase_overlay) fl_clip_region(0);
-  int X = 0, Y = 0, W = w(), H = h();
-  if (use_clip_box) fl_clip_box(0, 0, w(), h(), X, Y, W, H);
-  fl_copy_offscreen(X, Y, W, H, other_xid->offscreen(), X, Y);
+  blit_region(fl_clip_region());
+}
+
+
+// Copies the rectangles of a region from the offscreen buffer to the window,
+// or the entire window if region is NULL.
+void Fl_X11_Window_Driver::blit_region(Fl_Region region)
+{
+  float s = Fl::screen_driver()->scale(screen_num());
+  Fl_Offscreen off = other_xid->offscreen();
+  if (!region) {
+    fl_copy_offscreen(0, 0, w(), h(), off, 0, 0);
+    blitted_pixels_ += (unsigned long long)(w() * s) * (unsigned long long)(h() * s);
+    return;
+  }
+#if FLTK_USE_CAIRO
+  cairo_region_t *r = (cairo_region_t*)region;
+  int count = cairo_region_num_rectangles(r);
+  for (int k = 0; k < count; k++) {
+    cairo_rectangle_int_t rect;
+    cairo_region_get_rectangle(r, k, &rect);
+    int X = rect.x, Y = rect.y, W = rect.width, H = rect.height;
+#else
+  Region r = (Region)region;
+  for (long k = 0; k < r->numRects; k++) {
+    int X = r->rects[k].x1, Y = r->rects[k].y1;
+    int W = r->rects[k].x2 - X, H = r->rects[k].y2 - Y;
+#endif
+    if (W <= 0 || H <= 0) continue;
+    fl_copy_offscreen(X, Y, W, H, off, X, Y);
+    blitted_pixels_ += (unsigned long long)(W * s) * (unsigned long long)(H * s);
+  }
 }
 
 
@@ -403,6 +441,9 @@ void Fl_X11_Window_Driver::make_current() {
     fl_alert("Fl_Window::make_current(), but window is not shown().");
     Fl::fatal("Fl_Window::make_current(), but window is not shown().");
   }
+#if !FLTK_USE_CAIRO
+  Fl_Xlib_Graphics_Driver::flush_text_batch();
+#endif
   fl_window = fl_xid(pWindow);
   fl_graphics_driver->clip_region(0);
 
@@ -530,15 +571,24 @@ int Fl_X11_Window_Driver::scroll(int src_x, int src_y, int src_w, int src_h, int
                                  void (*draw_area)(void*, int,int,int,int), void* data)
 {
   float s = Fl::screen_driver()->scale(screen_num());
+  // Convert the edges of the rectangles to pixels as Fl_Scalable_Graphics_Driver
+  // does when drawing, so that the copy is exact with fractional scales too.
+  int x1 = Fl_Scalable_Graphics_Driver::floor(src_x, s);
+  int y1 = Fl_Scalable_Graphics_Driver::floor(src_y, s);
   XCopyArea(fl_display, fl_window, fl_window, (GC)fl_graphics_driver->gc(),
-            int(src_x*s), int(src_y*s), int(src_w*s), int(src_h*s), int(dest_x*s), int(dest_y*s));
+            x1, y1, Fl_Scalable_Graphics_Driver::floor(src_x+src_w, s) - x1,
+            Fl_Scalable_Graphics_Driver::floor(src_y+src_h, s) - y1,
+            Fl_Scalable_Graphics_Driver::floor(dest_x, s),
+            Fl_Scalable_Graphics_Driver::floor(dest_y, s));
   // we have to sync the display and get the GraphicsExpose events! (sigh)
   for (;;) {
     XEvent e; XWindowEvent(fl_display, fl_window, ExposureMask, &e);
     if (e.type == NoExpose) break;
-    // otherwise assume it is a GraphicsExpose event:
-    draw_area(data, e.xexpose.x, e.xexpose.y,
-              e.xexpose.width, e.xexpose.height);
+    // otherwise assume it is a GraphicsExpose event, its rectangle is in
+    // pixels: draw all FLTK units that touch it
+    int ex = int(e.xexpose.x / s), ey = int(e.xexpose.y / s);
+    draw_area(data, ex, ey, int(ceil((e.xexpose.x + e.xexpose.width) / s)) - ex,
+              int(ceil((e.xexpose.y + e.xexpose.height) / s)) - ey);
     if (!e.xgraphicsexpose.count) break;
   }
   return 0;
@@ -1,7 +1,7 @@
 //
 // More font utilities for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2023 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -32,6 +32,10 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <X11/Xft/Xft.h>
 #include <X11/Xft/XftCompat.h>
 
@@ -673,41 +677,104 @@ Fl_Xlib_Font_Descriptor::Fl_Xlib_Font_Descriptor(const char* name, Fl_Fontsize f
 //  encoding = fl_encoding_;
   angle = fangle;
   font = fontopen(name, fsize, false, angle);
+  runs = NULL;
 }
 
 
-/* decodes the input UTF-8 string into a series of wchar_t characters.
- n is set upon return to the number of characters.
- Don't deallocate the returned memory.
+/* Strings are converted to runs of glyph indices once, together with the
+ position of each glyph and the extents of the whole string, and kept in a
+ cache of each font descriptor. Widgets measure and draw the same short
+ strings over and over again.
  */
-static const wchar_t *utf8reformat(const char *str, int& n)
-{
-  static const wchar_t empty[] = {0};
-  static wchar_t *buffer;
-  static int lbuf = 0;
-  int newn;
-  if (n == 0) return empty;
-  newn = fl_utf8towc(str, n, (wchar_t*)buffer, lbuf);
-  if (newn >= lbuf) {
-    lbuf = newn + 100;
-    if (buffer) free(buffer);
-    buffer = (wchar_t*)malloc(lbuf * sizeof(wchar_t));
-    n = fl_utf8towc(str, n, (wchar_t*)buffer, lbuf);
-  } else {
-    n = newn;
+struct Fl_Xft_Glyph_Run {
+  std::vector<FT_UInt> glyph; // glyph index of each character
+  std::vector<int> x, y;      // position of each glyph relative to the start
+  XGlyphInfo extents;         // extents of the whole string
+};
+
+struct Fl_Xft_Glyph_Runs {
+  std::unordered_map<std::string, Fl_Xft_Glyph_Run> map;
+};
+
+static const int glyph_run_max_bytes = 256;     // longer strings are not cached
+static const size_t glyph_run_max_count = 2048; // number of strings cached per font
+
+static void make_glyph_run(XftFont *font, const char *str, int n, Fl_Xft_Glyph_Run &run) {
+  run.glyph.clear();
+  run.x.clear();
+  run.y.clear();
+  const char *end = str + n;
+  int x = 0, y = 0;
+  while (str < end) {
+    int len;
+    FcChar32 ucs = fl_utf8decode(str, end, &len);
+    str += len;
+    FT_UInt g = XftCharIndex(fl_display, font, ucs);
+    XGlyphInfo gi;
+    XftGlyphExtents(fl_display, font, &g, 1, &gi);
+    run.glyph.push_back(g);
+    run.x.push_back(x);
+    run.y.push_back(y);
+    x += gi.xOff;
+    y += gi.yOff;
   }
-  return buffer;
+  memset(&run.extents, 0, sizeof(XGlyphInfo));
+  if (!run.glyph.empty())
+    XftGlyphExtents(fl_display, font, &run.glyph[0], (int)run.glyph.size(), &run.extents);
 }
 
-static void utf8extents(Fl_Xlib_Font_Descriptor *desc, const char *str, int n, XGlyphInfo *extents)
-{
-  memset(extents, 0, sizeof(XGlyphInfo));
-  const wchar_t *buffer = utf8reformat(str, n);
-#ifdef __CYGWIN__
-    XftTextExtents16(fl_display, desc->font, (XftChar16 *)buffer, n, extents);
-#else
-    XftTextExtents32(fl_display, desc->font, (XftChar32 *)buffer, n, extents);
-#endif
+/* Returns the glyphs of a UTF-8 string of n bytes.
+ The result is valid until the next call.
+ */
+static const Fl_Xft_Glyph_Run *glyph_run(Fl_Xlib_Font_Descriptor *desc, const char *str, int n) {
+  static Fl_Xft_Glyph_Run long_run;
+  if (n > glyph_run_max_bytes) {
+    make_glyph_run(desc->font, str, n, long_run);
+    return &long_run;
+  }
+  if (!desc->runs) desc->runs = new Fl_Xft_Glyph_Runs;
+  std::unordered_map<std::string, Fl_Xft_Glyph_Run> &map = desc->runs->map;
+  std::string key(str, n);
+  std::unordered_map<std::string, Fl_Xft_Glyph_Run>::iterator it = map.find(key);
+  if (it != map.end()) return &it->second;
+  if (map.size() >= glyph_run_max_count) map.clear();
+  Fl_Xft_Glyph_Run &run = map[key];
+  make_glyph_run(desc->font, str, n, run);
+  return &run;
+}
+
+// Text collected between fl_text_batch_begin() and fl_text_batch_end().
+// Only strings that the clip region doesn't cut are collected, so that they
+// can all be drawn unclipped: widgets usually set a clip region for each line
+// or cell, and text drawn entirely inside it doesn't need it.
+static struct {
+  int level;                              // nesting depth of fl_text_batch_begin()
+  std::vector<XftGlyphFontSpec> glyphs;   // glyphs to draw, with their fonts and positions
+  Window window;                          // where they are drawn,
+  XftColor color;                         // in this color
+} text_batch;
+
+// number of glyphs that triggers drawing the batch
+static const size_t text_batch_max = 4096;
+
+void Fl_Xlib_Graphics_Driver::text_batch_begin() {
+  text_batch.level++;
+}
+
+void Fl_Xlib_Graphics_Driver::text_batch_end() {
+  if (text_batch.level > 0 && --text_batch.level == 0)
+    flush_text_batch();
+}
+
+// Draws all collected glyphs with a single request.
+// Also called before drawing goes to another drawable, or before a drawable
+// is copied or deleted, so text is not drawn late or into a freed pixmap.
+void Fl_Xlib_Graphics_Driver::flush_text_batch() {
+  if (text_batch.glyphs.empty()) return;
+  XftDrawChange(draw_, draw_window = text_batch.window);
+  XftDrawSetClip(draw_, NULL);
+  XftDrawGlyphFontSpec(draw_, &text_batch.color, &text_batch.glyphs[0], (int)text_batch.glyphs.size());
+  text_batch.glyphs.clear();
 }
 
 int Fl_Xlib_Graphics_Driver::height_unscaled() {
@@ -722,9 +789,7 @@ int Fl_Xlib_Graphics_Driver::descent_unscaled() {
 
 double Fl_Xlib_Graphics_Driver::width_unscaled(const char* str, int n) {
   if (!font_descriptor()) return -1.0;
-  XGlyphInfo i;
-  utf8extents((Fl_Xlib_Font_Descriptor*)font_descriptor(), str, n, &i);
-  return i.xOff;
+  return glyph_run((Fl_Xlib_Font_Descriptor*)font_descriptor(), str, n)->extents.xOff;
 }
 
 static double fl_xft_width(Fl_Font_Descriptor *desc, FcChar32 *str, int n) {
@@ -745,8 +810,7 @@ void Fl_Xlib_Graphics_Driver::text_extents_unscaled(const char *c, int n, int &d
     dx = dy = 0;
     return;
   }
-  XGlyphInfo gi;
-  utf8extents((Fl_Xlib_Font_Descriptor*)font_descriptor(), c, n, &gi);
+  const XGlyphInfo &gi = glyph_run((Fl_Xlib_Font_Descriptor*)font_descriptor(), c, n)->extents;
 
   w = gi.width;
   h = gi.height;
@@ -768,29 +832,63 @@ void Fl_Xlib_Graphics_Driver::draw_unscaled(const char *str, int n, int x, int y
   if (!draw_)
     draw_ = XftDrawCreate(fl_display, draw_window = fl_window,
                          fl_visual->visual, fl_colormap);
-  else //if (draw_window != fl_window)
+  else if (!text_batch.level) //if (draw_window != fl_window)
     XftDrawChange(draw_, draw_window = fl_window);
 
   Region region = (Region)fl_clip_region();
-  if (!(region && XEmptyRegion(region))) {
+  if (region && XEmptyRegion(region)) return;
+
+  // Use fltk's color allocator, copy the results to match what
+  // XftCollorAllocValue returns:
+  XftColor color;
+  color.pixel = fl_xpixel(Fl_Graphics_Driver::color());
+  uchar r,g,b; Fl::get_color(Fl_Graphics_Driver::color(), r,g,b);
+  color.color.red   = ((int)r)*0x101;
+  color.color.green = ((int)g)*0x101;
+  color.color.blue  = ((int)b)*0x101;
+  color.color.alpha = 0xffff;
+
+  Fl_Xlib_Font_Descriptor *desc = (Fl_Xlib_Font_Descriptor*)font_descriptor();
+  const Fl_Xft_Glyph_Run *run = glyph_run(desc, str, n);
+  int count = (int)run->glyph.size();
+  if (!count) return;
+
+  if (!text_batch.level) {
     XftDrawSetClip(draw_, region);
+    XftDrawGlyphs(draw_, &color, desc->font, x1, y1, &run->glyph[0], count);
+    return;
+  }
 
-    // Use fltk's color allocator, copy the results to match what
-    // XftCollorAllocValue returns:
-    XftColor color;
-    color.pixel = fl_xpixel(Fl_Graphics_Driver::color());
-    uchar r,g,b; Fl::get_color(Fl_Graphics_Driver::color(), r,g,b);
-    color.color.red   = ((int)r)*0x101;
-    color.color.green = ((int)g)*0x101;
-    color.color.blue  = ((int)b)*0x101;
-    color.color.alpha = 0xffff;
-
-    const wchar_t *buffer = utf8reformat(str, n);
-#ifdef __CYGWIN__
-    XftDrawString16(draw_, &color, ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font, x1, y1, (XftChar16 *)buffer, n);
-#else
-    XftDrawString32(draw_, &color, ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font, x1, y1, (XftChar32 *)buffer, n);
-#endif
+  // a string the clip region cuts is drawn now, after the text collected so far
+  const XGlyphInfo &ink = run->extents;
+  if (region && XRectInRegion(region, x1 - ink.x, y1 - ink.y, ink.width, ink.height) != RectangleIn) {
+    flush_text_batch();
+    if (draw_window != fl_window) XftDrawChange(draw_, draw_window = fl_window);
+    XftDrawSetClip(draw_, region);
+    XftDrawGlyphs(draw_, &color, desc->font, x1, y1, &run->glyph[0], count);
+    return;
+  }
+
+  // add the glyphs to the batch, drawing it first if it can't take them
+  if (!text_batch.glyphs.empty() &&
+      (text_batch.window != fl_window ||
+       text_batch.color.pixel != color.pixel ||
+       memcmp(&text_batch.color.color, &color.color, sizeof(XRenderColor)) != 0 ||
+       text_batch.glyphs.size() + count > text_batch_max))
+    flush_text_batch();
+  if (text_batch.glyphs.empty()) {
+    text_batch.window = fl_window;
+    text_batch.color = color;
+  }
+  for (int i = 0; i < count; i++) {
+    XftGlyphFontSpec spec;
+    spec.font = desc->font;
+    spec.glyph = run->glyph[i];
+    int gx = x1 + run->x[i], gy = y1 + run->y[i];
+    if (gx < clip_min() || gx > clip_max() || gy < clip_min() || gy > clip_max()) break;
+    spec.x = (short)gx;
+    spec.y = (short)gy;
+    text_batch.glyphs.push_back(spec);
   }
 }
 
@@ -801,6 +899,7 @@ void Fl_Xlib_Graphics_Driver::draw_unscaled(int angle, const char *str, int n, i
 }
 
 void Fl_Xlib_Graphics_Driver::drawUCS4(const void *str, int n, int x, int y) {
+  flush_text_batch();
   if (!draw_)
     draw_ = XftDrawCreate(fl_display, draw_window = fl_window,
                          fl_visual->visual, fl_colormap);
@@ -962,11 +1061,16 @@ Fl_Xlib_Font_Descriptor::~Fl_Xlib_Font_Descriptor() {
 #if USE_PANGO
   if (width) for (int i = 0; i < 64; i++) delete[] width[i];
   delete[] width;
+#else
+  delete runs;
 #endif
 }
 
 
 void Fl_Xlib_Graphics_Driver::destroy_xft_draw(Window id) {
+#if ! USE_PANGO
+  if (id == text_batch.window) text_batch.glyphs.clear();
+#endif
   if (id == draw_window)
     XftDrawChange(draw_, draw_window = fl_message_window);
 }
@@ -1,7 +1,7 @@
 //
 // Image drawing routines for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2024 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -642,29 +642,70 @@ void Fl_Xlib_Graphics_Driver::draw_fixed(Fl_Bitmap *bm, int X, int Y, int W, int
 
 // Composite an image with alpha on systems that don't have accelerated
 // alpha compositing...
-static void alpha_blend(Fl_RGB_Image *img, int X, int Y, int W, int H, int cx, int cy) {
+// winW and winH give the size of the target drawable in pixels, or are 0
+// if it isn't known, e.g. when drawing to an offscreen.
+static void alpha_blend(Fl_RGB_Image *img, int X, int Y, int W, int H, int cx, int cy,
+                        int winW, int winH) {
   if (cx < 0) { W += cx; X -= cx; cx = 0; }
   if (cy < 0) { H += cy; Y -= cy; cy = 0; }
   if (W + cx > img->data_w()) W = img->data_w() - cx;
   if (H + cy > img->data_h()) H = img->data_h() - cy;
   // don't attempt to read outside the window/offscreen buffer limits
-  Window root_return;
-  int x_return, y_return;
-  unsigned int winW, winH;
-  unsigned int border_width_return;
-  unsigned int depth_return;
-  XGetGeometry(fl_display, fl_window, &root_return, &x_return, &y_return, &winW,
-               &winH, &border_width_return, &depth_return);
-  if (X+W > (int)winW) W = (int)winW-X;
-  if (Y+H > (int)winH) H = (int)winH-Y;
+  if (winW <= 0 || winH <= 0) {
+    Window root_return;
+    int x_return, y_return;
+    unsigned int w_return, h_return;
+    unsigned int border_width_return;
+    unsigned int depth_return;
+    XGetGeometry(fl_display, fl_window, &root_return, &x_return, &y_return, &w_return,
+                 &h_return, &border_width_return, &depth_return);
+    winW = (int)w_return;
+    winH = (int)h_return;
+  }
+  if (X+W > winW) W = winW-X;
+  if (Y+H > winH) H = winH-Y;
   if (W <= 0 || H <= 0) return;
+  int d = img->d();
   int ld = img->ld();
-  if (ld == 0) ld = img->data_w() * img->d();
-  uchar *srcptr = (uchar*)img->array + cy * ld + cx * img->d();
+  if (ld == 0) ld = img->data_w() * d;
+  uchar *srcptr = (uchar*)img->array + cy * ld + cx * d;
+
+  // Find the smallest rectangle around all pixels that aren't fully
+  // transparent, and whether all pixels in it are opaque. In that case
+  // the destination needn't be read back from the X server.
+  int top = -1, bottom = -1, left = W, right = -1;
+  long opaque = 0;
+  for (int y = 0; y < H; y++) {
+    const uchar *a = srcptr + y * ld + d - 1;
+    int first = -1, last = -1;
+    for (int x = 0; x < W; x++, a += d) {
+      if (!*a) continue;
+      if (first < 0) first = x;
+      last = x;
+      if (*a == 255) opaque++;
+    }
+    if (first < 0) continue;
+    if (top < 0) top = y;
+    bottom = y;
+    if (first < left) left = first;
+    if (last > right) right = last;
+  }
+  if (top < 0) return; // nothing to draw
+  srcptr += top * ld + left * d;
+  X += left;
+  Y += top;
+  W = right - left + 1;
+  H = bottom - top + 1;
+  if (opaque == (long)W * H) { // special case "copy" for the whole rectangle
+    fl_draw_image(srcptr, X, Y, W, H, d, ld);
+    return;
+  }
 
+  // Translucent pixels need the destination: this is one XGetImage per
+  // draw, because the driver keeps no client-side copy of the drawable.
   uchar *dst = fl_read_image(NULL, X, Y, W, H, 0);
   if (!dst) {
-    fl_draw_image(srcptr, X, Y, W, H, img->d(), ld);
+    fl_draw_image(srcptr, X, Y, W, H, d, ld);
     return;
   }
   int srcskip = ld - img->d() * W;
@@ -772,8 +813,14 @@ void Fl_Xlib_Graphics_Driver::draw_fixed(Fl_RGB_Image *img, int X, int Y, int W,
   Fl_X11_Screen_Driver *d = (Fl_X11_Screen_Driver*)Fl::screen_driver();
   int nscreen = Fl_Window_Driver::driver(Fl_Window::current())->screen_num();
   float keep = d->scale(nscreen);
+  // the size of a window or of its back buffer is known without asking the X server
+  int winW = 0, winH = 0;
+  if (Fl_Surface_Device::surface() == Fl_Display_Device::display_device()) {
+    winW = Fl_Scalable_Graphics_Driver::floor(Fl_Window::current()->w(), keep);
+    winH = Fl_Scalable_Graphics_Driver::floor(Fl_Window::current()->h(), keep);
+  }
   d->scale(nscreen, 1);
-  alpha_blend(img, X, Y, W, H, cx, cy);
+  alpha_blend(img, X, Y, W, H, cx, cy, winW, winH);
   d->scale(nscreen, keep);
   Fl_Graphics_Driver::scale(s);
   offset_x_ = ox; offset_y_ = oy;
@@ -1,7 +1,7 @@
 //
 // Draw-to-image code for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2023 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -72,12 +72,19 @@ Fl_Xlib_Image_Surface_Driver::~Fl_Xlib_Image_Surface_Driver() {
     delete shape_data_->mask;
     free(shape_data_);
   }
+  Fl_Xlib_Graphics_Driver::flush_text_batch();
+#  if USE_XFT
+  Fl_Xlib_Graphics_Driver::destroy_xft_draw((Window)offscreen);
+#  endif
 #endif
   if (offscreen && !external_offscreen) XFreePixmap(fl_display, (Pixmap)offscreen);
   delete driver();
 }
 
 void Fl_Xlib_Image_Surface_Driver::set_current() {
+#if !FLTK_USE_CAIRO
+  Fl_Xlib_Graphics_Driver::flush_text_batch();
+#endif
   Fl_Surface_Device::set_current();
   pre_window = fl_window;
   fl_window = offscreen;
@@ -107,6 +114,9 @@ void Fl_Xlib_Image_Surface_Driver::untranslate() {
 
 Fl_RGB_Image* Fl_Xlib_Image_Surface_Driver::image()
 {
+#if !FLTK_USE_CAIRO
+  Fl_Xlib_Graphics_Driver::flush_text_batch();
+#endif
   if (shape_data_) {
 #if FLTK_USE_CAIRO
     // draw above the secondary offscreen the main offscreen masked by mask_pattern_
@@ -164,6 +174,9 @@ Fl_RGB_Image* Fl_Xlib_Image_Surface_Driver::image()
 
 void Fl_Xlib_Image_Surface_Driver::end_current()
 {
+#if !FLTK_USE_CAIRO
+  Fl_Xlib_Graphics_Driver::flush_text_batch();
+#endif
   fl_window = pre_window;
   Fl_Surface_Device::end_current();
 }
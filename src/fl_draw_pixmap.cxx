@@ -1,7 +1,7 @@
 //
 // Pixmap drawing code for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2018 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -35,15 +35,74 @@
 #include "Fl_System_Driver.H"
 #include <FL/platform.H>
 #include <FL/fl_draw.H>
+#include <FL/Fl_Pixmap.H>
 #include <stdio.h>
 #include "flstring.h"
 
 
-static int ncolors, chars_per_pixel;
-
 typedef struct { uchar r; uchar g; uchar b; } UsedColor;
-static UsedColor *used_colors;
-static int color_count;             // # of non-transparent colors used in pixmap
+
+/*
+  Read the XPM header: width, height, number of colors, and characters per pixel.
+  Returns 0 if the header is not valid.
+*/
+static int parse_pixmap_header(const char * const *cdata, int &w, int &h, int &ncolors, int &chars_per_pixel) {
+  int i = sscanf(cdata[0],"%d%d%d%d",&w,&h,&ncolors,&chars_per_pixel);
+  if (i<4 || w<=0 || h<=0 ||
+      (chars_per_pixel!=1 && chars_per_pixel!=2) ) return w=0;
+  return 1;
+}
+
+/*
+  Color lookup table for converting one pixmap.
+
+  Pixmaps with one character per pixel index the table directly. Pixmaps
+  with two characters per pixel use an open addressing hash table that is
+  sized for the number of colors, instead of a 64k entry table.
+  All state lives in this object, so conversions can run concurrently.
+*/
+class Fl_XPM_Colormap {
+  struct Entry { int key; uchar rgba[4]; };
+  Entry *table_;
+  unsigned mask_;
+  bool direct_;
+  unsigned slot(int key) const {
+    if (direct_) return (unsigned)key & mask_;
+    unsigned i = ((unsigned)key * 2654435761U) & mask_;
+    while (table_[i].key != key && table_[i].key != -1)
+      i = (i + 1) & mask_;
+    return i;
+  }
+public:
+  Fl_XPM_Colormap(int chars_per_pixel, int ncolors) {
+    direct_ = (chars_per_pixel < 2);
+    unsigned n = 256;
+    if (!direct_) {
+      n = 16;
+      while (n < (unsigned)ncolors * 2) n <<= 1;
+    }
+    mask_ = n - 1;
+    table_ = new Entry[n];
+    for (unsigned i = 0; i < n; i++) {
+      table_[i].key = direct_ ? (int)i : -1;
+      memset(table_[i].rgba, 0, 4);
+    }
+  }
+  ~Fl_XPM_Colormap() { delete[] table_; }
+  // return the color entry for a key, adding the key if needed
+  uchar *add(int key) {
+    Entry &e = table_[slot(key)];
+    e.key = key;
+    return e.rgba;
+  }
+  // return the color for a key, or transparent black for unknown keys
+  const uchar *find(int key) const {
+    static const uchar none[4] = { 0, 0, 0, 0 };
+    const Entry &e = table_[slot(key)];
+    return (e.key == key) ? e.rgba : none;
+  }
+};
+
 
 /**
   Get the dimensions of a pixmap.
@@ -63,28 +122,23 @@ int fl_measure_pixmap(/*const*/ char* const* data, int &w, int &h) {
   \see fl_measure_pixmap(char* const* data, int &w, int &h)
   */
 int fl_measure_pixmap(const char * const *cdata, int &w, int &h) {
-  int i = sscanf(cdata[0],"%d%d%d%d",&w,&h,&ncolors,&chars_per_pixel);
-  if (i<4 || w<=0 || h<=0 ||
-      (chars_per_pixel!=1 && chars_per_pixel!=2) ) return w=0;
-  return 1;
+  int ncolors, chars_per_pixel;
+  return parse_pixmap_header(cdata, w, h, ncolors, chars_per_pixel);
 }
 
 int fl_convert_pixmap(const char*const* cdata, uchar* out, Fl_Color bg) {
-  int w, h;
+  int w, h, ncolors, chars_per_pixel;
   const uchar*const* data = (const uchar*const*)(cdata+1);
   uchar *transparent_c = (uchar *)0; // such that transparent_c[0,1,2] are the RGB of the transparent color
+  UsedColor *used_colors = 0;
+  int color_count = 0;                // # of non-transparent colors used in pixmap
 
-  if (!fl_measure_pixmap(cdata, w, h))
-    return 0;
-
-  if ((chars_per_pixel < 1) || (chars_per_pixel > 2))
+  if (!parse_pixmap_header(cdata, w, h, ncolors, chars_per_pixel))
     return 0;
 
-  typedef uchar uchar4[4];
-  uchar4 *colors = new uchar4[ int(1<<(chars_per_pixel*8)) ];
+  Fl_XPM_Colormap colors(chars_per_pixel, abs(ncolors));
 
   if (Fl_Graphics_Driver::need_pixmap_bg_color) {
-    color_count = 0;
     used_colors = (UsedColor*)malloc(abs(ncolors) * sizeof(UsedColor));
   }
 
@@ -94,7 +148,7 @@ int fl_convert_pixmap(const char*const* cdata, uchar* out, Fl_Color bg) {
     // if first color is ' ' it is transparent (put it later to make
     // it not be transparent):
     if (*p == ' ') {
-      uchar* c = colors[(int)' '];
+      uchar* c = colors.add(' ');
       Fl::get_color(bg, c[0], c[1], c[2]); c[3] = 0;
       if (Fl_Graphics_Driver::need_pixmap_bg_color) transparent_c = c;
       p += 4;
@@ -102,7 +156,7 @@ int fl_convert_pixmap(const char*const* cdata, uchar* out, Fl_Color bg) {
     }
     // read all the rest of the colors:
     for (int i=0; i < ncolors; i++) {
-      uchar* c = colors[*p++];
+      uchar* c = colors.add(*p++);
       if (Fl_Graphics_Driver::need_pixmap_bg_color) {
         used_colors[color_count].r = *(p+0);
         used_colors[color_count].g = *(p+1);
@@ -122,7 +176,7 @@ int fl_convert_pixmap(const char*const* cdata, uchar* out, Fl_Color bg) {
       uchar* c;
       if (chars_per_pixel>1)
         ind = (ind<<8)|*p++;
-      c = colors[ind];
+      c = colors.add(ind);
       // look for "c word", or last word if none:
       const uchar *previous_word = p;
       for (;;) {
@@ -161,6 +215,7 @@ int fl_convert_pixmap(const char*const* cdata, uchar* out, Fl_Color bg) {
       uchar r, g, b;
       fl_graphics_driver->make_unused_color_(r, g, b, color_count, (void**)&used_colors);
     }
+    if (used_colors) free(used_colors);
   }
 
   U32 *q = (U32*)out;
@@ -168,19 +223,119 @@ int fl_convert_pixmap(const char*const* cdata, uchar* out, Fl_Color bg) {
     const uchar* p = data[Y];
     if (chars_per_pixel <= 1) {
       for (int X = 0; X < w; X++)
-        memcpy(q++, colors[*p++], 4);
+        memcpy(q++, colors.find(*p++), 4);
     } else {
+      // neighboring pixels often share a color, so remember the last lookup
+      int last = -1;
+      const uchar *c = 0;
       for (int X = 0; X < w; X++) {
         int ind = (*p++)<<8;
         ind |= *p++;
-        memcpy(q++, colors[ind], 4);
+        if (ind != last) { c = colors.find(ind); last = ind; }
+        memcpy(q++, c, 4);
       }
     }
   }
-  delete[] colors;
   return 1;
 }
 
+
+/*
+  Converted RGBA data of the pixmaps drawn last.
+
+  Drivers that convert a pixmap into an Fl_RGB_Image for every draw
+  operation (printing, SVG and PostScript output, texture uploads) reuse
+  the converted pixels of a pixmap drawn again with the same background
+  color. At most pixmap_rgba_entries pixmaps and pixmap_rgba_max_size bytes
+  are kept; the least recently used entry goes first. Fl_Pixmap::uncache()
+  removes the entry of a pixmap, which also happens when the pixmap data
+  changes and when the pixmap is deleted. Like all drawing, this is only
+  used by the thread that holds Fl::lock().
+*/
+struct Fl_Pixmap_RGBA_Entry {
+  const Fl_Pixmap *pxm;         // NULL for a free entry
+  const char * const *data;     // data of pxm when it was converted
+  Fl_Color bg;
+  uchar *rgba;
+  size_t size;                  // bytes of rgba
+  unsigned long used;           // value of pixmap_rgba_clock when last used
+};
+static const int pixmap_rgba_entries = 32;
+static const size_t pixmap_rgba_max_size = 4 * 1024 * 1024;
+static Fl_Pixmap_RGBA_Entry pixmap_rgba[pixmap_rgba_entries];
+static size_t pixmap_rgba_size = 0;     // bytes of all entries
+static unsigned long pixmap_rgba_clock = 0;
+
+static void free_pixmap_rgba(Fl_Pixmap_RGBA_Entry &e) {
+  delete[] e.rgba;
+  pixmap_rgba_size -= e.size;
+  e.pxm = 0;
+  e.rgba = 0;
+  e.size = 0;
+}
+
+/*
+  Convert the pixmap into RGBA data, reusing the result of a recent
+  conversion of the same pixmap with the same background color.
+  \p out must hold data_w() * data_h() * 4 bytes.
+*/
+int fl_convert_pixmap_cached_(const Fl_Pixmap *pxm, uchar* out, Fl_Color bg) {
+  size_t n = (size_t)pxm->data_w() * pxm->data_h() * 4;
+  // conversion results depend on the printer if this is set
+  if (Fl_Graphics_Driver::need_pixmap_bg_color)
+    return fl_convert_pixmap(pxm->data(), out, bg);
+  int i, oldest = 0;
+  for (i = 0; i < pixmap_rgba_entries; i++) {
+    Fl_Pixmap_RGBA_Entry &e = pixmap_rgba[i];
+    if (e.pxm == pxm) break;
+    if (!pixmap_rgba[oldest].pxm) continue; // a free entry is used first
+    if (!e.pxm || e.used < pixmap_rgba[oldest].used) oldest = i;
+  }
+  if (i < pixmap_rgba_entries) {
+    Fl_Pixmap_RGBA_Entry &e = pixmap_rgba[i];
+    if (e.data == pxm->data() && e.bg == bg) {
+      memcpy(out, e.rgba, n);
+      e.used = ++pixmap_rgba_clock;
+      return 1;
+    }
+    free_pixmap_rgba(e); // converted with another color
+    oldest = i;
+  }
+  if (!fl_convert_pixmap(pxm->data(), out, bg)) return 0;
+  if (n > pixmap_rgba_max_size / 4) return 1; // large pixmaps would evict all others
+  if (pixmap_rgba[oldest].pxm) free_pixmap_rgba(pixmap_rgba[oldest]);
+  while (pixmap_rgba_size + n > pixmap_rgba_max_size) { // free the least recently used
+    int lru = -1;
+    for (i = 0; i < pixmap_rgba_entries; i++) {
+      if (pixmap_rgba[i].pxm && (lru < 0 || pixmap_rgba[i].used < pixmap_rgba[lru].used))
+        lru = i;
+    }
+    free_pixmap_rgba(pixmap_rgba[lru]);
+  }
+  Fl_Pixmap_RGBA_Entry &e = pixmap_rgba[oldest];
+  e.pxm = pxm;
+  e.data = pxm->data();
+  e.bg = bg;
+  e.rgba = new uchar[n];
+  e.size = n;
+  e.used = ++pixmap_rgba_clock;
+  memcpy(e.rgba, out, n);
+  pixmap_rgba_size += n;
+  return 1;
+}
+
+/*
+  Remove the converted RGBA data of a pixmap.
+*/
+void fl_uncache_pixmap_rgba_(const Fl_Pixmap *pxm) {
+  for (int i = 0; i < pixmap_rgba_entries; i++) {
+    if (pixmap_rgba[i].pxm == pxm) {
+      free_pixmap_rgba(pixmap_rgba[i]);
+      return;
+    }
+  }
+}
+
 int fl_draw_pixmap(const char*const* cdata, int x, int y, Fl_Color bg) {
   int w, h;
 
@@ -119,7 +119,13 @@ fl_check_images(const char *name,               // I - Filename
 #ifdef HAVE_LIBJPEG
   if (memcmp(header, "\377\330\377", 3) == 0 && // Start-of-Image
       header[3] >= 0xc0 && header[3] <= 0xfe)   // APPn .. comment for JPEG file
+  {
+    int W, H;
+    Fl_Shared_Image::requested_size(W, H);
+    if (W && H)
+      return new Fl_JPEG_Image(name, W, H);
     return new Fl_JPEG_Image(name);
+  }
 #endif // HAVE_LIBJPEG
 
   // SVG or SVGZ (gzip'ed SVG)
@@ -1,7 +1,7 @@
 //
 // Scrolling routines for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2021 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -19,7 +19,17 @@
 // into the drawing area.
 
 #include "Fl_Window_Driver.H"
+#include <FL/Fl_Device.H>
 #include <FL/fl_draw.H>
+#include <math.h>
+
+// Whether an offset of d FLTK units is a whole number of pixels at scale s.
+// Contents drawn at a fractional scale are aligned to pixels so that they
+// can only be moved exactly by such offsets.
+static bool whole_pixels(int d, float s) {
+  float p = d * s;
+  return fabsf(p - floorf(p + 0.5f)) < 0.001f;
+}
 
 // scroll a rectangle and redraw the newly exposed portions:
 /**
@@ -32,12 +42,11 @@
   The contents of the rectangular area is first shifted by \p dx
   and \p dy pixels. The \p draw_area callback is then called for
   every newly exposed rectangular area.
- \warning With FLTK 1.4 and above, it's recommended to put graphical elements in an Fl_Scroll
- widget rather than use function fl_scroll() to update those elements. That's because fl_scroll()
- may not produce a pixel-accurate result when the GUI scaling factor value is not a multiple of 100%.
- Alternatively, use fl_scroll() when the scaling factor value is a multiple of 100% and perform a
- full redraw of the graphical elements otherwise. Statement <tt>float s = Fl::screen_scale(win->screen_num());</tt>
- gives the current scaling factor value given Fl_Window *win.
+ When the GUI scaling factor value is not a multiple of 100%, the contents
+ are moved only on X11, and only if \p dx and \p dy are whole numbers of
+ pixels at that scale (for instance, even numbers at 150% or multiples of 4
+ at 125%), so that the result is pixel-accurate. Otherwise \p draw_area is
+ called for the whole rectangle.
   */
 void fl_scroll(int X, int Y, int W, int H, int dx, int dy,
                void (*draw_area)(void*, int,int,int,int), void* data)
@@ -48,6 +57,14 @@ void fl_scroll(int X, int Y, int W, int H, int dx, int dy,
     draw_area(data,X,Y,W,H);
     return;
   }
+  float s = Fl_Surface_Device::surface()->driver()->scale();
+  if (s != int(s) &&
+      !(Fl_Window_Driver::driver(Fl_Window::current())->scroll_fractional_scale() &&
+        whole_pixels(dx, s) && whole_pixels(dy, s))) {
+    // the moved contents would not be aligned with the pixels
+    draw_area(data,X,Y,W,H);
+    return;
+  }
   int src_x, src_w, dest_x, clip_x, clip_w;
   if (dx > 0) {
     src_x = X;
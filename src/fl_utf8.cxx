@@ -26,6 +26,13 @@
 #include <sys/stat.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h> // SSE2 is available on all x86_64 processors
+#  define FL_UTF8_SSE2 1
+#else
+#  define FL_UTF8_SSE2 0
+#endif
 
 #undef fl_open
 
@@ -1015,6 +1022,52 @@ unsigned fl_utf8decode(const char* p, const char* end, int* len)
   }
 }
 
+/*
+  Returns a pointer to the first byte in [p, end) that is not ASCII, or end.
+  Text is mostly made of long runs of ASCII characters; this checks 16 (SSE2)
+  or 8 bytes at a time so the conversion functions below can copy such runs
+  without decoding them one character at a time.
+*/
+const char *fl_utf8_skip_ascii_(const char *p, const char *end)
+{
+#if FL_UTF8_SSE2
+  while (end - p >= 16) {
+    if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)p))) break;
+    p += 16;
+  }
+#endif
+  while (end - p >= 8) {
+    uint64_t word;
+    memcpy(&word, p, 8); // p may not be aligned
+    if (word & 0x8080808080808080ULL) break;
+    p += 8;
+  }
+  while (p < end && !(*p & 0x80)) p++;
+  return p;
+}
+
+/*
+  Same as fl_utf8decode(p, end, len) with the most frequent valid 2- and 3-byte
+  sequences decoded inline, for scanning text in CJK and other non-Latin scripts.
+*/
+static inline unsigned utf8decode_mb(const char* p, const char* end, int* len)
+{
+  const unsigned char *u = (const unsigned char*)p;
+  unsigned char c = u[0];
+  if (c >= 0xc2 && c < 0xe0) {
+    if (end - p >= 2 && (u[1] & 0xc0) == 0x80) {
+      *len = 2;
+      return ((c & 0x1f) << 6) + (u[1] & 0x3f);
+    }
+  } else if (c > 0xe0 && c < 0xf0 && (!STRICT_RFC3629 || (c != 0xed && c != 0xef))) {
+    if (end - p >= 3 && (u[1] & 0xc0) == 0x80 && (u[2] & 0xc0) == 0x80) {
+      *len = 3;
+      return ((c & 0x0f) << 12) + ((u[1] & 0x3f) << 6) + (u[2] & 0x3f);
+    }
+  }
+  return fl_utf8decode(p, end, len);
+}
+
 /** Move \p p forward until it points to the start of a UTF-8
   character. If it already points at the start of one then it
   is returned unchanged. Any UTF-8 errors are treated as though each
@@ -1253,10 +1306,16 @@ unsigned fl_utf8toUtf16(const char* src, unsigned srclen,
   unsigned count = 0;
   if (dstlen) for (;;) {
     if (p >= e) {dst[count] = 0; return count;}
-    if (!(*p & 0x80)) { /* ascii */
-      dst[count] = *p++;
+    if (!(*p & 0x80)) { /* copy a run of ascii */
+      unsigned n = (unsigned)(fl_utf8_skip_ascii_(p, e) - p);
+      if (n > dstlen - count) n = dstlen - count;
+      for (unsigned i = 0; i < n; i++) dst[count + i] = (unsigned short)p[i];
+      p += n;
+      count += n;
+      if (count == dstlen) {dst[count-1] = 0; break;}
+      continue;
     } else {
-      int len; unsigned ucs = fl_utf8decode(p,e,&len);
+      int len; unsigned ucs = utf8decode_mb(p,e,&len);
       p += len;
       if (ucs < 0x10000) {
         dst[count] = ucs;
@@ -1271,9 +1330,13 @@ unsigned fl_utf8toUtf16(const char* src, unsigned srclen,
   }
   /* we filled dst, measure the rest: */
   while (p < e) {
-    if (!(*p & 0x80)) p++;
-    else {
-      int len; unsigned ucs = fl_utf8decode(p,e,&len);
+    if (!(*p & 0x80)) {
+      const char *a = fl_utf8_skip_ascii_(p, e);
+      count += (unsigned)(a - p);
+      p = a;
+      continue;
+    } else {
+      int len; unsigned ucs = utf8decode_mb(p,e,&len);
       p += len;
       if (ucs >= 0x10000) ++count;
     }
@@ -1313,7 +1376,15 @@ unsigned fl_utf8toa(const char* src, unsigned srclen,
     unsigned char c;
     if (p >= e) {dst[count] = 0; return count;}
     c = *(const unsigned char*)p;
-    if (c < 0xC2) { /* ascii or bad code */
+    if (c < 0x80) { /* copy a run of ascii */
+      unsigned n = (unsigned)(fl_utf8_skip_ascii_(p, e) - p);
+      if (n > dstlen - count) n = dstlen - count;
+      memcpy(dst + count, p, n);
+      p += n;
+      count += n;
+      if (count >= dstlen) {dst[count-1] = 0; break;}
+      continue;
+    } else if (c < 0xC2) { /* bad code */
       dst[count] = c;
       p++;
     } else {
@@ -1331,8 +1402,12 @@ unsigned fl_utf8toa(const char* src, unsigned srclen,
   }
   /* we filled dst, measure the rest: */
   while (p < e) {
-    if (!(*p & 0x80)) p++;
-    else {
+    if (!(*p & 0x80)) {
+      const char *a = fl_utf8_skip_ascii_(p, e);
+      count += (unsigned)(a - p);
+      p = a;
+      continue;
+    } else {
       int len = fl_utf8len1(*p);
       if (len > 2) p = fl_utf8_next_composed_char(p, e);
       else {
@@ -1425,12 +1500,12 @@ int fl_utf8test(const char* src, unsigned srclen) {
   const char* e = src+srclen;
   while (p < e) {
     if (*p & 0x80) {
-      int len; fl_utf8decode(p,e,&len);
+      int len; utf8decode_mb(p,e,&len);
       if (len < 2) return 0;
       if (len > ret) ret = len;
       p += len;
     } else {
-      p++;
+      p = fl_utf8_skip_ascii_(p, e);
     }
   }
   return ret;
@@ -1,7 +1,7 @@
 //
 // Fl_PNG_Image support functions for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 2005-2025 by Bill Spitzak and others.
+// Copyright 2005-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -19,7 +19,13 @@
 #include <FL/Fl_RGB_Image.H>
 #include <FL/fl_string_functions.h>
 #include <FL/fl_utf8.h>               // fl_fopen()
+#include <FL/Fl.H>
+#include "Fl_System_Driver.H"           // start_joinable_thread()
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <atomic>
 
 // FIXME: see original commit 2db94dcb4c5bf2ef3fa92f1cd6a41f3f90105361
 // ... about building X11 backend on macOS ≥ 11:
@@ -125,32 +131,299 @@ int fl_write_png(const char *filename, const unsigned char *pixels, int w, int h
   \see fl_write_png(const char *filename, Fl_RGB_Image *img)
 */
 int fl_write_png(const char *filename, const char *pixels, int w, int h, int d, int ld) {
+  return fl_write_png(filename, (const unsigned char *)pixels, w, h, d, ld, Fl_PNG_Options());
+}
 
 #if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
 
+// Output of the PNG encoder: a file or a growing block of memory
+struct png_output {
   FILE *fp;
-  int color_type;
+  unsigned char *buffer;
+  size_t size, alloc;
+};
 
-  if ((fp = fl_fopen(filename, "wb")) == NULL) {
-    return -2;
+extern "C" {
+  static void png_write_data_to_mem(png_structp pp, png_bytep data, png_size_t length) {
+    png_output *out = (png_output *)png_get_io_ptr(pp);
+    if (out->size + length > out->alloc) {
+      size_t alloc = out->alloc ? out->alloc : 65536;
+      while (alloc < out->size + length) alloc *= 2;
+      unsigned char *buffer = (unsigned char *)realloc(out->buffer, alloc);
+      if (!buffer) png_error(pp, "Cannot allocate memory for PNG data");
+      out->buffer = buffer;
+      out->alloc = alloc;
+    }
+    memcpy(out->buffer + out->size, data, length);
+    out->size += length;
+  }
+  static void png_flush_mem(png_structp) {}
+} // extern "C"
+
+// Resolves the default filter and strategy of the options
+static void png_resolve_options(const Fl_PNG_Options &options, int &level, int &filter, int &strategy) {
+  level = options.compression;
+  if (level < -1 || level > 9) level = -1;
+  filter = options.filter;
+  if (filter < Fl_PNG_Options::FILTER_NONE || filter > Fl_PNG_Options::FILTER_ADAPTIVE)
+    filter = (level == 0 ? Fl_PNG_Options::FILTER_NONE : Fl_PNG_Options::FILTER_ADAPTIVE);
+  strategy = options.strategy;
+  if (strategy < Fl_PNG_Options::STRATEGY_NORMAL || strategy > Fl_PNG_Options::STRATEGY_RLE)
+    strategy = (filter == Fl_PNG_Options::FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED);
+}
+
+// Paeth predictor of the PNG specification
+static inline int paeth(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+  if (pa <= pb && pa <= pc) return a;
+  return (pb <= pc ? b : c);
+}
+
+// Filters a row of n bytes with bpp bytes per pixel into out, which gets
+// the filter type followed by n bytes. prev is the row above or NULL.
+static void png_filter_row(int type, const uchar *row, const uchar *prev, int n, int bpp, uchar *out) {
+  *out++ = (uchar)type;
+  int i;
+  switch (type) {
+    case Fl_PNG_Options::FILTER_SUB:
+      for (i = 0; i < bpp && i < n; i++) out[i] = row[i];
+      for (; i < n; i++) out[i] = (uchar)(row[i] - row[i - bpp]);
+      break;
+    case Fl_PNG_Options::FILTER_UP:
+      for (i = 0; i < n; i++) out[i] = (uchar)(row[i] - (prev ? prev[i] : 0));
+      break;
+    case Fl_PNG_Options::FILTER_AVERAGE:
+      for (i = 0; i < n; i++) {
+        int left = (i >= bpp ? row[i - bpp] : 0), up = (prev ? prev[i] : 0);
+        out[i] = (uchar)(row[i] - ((left + up) >> 1));
+      }
+      break;
+    case Fl_PNG_Options::FILTER_PAETH:
+      for (i = 0; i < n; i++) {
+        int left = (i >= bpp ? row[i - bpp] : 0), up = (prev ? prev[i] : 0);
+        int upleft = (i >= bpp && prev ? prev[i - bpp] : 0);
+        out[i] = (uchar)(row[i] - paeth(left, up, upleft));
+      }
+      break;
+    default:
+      memcpy(out, row, n);
+      break;
+  }
+}
+
+// Sum of the absolute values of filtered bytes taken as signed numbers,
+// the heuristic libpng uses to choose a filter for each row
+static unsigned long png_filter_cost(const uchar *out, int n) {
+  unsigned long sum = 0;
+  for (int i = 1; i <= n; i++) sum += (out[i] < 128 ? out[i] : 256 - out[i]);
+  return sum;
+}
+
+// A band of rows compressed by one thread
+struct png_band {
+  int y, n;               // first row and number of rows
+  unsigned char *data;    // raw deflate data
+  size_t size;
+  uLong adler;            // Adler-32 checksum of the filtered rows
+  uLong length;           // number of bytes of the filtered rows
+  int error;
+};
+
+// The bands of an image and the threads working on them. Threads take the
+// next band until there are none left.
+struct png_job {
+  const uchar *pixels;
+  int w, h, d, ld;
+  int level, filter, strategy;
+  png_band *bands;
+  int nbands;
+  std::atomic<int> next;
+  ~png_job() {
+    for (int i = 0; i < nbands; i++) free(bands[i].data);
+    delete[] bands;
+  }
+};
+
+static void png_compress_band(png_job *job, png_band *band) {
+  int n = job->w * job->d;
+  uchar *line = new uchar[2 * (n + 1)]; // filtered row, and another one to try filters
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (deflateInit2(&zs, job->level, Z_DEFLATED, -15, 8, job->strategy) != Z_OK) {
+    band->error = 1;
+    delete[] line;
+    return;
+  }
+  size_t alloc = deflateBound(&zs, (uLong)band->n * (n + 1)) + 64;
+  band->data = (unsigned char *)malloc(alloc);
+  band->adler = adler32(0L, Z_NULL, 0);
+  band->length = 0;
+  bool last = (band->y + band->n == job->h);
+  for (int y = band->y; y < band->y + band->n && band->data; y++) {
+    const uchar *row = job->pixels + (size_t)y * job->ld;
+    const uchar *prev = (y > 0 ? row - job->ld : NULL);
+    uchar *out = line;
+    if (job->filter == Fl_PNG_Options::FILTER_ADAPTIVE) {
+      uchar *tmp = line + n + 1;
+      unsigned long best = 0;
+      for (int type = Fl_PNG_Options::FILTER_NONE; type <= Fl_PNG_Options::FILTER_PAETH; type++) {
+        png_filter_row(type, row, prev, n, job->d, tmp);
+        unsigned long cost = png_filter_cost(tmp, n);
+        if (type == Fl_PNG_Options::FILTER_NONE || cost < best) {
+          best = cost;
+          uchar *t = out; out = tmp; tmp = t;
+        }
+      }
+    } else {
+      png_filter_row(job->filter, row, prev, n, job->d, out);
+    }
+    band->adler = adler32(band->adler, out, (uInt)(n + 1));
+    band->length += n + 1;
+    zs.next_in = out;
+    zs.avail_in = (uInt)(n + 1);
+    int flush = (y + 1 < band->y + band->n ? Z_NO_FLUSH : (last ? Z_FINISH : Z_SYNC_FLUSH));
+    for (;;) {
+      if (band->size == alloc) {
+        unsigned char *data = (unsigned char *)realloc(band->data, alloc * 2);
+        if (!data) { free(band->data); band->data = NULL; break; }
+        band->data = data;
+        alloc *= 2;
+      }
+      zs.next_out = band->data + band->size;
+      zs.avail_out = (uInt)(alloc - band->size);
+      int ret = deflate(&zs, flush);
+      band->size = alloc - zs.avail_out;
+      if (ret == Z_STREAM_END || (zs.avail_out > 0 && zs.avail_in == 0 && ret != Z_STREAM_ERROR)) break;
+      if (ret == Z_STREAM_ERROR) { band->error = 1; break; }
+    }
+  }
+  if (!band->data) band->error = 1;
+  deflateEnd(&zs);
+  delete[] line;
+}
+
+static void png_run_bands(void *data) {
+  png_job *job = (png_job *)data;
+  int i;
+  while ((i = job->next++) < job->nbands)
+    png_compress_band(job, &job->bands[i]);
+}
+
+// Compresses bands of rows in parallel, with up to threads threads
+// including the calling one, and returns when all bands are done. Each
+// band is a separate deflate stream ending on a byte boundary, hence the
+// bands can be concatenated into one zlib stream. Returns the compressed
+// bands, to be written by png_write_bands(), or NULL if the image is too
+// small to be split.
+static png_job *png_compress_parallel(const uchar *pixels, int w, int h, int d, int ld,
+                                      int level, int filter, int strategy, int threads) {
+  // bands of at least 256 kB, and a few more bands than threads
+  size_t row_bytes = (size_t)w * d + 1;
+  int rows = (int)((256 * 1024 + row_bytes - 1) / row_bytes);
+  int nbands = (h + rows - 1) / rows;
+  if (nbands > 4 * threads) {
+    nbands = 4 * threads;
+    rows = (h + nbands - 1) / nbands;
+    nbands = (h + rows - 1) / rows;
+  }
+  if (nbands < 2) return NULL;
+
+  png_job *job = new png_job;
+  job->pixels = pixels;
+  job->w = w; job->h = h; job->d = d; job->ld = ld;
+  job->level = level; job->filter = filter; job->strategy = strategy;
+  job->nbands = nbands;
+  job->bands = new png_band[nbands];
+  memset(job->bands, 0, nbands * sizeof(png_band));
+  for (int i = 0; i < nbands; i++) {
+    job->bands[i].y = i * rows;
+    job->bands[i].n = (i + 1 < nbands ? rows : h - i * rows);
+  }
+  job->next = 0;
+  if (threads > nbands) threads = nbands;
+  void **workers = new void*[threads];
+  int nworkers = 0;
+  for (int i = 1; i < threads; i++) {
+    workers[nworkers] = Fl::system_driver()->start_joinable_thread(png_run_bands, job);
+    if (!workers[nworkers]) break;
+    nworkers++;
   }
+  png_run_bands(job); // the calling thread works too
+  for (int i = 0; i < nworkers; i++)
+    Fl::system_driver()->join_thread(workers[i]);
+  delete[] workers;
+  return job;
+}
 
+// Writes bands compressed by png_compress_parallel() as IDAT chunks,
+// followed by the IEND chunk.
+static void png_write_bands(png_structp pptr, png_job *job) {
+  // zlib header
+  int level = job->level;
+  int flevel = (level < 0 || level == 6 ? 2 : level < 2 ? 0 : level < 6 ? 1 : 3);
+  uchar header[2] = { 0x78, (uchar)(flevel << 6) };
+  header[1] += 31 - (header[0] * 256 + header[1]) % 31;
+  uLong adler = adler32(0L, Z_NULL, 0);
+  for (int i = 0; i < job->nbands; i++) {
+    png_band &b = job->bands[i];
+    adler = adler32_combine(adler, b.adler, (z_off_t)b.length);
+    if (i == 0) png_write_chunk(pptr, (png_const_bytep)"IDAT", header, 2);
+    png_write_chunk(pptr, (png_const_bytep)"IDAT", b.data, b.size);
+  }
+  uchar trailer[4] = { (uchar)(adler >> 24), (uchar)(adler >> 16), (uchar)(adler >> 8), (uchar)adler };
+  png_write_chunk(pptr, (png_const_bytep)"IDAT", trailer, 4);
+  png_write_chunk(pptr, (png_const_bytep)"IEND", NULL, 0);
+}
+
+// Writes a PNG image to a file or to memory. Returns 0 or an error code
+// of fl_write_png().
+static int png_write(png_output *out, const uchar *pixels, int w, int h, int d, int ld,
+                     const Fl_PNG_Options &options) {
+  int color_type;
   switch (d) {
     case 1:  color_type = PNG_COLOR_TYPE_GRAY;        break;
     case 2:  color_type = PNG_COLOR_TYPE_GRAY_ALPHA;  break;
     case 3:  color_type = PNG_COLOR_TYPE_RGB;         break;
     case 4:  color_type = PNG_COLOR_TYPE_RGB_ALPHA;   break;
-    default: color_type = PNG_COLOR_TYPE_RGB;
+    default: color_type = PNG_COLOR_TYPE_RGB; d = 3;
   }
 
   if (ld == 0)
     ld = w * d;
 
+  int level, filter, strategy;
+  png_resolve_options(options, level, filter, strategy);
+
+  // Bands are compressed before libpng is set up: all threads are done
+  // before anything can longjmp(), and job needn't be volatile.
+  png_job *job = NULL;
+  if (options.threads > 1) {
+    job = png_compress_parallel(pixels, w, h, d, ld, level, filter, strategy, options.threads);
+    int error = 0;
+    for (int i = 0; job && i < job->nbands; i++) error |= job->bands[i].error;
+    if (error) {
+      delete job;
+      return -3;
+    }
+  }
+
   png_structp pptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
+  if (!pptr) {
+    delete job;
+    return -3;
+  }
   png_infop iptr = png_create_info_struct(pptr);
-  png_bytep ptr = (png_bytep)pixels;
+  if (!iptr || setjmp(png_jmpbuf(pptr))) {
+    png_destroy_write_struct(&pptr, &iptr);
+    delete job;
+    return -3;
+  }
 
-  png_init_io(pptr, fp);
+  if (out->fp)
+    png_init_io(pptr, out->fp);
+  else
+    png_set_write_fn(pptr, out, png_write_data_to_mem, png_flush_mem);
   png_set_IHDR(pptr, iptr, w, h, 8,
                color_type,
                PNG_INTERLACE_NONE,
@@ -162,19 +435,125 @@ int fl_write_png(const char *filename, const char *pixels, int w, int h, int d,
   int dots_per_meter = (int)(dpi / (2.54 / 100.0));
   png_set_pHYs(pptr, iptr, dots_per_meter, dots_per_meter, PNG_RESOLUTION_METER);
 
+  static const int png_filters[] = {
+    PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH, PNG_ALL_FILTERS
+  };
+  png_set_filter(pptr, PNG_FILTER_TYPE_BASE, png_filters[filter]);
+  if (level >= 0) png_set_compression_level(pptr, level);
+  png_set_compression_strategy(pptr, strategy);
+
   png_write_info(pptr, iptr);
 
-  for (int i = 0; i < h; i++, ptr += ld) {
-    png_write_row(pptr, ptr);
+  if (job) {
+    png_write_bands(pptr, job);
+  } else {
+    png_bytep ptr = (png_bytep)pixels;
+    for (int i = 0; i < h; i++, ptr += ld) {
+      png_write_row(pptr, ptr);
+    }
+    png_write_end(pptr, iptr);
   }
-
-  png_write_end(pptr, iptr);
   png_destroy_write_struct(&pptr, &iptr);
-
-  fclose(fp);
+  delete job;
   return 0;
+}
 
+#endif // HAVE_LIBPNG && HAVE_LIBZ
+
+/**
+  Write an RGB(A) image to a PNG image file with the given options.
+
+  \param[in]  filename  Output filename, extension should be '.png'
+  \param[in]  img       RGB image to be written
+  \param[in]  options   compression options
+
+  \return     success (0) or error code, see
+              fl_write_png(const char *filename, const unsigned char *pixels, int w, int h, int d, int ld, const Fl_PNG_Options &options)
+
+  \version 1.5.0
+*/
+int fl_write_png(const char *filename, Fl_RGB_Image *img, const Fl_PNG_Options &options) {
+  return fl_write_png(filename,
+                      (const unsigned char *)img->data()[0],
+                      img->data_w(),
+                      img->data_h(),
+                      img->d(),
+                      img->ld(),
+                      options);
+}
+
+/**
+  Write raw image data to a PNG image file with the given options.
+
+  See Fl_PNG_Options for the compression options. Compressing with more
+  than one thread writes a valid PNG file that is slightly larger than
+  with one thread.
+
+  \param[in]  filename  Output filename, extension should be '.png'
+  \param[in]  pixels    Image data
+  \param[in]  w         Image data width
+  \param[in]  h         Image data height
+  \param[in]  d         Image depth: 1 = GRAY, 2 = GRAY + alpha, 3 = RGB, 4 = RGBA
+  \param[in]  ld        Line delta: 0 means w * d
+  \param[in]  options   compression options
+
+  \return     success (0) or error code: negative values are errors
+
+  \retval      0        success, file has been written
+  \retval     -1        png or zlib library not available
+  \retval     -2        file open error
+  \retval     -3        PNG encoding error
+
+  \see fl_encode_png()
+  \version 1.5.0
+*/
+int fl_write_png(const char *filename, const unsigned char *pixels, int w, int h, int d, int ld,
+                 const Fl_PNG_Options &options) {
+#if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
+  png_output out;
+  memset(&out, 0, sizeof(out));
+  if ((out.fp = fl_fopen(filename, "wb")) == NULL) {
+    return -2;
+  }
+  int ret = png_write(&out, pixels, w, h, d, ld, options);
+  fclose(out.fp);
+  return ret;
 #else
   return -1;
 #endif
 }
+
+/**
+  Encode raw image data as a PNG image in memory.
+
+  \param[in]  pixels    Image data
+  \param[in]  w         Image data width
+  \param[in]  h         Image data height
+  \param[in]  d         Image depth: 1 = GRAY, 2 = GRAY + alpha, 3 = RGB, 4 = RGBA
+  \param[in]  ld        Line delta: 0 means w * d
+  \param[out] size      size of the PNG image in bytes
+  \param[in]  options   compression options, NULL for the defaults
+
+  \return     the PNG image, to be released with free(), or NULL if PNG
+              support is not available or encoding failed
+
+  \see fl_write_png(const char *filename, const unsigned char *pixels, int w, int h, int d, int ld, const Fl_PNG_Options &options)
+  \version 1.5.0
+*/
+unsigned char *fl_encode_png(const unsigned char *pixels, int w, int h, int d, int ld,
+                             size_t *size, const Fl_PNG_Options *options) {
+  *size = 0;
+#if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
+  png_output out;
+  memset(&out, 0, sizeof(out));
+  if (png_write(&out, pixels, w, h, d, ld, options ? *options : Fl_PNG_Options()) != 0) {
+    free(out.buffer);
+    return NULL;
+  }
+  *size = out.size;
+  return out.buffer;
+#else
+  (void)pixels; (void)w; (void)h; (void)d; (void)ld; (void)options;
+  return NULL;
+#endif
+}
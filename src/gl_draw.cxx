@@ -1,7 +1,7 @@
 //
 // OpenGL text drawing support routines for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2021 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -41,11 +41,16 @@
 #include "Fl_Gl_Window_Driver.H"
 #include <FL/Fl_Image_Surface.H>
 #include "Fl_Scalable_Graphics_Driver.H" // Fl_Font_Descriptor
+#include "drivers/OpenGL/Fl_OpenGL_Display_Device.H"
+#include "drivers/OpenGL/Fl_OpenGL_Graphics_Driver.H"
 #if HAVE_GL_GLU_H
 #  include <FL/glu.h>  // for gluUnProject()
 #endif
 #include <FL/glut.H> // for glutStrokeString() and glutStrokeLength()
+#include <FL/fl_utf8.h>
 #include <stdlib.h>
+#include <map>
+#include <vector>
 
 #ifndef GL_TEXTURE_RECTANGLE_ARB
 #  define GL_TEXTURE_RECTANGLE_ARB 0x84F5
@@ -68,6 +73,14 @@ static int has_texture_rectangle = 0; // true means GL_EXT_texture_rectangle is
 
 extern float gl_start_scale; // in gl_start.cxx
 
+// Draws what the fl_xxx() functions have collected when called between
+// gl_shape_batch_begin() and gl_shape_batch_end(), so it's below what comes next.
+static void flush_fl_draw() {
+  Fl_Surface_Device *surface = Fl_Surface_Device::surface();
+  if (surface == Fl_OpenGL_Display_Device::display_device())
+    ((Fl_OpenGL_Graphics_Driver*)surface->driver())->flush_batch();
+}
+
 /**
   Sets the current OpenGL font to the same font as calling fl_font().
  \see Fl::draw_GL_text_with_textures(int val)
@@ -138,6 +151,7 @@ void gl_remove_displaylist_fonts()
   */
 void gl_draw(const char* str, int n) {
   if (n > 0) {
+    flush_fl_draw();
     if (has_texture_rectangle)  Fl_Gl_Window_Driver::draw_string_with_texture(str, n);
     else Fl_Gl_Window_Driver::global()->draw_string_legacy(str, n);
   }
@@ -217,6 +231,7 @@ void gl_measure(const char* str, int& x, int& y) {
 void gl_rect(int x, int y, int w, int h) {
   if (w < 0) {w = -w; x = x-w;}
   if (h < 0) {h = -h; y = y-h;}
+  flush_fl_draw();
   glBegin(GL_LINE_LOOP);
   int r = x+w-1, b = y+h-1;
   glVertex2i(r, b);
@@ -231,11 +246,13 @@ void gl_rect(int x, int y, int w, int h) {
   \see gl_rect(int x, int y, int w, int h)
   */
 void gl_rectf(int x,int y,int w,int h) {
+  flush_fl_draw();
   glRecti(x,y,x+w,y+h);
 }
 
 void gl_draw_image(const uchar* b, int x, int y, int w, int h, int d, int ld) {
   if (!ld) ld = w*d;
+  flush_fl_draw();
   GLint row_length;
   glGetIntegerv(GL_UNPACK_ROW_LENGTH, &row_length); // get current row length
   glPixelStorei(GL_UNPACK_ROW_LENGTH, ld/d);
@@ -330,6 +347,8 @@ int gl_texture_fifo::already_known(const char *str, int n)
 
 static gl_texture_fifo *gl_fifo = NULL; // points to the texture pile class instance
 
+static void set_raster_pos(const GLfloat *pos);
+
 
 // Cross-platform implementation of the texture mechanism for text rendering
 // using textures with the alpha channel only.
@@ -389,9 +408,16 @@ void gl_texture_fifo::display_texture(int rank)
   glMatrixMode (GL_PROJECTION);
   glPopMatrix();
   glPopAttrib(); // GL_TRANSFORM_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT
-#if HAVE_GL_GLU_H
   //set the raster position to end of string
   pos[0] += width;
+  set_raster_pos(pos);
+} // display_texture
+
+
+// sets the raster position from window coordinates
+static void set_raster_pos(const GLfloat *pos)
+{
+#if HAVE_GL_GLU_H
   GLdouble modelmat[16];
   glGetDoublev (GL_MODELVIEW_MATRIX, modelmat);
   GLdouble projmat[16];
@@ -407,7 +433,7 @@ void gl_texture_fifo::display_texture(int rank)
   }
   glRasterPos2d(objX, objY);
 #endif // HAVE_GL_GLU_H
-} // display_texture
+}
 
 
 // pre-computes a string texture
@@ -459,6 +485,329 @@ int gl_texture_fifo::compute_texture(const char* str, int n)
   return current;
 }
 
+/* Implement the glyph atlas mechanism:
+ For each GL context, font and GUI scale, the images of individual glyphs are computed
+ once and packed into a single large texture, the atlas.
+ Strings made only of such glyphs are drawn as a series of textured quads
+ taken from the atlas, spaced by the advance of each glyph and the kerning
+ of each pair of characters. Strings that change often (e.g., numbers) thus don't
+ need a texture of their own, and several strings can be sent to the GPU
+ in a single draw call (see gl_text_batch_begin()).
+ Strings with characters that may combine with others or need shaping
+ are drawn with the gl_texture_fifo.
+*/
+
+// a texture containing pre-computed glyph images for a font and a GUI scale
+class gl_glyph_atlas {
+public:
+  struct glyph {
+    int x, y; // position of the glyph image in the texture
+    int w; // width of the glyph image
+    int left; // width of the part of the image left of the glyph origin
+    float advance; // distance to the next glyph
+  };
+  enum { size = 1024 }; // width and height of the texture
+  GLContext context; // the GL context the texture belongs to
+  Fl_Font_Descriptor *fdesc; // its font
+  float scale; // scaling factor of the GUI
+  GLuint texName;
+  int h; // height of all glyph images
+  int pen_x, pen_y; // where the next glyph image goes in the texture
+  std::map<unsigned, glyph> glyphs;
+  std::map<unsigned long long, float> kernings; // kerning of pairs of characters
+  // textured quads not yet sent to the GPU, they are drawn in the atlas' context
+  float winw, winh; // size of the GL scene for these quads
+  std::vector<GLfloat> vertices; // 2 per vertex, in window coordinates
+  std::vector<GLfloat> texcoords; // 2 per vertex
+  std::vector<GLfloat> colors; // 4 per vertex
+  gl_glyph_atlas *next;
+  gl_glyph_atlas(GLContext ctx, Fl_Font_Descriptor *fd, float s, gl_glyph_atlas *n);
+  ~gl_glyph_atlas();
+  const glyph *find(unsigned ucs);
+  float kerning(unsigned left, unsigned right);
+  void clear();
+  void add(float x, float y, const glyph *g, const GLfloat *color);
+  void flush();
+};
+
+static gl_glyph_atlas *gl_atlases = NULL; // the list of all atlases
+static int gl_text_batch_level = 0; // > 0 between gl_text_batch_begin() and gl_text_batch_end()
+static GLContext gl_text_batch_context = 0; // the context of quads not yet drawn, if any
+
+// the GL context gl_draw() draws into
+static GLContext current_gl_context()
+{
+  Fl_Gl_Window *glw = Fl_Window::current()->as_gl_window();
+  return glw ? glw->context() : Fl_Gl_Window_Driver::gl_start_context;
+}
+
+gl_glyph_atlas::gl_glyph_atlas(GLContext ctx, Fl_Font_Descriptor *fd, float s, gl_glyph_atlas *n)
+{
+  context = ctx;
+  fdesc = fd;
+  scale = s;
+  next = n;
+  pen_x = pen_y = 0;
+  winw = winh = 0;
+  Fl_Fontsize fs = fl_size();
+  float gs = fl_graphics_driver->scale();
+  fl_graphics_driver->Fl_Graphics_Driver::scale(1); // temporarily remove scaling factor
+  fl_font(fl_font(), int(fs * scale)); // the font size to use in the GL scene
+  h = fl_height();
+  fl_graphics_driver->Fl_Graphics_Driver::scale(gs); // re-install scaling factor
+  fl_font(fl_font(), fs);
+  // the texture starts fully transparent so that no glyph picks up garbage from its neighbours
+  uchar *zero = (uchar*)calloc(size * size, 1);
+  GLint alignment;
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+  glGenTextures(1, &texName);
+  glPushAttrib(GL_TEXTURE_BIT);
+  glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texName);
+  glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_ALPHA8, size, size, 0, GL_ALPHA, GL_UNSIGNED_BYTE, zero);
+  glPopAttrib();
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  free(zero);
+}
+
+// texName is 0 when the context is gone, and its textures with it
+gl_glyph_atlas::~gl_glyph_atlas()
+{
+  if (texName) glDeleteTextures(1, &texName);
+}
+
+// forgets all glyphs, their images will be overwritten by new ones
+void gl_glyph_atlas::clear()
+{
+  glyphs.clear();
+  pen_x = pen_y = 0;
+}
+
+// returns the glyph for a character, computing its image if necessary,
+// or NULL when the texture is full
+const gl_glyph_atlas::glyph *gl_glyph_atlas::find(unsigned ucs)
+{
+  std::map<unsigned, glyph>::iterator it = glyphs.find(ucs);
+  if (it != glyphs.end()) return &it->second;
+  char buf[4];
+  int l = fl_utf8encode(ucs, buf);
+  Fl_Fontsize fs = fl_size();
+  float gs = fl_graphics_driver->scale();
+  fl_graphics_driver->Fl_Graphics_Driver::scale(1); // temporarily remove scaling factor
+  fl_font(fl_font(), int(fs * scale));
+  glyph g;
+  g.advance = (float)fl_width(buf, l);
+  // the image covers the ink of the glyph, which may begin left of its origin
+  // (negative left bearing) and end beyond its advance (e.g., italics),
+  // with one more pixel on each side for antialiasing
+  int dx, dy, ink_w, ink_h;
+  fl_text_extents(buf, l, dx, dy, ink_w, ink_h);
+  int right = (int)ceil(g.advance);
+  if (ink_w > 0 && dx + ink_w > right) right = dx + ink_w;
+  g.left = (ink_w > 0 && dx < 0 ? -dx : 0) + 1;
+  g.w = g.left + right + 1;
+  fl_graphics_driver->Fl_Graphics_Driver::scale(gs); // re-install scaling factor
+  fl_font(fl_font(), fs);
+  if (g.w > size) return NULL;
+  if (pen_x + g.w > size) { // start a new row of glyphs
+    pen_x = 0;
+    pen_y += h + 1;
+  }
+  if (pen_y + h > size) return NULL;
+  g.x = pen_x;
+  g.y = pen_y;
+  pen_x += g.w + 1;
+  char *alpha_buf = Fl_Gl_Window_Driver::global()->alpha_mask_for_string(buf, l, g.w, h, int(fs * scale), g.left);
+  GLint row_length, alignment;
+  glGetIntegerv(GL_UNPACK_ROW_LENGTH, &row_length);
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+  glPushAttrib(GL_TEXTURE_BIT);
+  glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texName);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, g.w);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, g.x, g.y, g.w, h, GL_ALPHA, GL_UNSIGNED_BYTE, alpha_buf);
+  glPopAttrib();
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  delete[] alpha_buf;
+  return &(glyphs[ucs] = g);
+}
+
+// returns how much closer than their advances two characters are drawn
+// side by side by the font (positive for pairs like "AV")
+float gl_glyph_atlas::kerning(unsigned left, unsigned right)
+{
+  unsigned long long key = ((unsigned long long)left << 32) | right;
+  std::map<unsigned long long, float>::iterator it = kernings.find(key);
+  if (it != kernings.end()) return it->second;
+  char buf[8];
+  int l = fl_utf8encode(left, buf);
+  int r = fl_utf8encode(right, buf + l);
+  Fl_Fontsize fs = fl_size();
+  float gs = fl_graphics_driver->scale();
+  fl_graphics_driver->Fl_Graphics_Driver::scale(1); // temporarily remove scaling factor
+  fl_font(fl_font(), int(fs * scale));
+  float k = float(fl_width(buf, l) + fl_width(buf + l, r) - fl_width(buf, l + r));
+  fl_graphics_driver->Fl_Graphics_Driver::scale(gs); // re-install scaling factor
+  fl_font(fl_font(), fs);
+  return kernings[key] = k;
+}
+
+void gl_glyph_atlas::add(float x, float y, const glyph *g, const GLfloat *color)
+{
+  x -= g->left;
+  GLfloat v[8] = { x, y,  x, y - h,  x + g->w, y - h,  x + g->w, y };
+  GLfloat t[8] = { (GLfloat)g->x, (GLfloat)g->y,  (GLfloat)g->x, (GLfloat)(g->y + h),
+    (GLfloat)(g->x + g->w), (GLfloat)(g->y + h),  (GLfloat)(g->x + g->w), (GLfloat)g->y };
+  vertices.insert(vertices.end(), v, v + 8);
+  texcoords.insert(texcoords.end(), t, t + 8);
+  for (int i = 0; i < 4; i++) colors.insert(colors.end(), color, color + 4);
+}
+
+// draws all collected quads with a single glDrawArrays() call,
+// the atlas' context must be the current one
+void gl_glyph_atlas::flush()
+{
+  if (vertices.empty()) return;
+  // GL_CURRENT_BIT because the current color is undefined after using a color array
+  glPushAttrib(GL_TRANSFORM_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glMatrixMode (GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity ();
+  glMatrixMode (GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity ();
+  glDisable (GL_DEPTH_TEST);
+  glEnable (GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glDisable(GL_LIGHTING);
+  float R = 2;
+  glScalef (R/winw, R/winh, 1.0f);
+  glTranslatef (-winw/R, -winh/R, 0.0f);
+  glEnable (GL_TEXTURE_RECTANGLE_ARB);
+  glBindTexture (GL_TEXTURE_RECTANGLE_ARB, texName);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 0, &vertices[0]);
+  glTexCoordPointer(2, GL_FLOAT, 0, &texcoords[0]);
+  glColorPointer(4, GL_FLOAT, 0, &colors[0]);
+  glDrawArrays(GL_QUADS, 0, GLsizei(vertices.size() / 2));
+  glPopMatrix(); // GL_MODELVIEW
+  glMatrixMode (GL_PROJECTION);
+  glPopMatrix();
+  glPopClientAttrib();
+  glPopAttrib();
+  vertices.clear();
+  texcoords.clear();
+  colors.clear();
+}
+
+// draws the quads collected for the atlases of a GL context, which must be current
+static void flush_glyph_atlases(GLContext context)
+{
+  for (gl_glyph_atlas *atlas = gl_atlases; atlas; atlas = atlas->next) {
+    if (atlas->context == context) atlas->flush();
+  }
+  if (gl_text_batch_context == context) gl_text_batch_context = 0;
+}
+
+// called before another GL context becomes current: the quads collected so far
+// are drawn while their own context is still the current one
+void Fl_Gl_Window_Driver::flush_glyph_atlases(GLContext next)
+{
+  if (gl_text_batch_context && gl_text_batch_context != next)
+    ::flush_glyph_atlases(gl_text_batch_context);
+}
+
+
+// draws a utf8 string with glyphs from the atlas of the current font,
+// returns 0 when the string contains characters the atlas does not handle
+static int draw_string_with_atlas(const char *str, int n)
+{
+  // only characters that can't combine with their neighbours
+  std::vector<unsigned> text;
+  const char *end = str + n;
+  for (const char *p = str; p < end; ) {
+    int l;
+    unsigned ucs = fl_utf8decode(p, end, &l);
+    if (ucs < 0x20 || ucs >= 0x300) return 0;
+    text.push_back(ucs);
+    p += l;
+  }
+  float scale = Fl_Gl_Window_Driver::gl_scale;
+  GLContext context = current_gl_context();
+  gl_glyph_atlas *atlas;
+  for (atlas = gl_atlases; atlas; atlas = atlas->next) {
+    if (atlas->context == context && atlas->fdesc == gl_fontsize && atlas->scale == scale) break;
+  }
+  if (!atlas) atlas = gl_atlases = new gl_glyph_atlas(context, gl_fontsize, scale, gl_atlases);
+  std::vector<const gl_glyph_atlas::glyph*> glyphs(text.size());
+  for (int pass = 0; pass < 2; pass++) {
+    size_t i;
+    for (i = 0; i < text.size(); i++) {
+      if (!(glyphs[i] = atlas->find(text[i]))) break;
+    }
+    if (i == text.size()) break;
+    if (pass == 1) return 0; // the string does not fit in an empty atlas
+    // the atlas is full: draw what uses it now, then reuse it from scratch
+    atlas->flush();
+    atlas->clear();
+  }
+  float winw = scale * Fl_Window::current()->w();
+  float winh = scale * Fl_Window::current()->h();
+  if (atlas->winw != winw || atlas->winh != winh) {
+    atlas->flush();
+    atlas->winw = winw;
+    atlas->winh = winh;
+  }
+  GLfloat pos[4], color[4];
+  glGetFloatv(GL_CURRENT_RASTER_POSITION, pos);
+  glGetFloatv(GL_CURRENT_COLOR, color);
+  if (gl_start_scale != 1) { // using gl_start() / gl_finish()
+    pos[0] /= gl_start_scale;
+    pos[1] /= gl_start_scale;
+  }
+  float x = pos[0];
+  float y = pos[1] + atlas->h - scale * fl_descent();
+  for (size_t i = 0; i < glyphs.size(); i++) {
+    if (i > 0) x -= atlas->kerning(text[i - 1], text[i]);
+    // glyph images are put on whole pixels to keep them sharp
+    atlas->add(floorf(x + 0.5f), floorf(y + 0.5f), glyphs[i], color);
+    x += glyphs[i]->advance;
+  }
+  if (gl_text_batch_level) gl_text_batch_context = context;
+  else atlas->flush();
+  pos[0] = x;
+  set_raster_pos(pos);
+  return 1;
+}
+
+// deletes the atlases of a GL context, or of the current one when context is NULL;
+// when the context is already destroyed, only memory is freed
+static void remove_glyph_atlases(GLContext context, bool destroyed)
+{
+  if (!context) context = current_gl_context();
+  if (gl_text_batch_context == context) gl_text_batch_context = 0;
+  gl_glyph_atlas **p = &gl_atlases;
+  while (*p) {
+    gl_glyph_atlas *atlas = *p;
+    if (atlas->context == context) {
+      *p = atlas->next;
+      if (destroyed) atlas->texName = 0;
+      delete atlas;
+    } else p = &atlas->next;
+  }
+}
+
+// called when a GL context is destroyed
+void Fl_Gl_Window_Driver::remove_glyph_atlases(GLContext ctx)
+{
+  ::remove_glyph_atlases(ctx, true);
+}
+
 #endif  // ! defined(FL_DOXYGEN)
 
 /**
@@ -478,6 +827,74 @@ int gl_texture_pile_height(void)
 void gl_texture_reset()
 {
   if (gl_fifo) gl_texture_pile_height(gl_texture_pile_height());
+  if (Fl_Window::current()) remove_glyph_atlases(NULL, false);
+}
+
+
+/**
+ Starts collecting text drawn by gl_draw() to send it to the GPU all at once.
+
+ Strings made of characters that don't combine with their neighbours are drawn
+ with glyph images shared in a texture for each font and size.
+ Between gl_text_batch_begin() and gl_text_batch_end(), such strings are not
+ drawn immediately but collected, and are all drawn by gl_text_batch_end()
+ with a single draw call. This is much faster when many strings are drawn,
+ e.g. labels of a graph. Calls can be nested.
+
+ Because the strings are drawn late, they appear above whatever GL primitives
+ are drawn between both calls, and other GL state (e.g., the viewport) should not
+ be changed meanwhile. Strings with other characters are still drawn immediately.
+ Strings collected in an Fl_Gl_Window are drawn at the latest when another
+ window's GL context becomes current.
+ \see gl_text_batch_end()
+ \version 1.5.0
+ */
+void gl_text_batch_begin()
+{
+  gl_text_batch_level++;
+}
+
+/**
+ Draws all text collected since gl_text_batch_begin().
+ \see gl_text_batch_begin()
+ \version 1.5.0
+ */
+void gl_text_batch_end()
+{
+  if (gl_text_batch_level > 0 && --gl_text_batch_level == 0 && gl_text_batch_context)
+    flush_glyph_atlases(gl_text_batch_context);
+}
+
+/**
+ Starts collecting points, lines and filled shapes drawn by fl_xxx() functions
+ in an Fl_Gl_Window to send them to the GPU in few draw calls.
+
+ Outside of gl_shape_batch_begin() and gl_shape_batch_end(), each such primitive
+ is sent to OpenGL when it's drawn. Between them, the primitives are collected
+ and drawn when text, an image or a \c gl_xxx() function is drawn, when the clip
+ or line style changes, and at the latest by gl_shape_batch_end() or
+ Fl_Gl_Window::draw_end(). This is much faster when many primitives are drawn,
+ but direct GL calls made meanwhile may end up below them. Calls can be nested.
+ \see gl_shape_batch_end()
+ \version 1.5.0
+ */
+void gl_shape_batch_begin()
+{
+  Fl_Surface_Device *surface = Fl_Surface_Device::surface();
+  if (surface == Fl_OpenGL_Display_Device::display_device())
+    ((Fl_OpenGL_Graphics_Driver*)surface->driver())->batch_begin();
+}
+
+/**
+ Draws all points, lines and filled shapes collected since gl_shape_batch_begin().
+ \see gl_shape_batch_begin()
+ \version 1.5.0
+ */
+void gl_shape_batch_end()
+{
+  Fl_Surface_Device *surface = Fl_Surface_Device::surface();
+  if (surface == Fl_OpenGL_Display_Device::display_device())
+    ((Fl_OpenGL_Graphics_Driver*)surface->driver())->batch_end();
 }
 
 
@@ -518,6 +935,7 @@ void Fl_Gl_Window_Driver::draw_string_with_texture(const char* str, int n)
   if (!valid) return;
   Fl_Gl_Window *gwin = Fl_Window::current()->as_gl_window();
   gl_scale = (gwin ? gwin->pixels_per_unit() : 1);
+  if (draw_string_with_atlas(str, n)) return;
   if (!gl_fifo) gl_fifo = new gl_texture_fifo();
   if (!gl_fifo->textures_generated) {
     if (has_texture_rectangle) for (int i = 0; i < gl_fifo->size_; i++) glGenTextures(1, &(gl_fifo->fifo[i].texName));
@@ -531,7 +949,7 @@ void Fl_Gl_Window_Driver::draw_string_with_texture(const char* str, int n)
 }
 
 
-char *Fl_Gl_Window_Driver::alpha_mask_for_string(const char *str, int n, int w, int h, Fl_Fontsize fs)
+char *Fl_Gl_Window_Driver::alpha_mask_for_string(const char *str, int n, int w, int h, Fl_Fontsize fs, int x)
 {
   // write str to a bitmap that is just big enough
   // create an Fl_Image_Surface object
@@ -548,7 +966,7 @@ char *Fl_Gl_Window_Driver::alpha_mask_for_string(const char *str, int n, int w,
   fl_font (fnt, fs); // resize "fltk" font to current GL view scaling
   int desc = fl_descent();
   // Render the text to the buffer
-  fl_draw(str, n, 0, h - desc);
+  fl_draw(str, n, x, h - desc);
   // get the resulting image
   Fl_RGB_Image* image = image_surface->image();
   // direct graphics requests back to previous state
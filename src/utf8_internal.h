@@ -1,7 +1,7 @@
 /*
  * Internal UTF-8 header file for the Fast Light Tool Kit (FLTK).
  *
- * Copyright 1998-2016 by Bill Spitzak and others.
+ * Copyright 1998-2026 by Bill Spitzak and others.
  *
  * This library is free software. Distribution and use rights are outlined in
  * the file "COPYING" which should have been included with this file.  If this
@@ -48,6 +48,12 @@ int
 XUtf8Toupper(
         int ucs);
 
+/* returns a pointer to the first non-ASCII byte in [p, end), or end */
+const char *
+fl_utf8_skip_ascii_(
+        const char *p,
+        const char *end);
+
 
 #  ifdef __cplusplus
 }
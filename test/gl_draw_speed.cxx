@@ -0,0 +1,109 @@
+//
+// Speed test of FLTK drawing functions in an OpenGL window
+// for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Draws a plot made of many points and lines and a chart made of many
+// rectangles with fl_point(), fl_line() and fl_rectf() in an Fl_Gl_Window,
+// and prints how long each kind of primitive takes per frame.
+//
+// Usage: gl_draw_speed [points [rectangles [frames]]]
+//
+// To measure with Mesa's software renderer on Linux, run:
+//   LIBGL_ALWAYS_SOFTWARE=1 gl_draw_speed
+
+#include <FL/Fl.H>
+#include <FL/Fl_Gl_Window.H>
+#include <FL/fl_draw.H>
+#include <FL/gl.h>
+#include <FL/math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int n_points = 200000;
+static int n_rects = 20000;
+static int n_frames = 20;
+
+class Speed_Window : public Fl_Gl_Window {
+  int frame;
+  double t_points, t_lines, t_rects; // accumulated seconds
+public:
+  Speed_Window(int W, int H, const char *L) : Fl_Gl_Window(W, H, L) {
+    frame = 0;
+    t_points = t_lines = t_rects = 0;
+  }
+  void draw() override {
+    glClearColor(1, 1, 1, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glFinish();
+    draw_begin();
+    gl_shape_batch_begin();
+    Fl_Timestamp start = Fl::now();
+    // a sine plot made of points
+    fl_color(FL_BLUE);
+    for (int i = 0; i < n_points; i++) {
+      int x = i % w();
+      fl_point(x, h() / 4 + int((h() / 5) * sin(x * 0.05 + i / w())));
+    }
+    fl_push_clip(0, 0, w(), h()); // a clip change sends collected primitives to GL
+    fl_pop_clip();
+    glFinish();
+    t_points += Fl::seconds_since(start);
+    // the same plot made of line segments
+    start = Fl::now();
+    fl_color(FL_DARK_GREEN);
+    for (int i = 0; i < n_points; i++) {
+      int x = i % w();
+      fl_line(x, h() / 2 + int((h() / 5) * sin(x * 0.05)),
+              x + 1, h() / 2 + int((h() / 5) * sin((x + 1) * 0.05)));
+    }
+    fl_push_clip(0, 0, w(), h());
+    fl_pop_clip();
+    glFinish();
+    t_lines += Fl::seconds_since(start);
+    // a bar chart with many colors
+    start = Fl::now();
+    for (int i = 0; i < n_rects; i++) {
+      int x = (i * 3) % w();
+      int bh = 10 + (i * 7) % (h() / 4);
+      fl_color(fl_rgb_color(uchar(i * 5), uchar(i * 11), uchar(i * 17)));
+      fl_rectf(x, h() - bh, 3, bh);
+    }
+    gl_shape_batch_end();
+    draw_end();
+    glFinish();
+    t_rects += Fl::seconds_since(start);
+    if (++frame == n_frames) {
+      printf("%d frames of %dx%d pixels, average time per frame:\n", n_frames, pixel_w(), pixel_h());
+      printf("  %7d fl_point():  %8.2f ms\n", n_points, 1000 * t_points / n_frames);
+      printf("  %7d fl_line():   %8.2f ms\n", n_points, 1000 * t_lines / n_frames);
+      printf("  %7d fl_rectf():  %8.2f ms\n", n_rects, 1000 * t_rects / n_frames);
+      hide();
+    } else {
+      redraw();
+    }
+  }
+};
+
+int main(int argc, char **argv) {
+  if (argc > 1) n_points = atoi(argv[1]);
+  if (argc > 2) n_rects = atoi(argv[2]);
+  if (argc > 3) n_frames = atoi(argv[3]);
+  if (n_frames < 1) n_frames = 1;
+  Speed_Window *win = new Speed_Window(800, 600, "FLTK drawing speed in OpenGL");
+  win->mode(FL_RGB | FL_DOUBLE);
+  win->show();
+  return Fl::run();
+}
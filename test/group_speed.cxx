@@ -0,0 +1,105 @@
+//
+// Speed test of mouse event routing in large groups
+// for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Fills a group with a grid of many small widgets, then sends it mouse
+// move and push events at many positions, with and without the spatial
+// index of Fl_Group, and prints how long this takes. It also checks that
+// events reach the same widgets in both cases. This program doesn't
+// open a window.
+//
+// Usage: group_speed [children [events]]
+
+#include <FL/Fl.H>
+#include <FL/Fl_Window.H>
+#include <FL/Fl_Box.H>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int n_children = 50000;
+static int n_events = 5000;
+
+// A box that remembers the last widget that got FL_PUSH
+class Target : public Fl_Box {
+public:
+  static Fl_Widget *pushed;
+  Target(int X, int Y, int W, int H, int n) : Fl_Box(X, Y, W, H) { user_data(fl_voidptr(n)); }
+  int handle(int event) override {
+    if (event == FL_PUSH) { pushed = this; return 1; }
+    return Fl_Box::handle(event);
+  }
+};
+
+Fl_Widget *Target::pushed = NULL;
+
+// Sends events at the same pseudo-random positions on each call.
+// Returns a checksum of the widgets that got the events.
+static unsigned long send_events(Fl_Group *group, int event, int W, int H) {
+  unsigned seed = 12345;
+  unsigned long sum = 0;
+  for (int i = 0; i < n_events; i++) {
+    seed = seed * 1103515245u + 12345u;
+    Fl::e_x = int((seed >> 8) % unsigned(W));
+    seed = seed * 1103515245u + 12345u;
+    Fl::e_y = int((seed >> 8) % unsigned(H));
+    Target::pushed = NULL;
+    group->handle(event);
+    Fl_Widget *w = (event == FL_PUSH ? Target::pushed : Fl::belowmouse());
+    sum = sum * 31 + (w ? (unsigned long)fl_int(w->user_data()) : 0);
+  }
+  return sum;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) n_children = atoi(argv[1]);
+  if (argc > 2) n_events = atoi(argv[2]);
+  if (n_children < 1) n_children = 1;
+  int cols = 250, size = 20;
+  int rows = (n_children + cols - 1) / cols;
+  int W = cols * size, H = rows * size;
+
+  Fl_Window *win = new Fl_Window(W, H, "group_speed");
+  Fl_Group *group = new Fl_Group(0, 0, W, H);
+  for (int i = 0; i < n_children; i++)
+    new Target((i % cols) * size, (i / cols) * size, size - 2, size - 2, i + 1);
+  group->end();
+  win->end();
+
+  printf("%d children, %d events of each kind:\n", n_children, n_events);
+  unsigned long sums[2][2];
+  for (int indexed = 0; indexed < 2; indexed++) {
+    group->spatial_index(indexed);
+    if (indexed) { // the first event builds the index
+      Fl_Timestamp start = Fl::now();
+      Fl::e_x = Fl::e_y = 0;
+      group->handle(FL_MOVE);
+      printf("  building the index:       %9.2f ms\n", 1000 * Fl::seconds_since(start));
+    }
+    const char *name = indexed ? "with index" : "without index";
+    Fl_Timestamp start = Fl::now();
+    sums[indexed][0] = send_events(group, FL_MOVE, W, H);
+    printf("  FL_MOVE, %-16s %9.2f ms\n", name, 1000 * Fl::seconds_since(start));
+    start = Fl::now();
+    sums[indexed][1] = send_events(group, FL_PUSH, W, H);
+    printf("  FL_PUSH, %-16s %9.2f ms\n", name, 1000 * Fl::seconds_since(start));
+  }
+  if (sums[0][0] != sums[1][0] || sums[0][1] != sums[1][1]) {
+    printf("Error: events reached different widgets with the index\n");
+    return 1;
+  }
+  delete win;
+  return 0;
+}
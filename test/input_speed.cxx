@@ -0,0 +1,129 @@
+//
+// Speed test of typing into a large Fl_Multiline_Input
+// for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Types characters into an Fl_Multiline_Input holding about 100 KB of text,
+// at the end, in the middle, and with word wrap, and draws the widget into
+// an Fl_Image_Surface after each keystroke, once with the damage left by the
+// edit and once redrawing the whole widget for comparison. Prints the mean
+// time per keystroke. The program doesn't open a window, but it needs a
+// display connection: under X11 without a screen, run it with xvfb-run.
+//
+// Usage: input_speed [-k keystrokes] [-s size]
+
+#include <FL/Fl.H>
+#include <FL/platform.H>        // fl_open_display()
+#include <FL/Fl_Window.H>
+#include <FL/Fl_Image_Surface.H>
+#include <FL/Fl_Multiline_Input.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int W = 600, H = 400;  // size of the widget
+static int n_keys = 500;
+static int text_size = 100000;
+
+// Makes draw() accessible
+class Test_Input : public Fl_Multiline_Input {
+public:
+  Test_Input(int X, int Y, int W, int H) : Fl_Multiline_Input(X, Y, W, H) {}
+  void draw() override { Fl_Multiline_Input::draw(); }
+};
+
+static char *make_text(int size) {
+  static const char *words[] = { "the ", "quick ", "brown ", "fox ", "jumps ",
+    "over ", "lazy ", "dog ", "and ", "keeps ", "running ", "away " };
+  char *text = new char[size + 1];
+  unsigned seed = 1;
+  int n = 0, col = 0;
+  while (n < size) {
+    seed = seed * 1103515245u + 12345u;
+    const char *w = words[(seed >> 8) % 12u];
+    int len = (int)strlen(w);
+    if (col + len > 70 || n + len >= size) {
+      text[n++] = '\n';
+      col = 0;
+      continue;
+    }
+    memcpy(text + n, w, len);
+    n += len;
+    col += len;
+  }
+  text[size] = 0;
+  return text;
+}
+
+// Types n_keys characters at position pos, or at the end if pos < 0, and
+// draws the widget after each one. Returns the mean time in ms.
+static double type(Test_Input *in, const char *text, int pos, bool redraw_all) {
+  in->value(text);
+  in->damage(FL_DAMAGE_ALL);
+  in->draw();
+  in->clear_damage();
+  int p = pos < 0 ? in->size() : pos;
+  in->insert_position(p);
+  Fl_Timestamp start = Fl::now();
+  for (int i = 0; i < n_keys; i++) {
+    in->insert(i % 40 == 39 ? " " : "x", 1);
+    if (redraw_all) in->damage(FL_DAMAGE_ALL);
+    in->draw();
+    in->clear_damage();
+  }
+  return 1000 * Fl::seconds_since(start) / n_keys;
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-k") && i + 1 < argc) n_keys = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-s") && i + 1 < argc) text_size = atoi(argv[++i]);
+    else {
+      fprintf(stderr, "Usage: %s [-k keystrokes] [-s size]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (n_keys < 1) n_keys = 1;
+  if (text_size < 1) text_size = 1;
+
+  fl_open_display();
+  Fl_Window *holder = new Fl_Window(W, H, "input_speed");
+  Test_Input *in = new Test_Input(0, 0, W, H);
+  in->maximum_size(text_size + n_keys + 1);
+  holder->end();
+  char *text = make_text(text_size);
+  Fl_Image_Surface *surf = new Fl_Image_Surface(W, H);
+  Fl_Surface_Device::push_current(surf);
+
+  printf("%d bytes of text, mean of %d keystrokes:\n", text_size, n_keys);
+  static const struct { const char *name; int type; bool middle; } cases[] = {
+    { "at the end",              FL_MULTILINE_INPUT,      false },
+    { "in the middle",           FL_MULTILINE_INPUT,      true  },
+    { "in the middle, wrapped",  FL_MULTILINE_INPUT_WRAP, true  }
+  };
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    in->type(cases[c].type);
+    int pos = cases[c].middle ? text_size / 2 : -1;
+    double damaged = type(in, text, pos, false);
+    double all = type(in, text, pos, true);
+    printf("  %-24s %8.3f ms, %8.3f ms redrawing all\n", cases[c].name, damaged, all);
+  }
+
+  Fl_Surface_Device::pop_current();
+  delete surf;
+  delete holder;
+  delete[] text;
+  return 0;
+}
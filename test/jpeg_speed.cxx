@@ -0,0 +1,146 @@
+//
+// Speed test of JPEG thumbnail decoding for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Makes a thumbnail of a large JPEG image in three ways and prints how
+// long each takes: decoding the full image and resizing it with copy(),
+// decoding it at a reduced size with Fl_JPEG_Image(filename, W, H), and
+// loading it with Fl_Shared_Image::get(filename, W, H). Without a file
+// argument a photo-like test image is written to jpeg_speed.jpg in the
+// current directory and removed afterwards. This program doesn't open
+// a window.
+//
+// Usage: jpeg_speed [-s size] [-n count] [file.jpg]
+
+#include <FL/Fl.H>
+#include <FL/Fl_JPEG_Image.H>
+#include <FL/Fl_Shared_Image.H>
+#include <FL/fl_utf8.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int thumb_size = 128;
+static int count = 5;
+
+// Writes a 6000 x 4000 image with smooth gradients and some noise,
+// which compresses roughly like a photo.
+static int write_test_image(const char *filename) {
+  const int W = 6000, H = 4000;
+  unsigned char *pixels = new unsigned char[W * H * 3];
+  unsigned seed = 1;
+  unsigned char *p = pixels;
+  for (int y = 0; y < H; y++) {
+    for (int x = 0; x < W; x++) {
+      seed = seed * 1103515245u + 12345u;
+      int noise = int((seed >> 16) & 15) - 8;
+      double v = sin(x * 0.003) * cos(y * 0.004);
+      int r = int(128 + 100 * v) + noise;
+      int g = int(255.0 * x / W) + noise;
+      int b = int(255.0 * y / H) + noise;
+      *p++ = (unsigned char)(r < 0 ? 0 : r > 255 ? 255 : r);
+      *p++ = (unsigned char)(g < 0 ? 0 : g > 255 ? 255 : g);
+      *p++ = (unsigned char)(b < 0 ? 0 : b > 255 ? 255 : b);
+    }
+  }
+  int ret = fl_write_jpeg(filename, pixels, W, H);
+  delete[] pixels;
+  return ret;
+}
+
+// Returns the thumbnail size of an image, keeping its aspect ratio
+static void thumb_dimensions(int w, int h, int &W, int &H) {
+  if (w >= h) { W = thumb_size; H = (h * thumb_size + w / 2) / w; }
+  else        { H = thumb_size; W = (w * thumb_size + h / 2) / h; }
+  if (W < 1) W = 1;
+  if (H < 1) H = 1;
+}
+
+static void report(const char *what, Fl_Timestamp start, int dw, int dh) {
+  double ms = 1000 * Fl::seconds_since(start) / count;
+  if (dw) printf("  %-30s %9.2f ms  (decoded %d x %d)\n", what, ms, dw, dh);
+  else    printf("  %-30s %9.2f ms\n", what, ms);
+}
+
+int main(int argc, char **argv) {
+  const char *filename = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-s") && i + 1 < argc) thumb_size = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-n") && i + 1 < argc) count = atoi(argv[++i]);
+    else if (argv[i][0] != '-' && !filename) filename = argv[i];
+    else {
+      fprintf(stderr, "Usage: %s [-s size] [-n count] [file.jpg]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (thumb_size < 1) thumb_size = 1;
+  if (count < 1) count = 1;
+
+  bool test_image = (filename == NULL);
+  if (test_image) {
+    filename = "jpeg_speed.jpg";
+    if (write_test_image(filename) != 0) {
+      fprintf(stderr, "Can't write %s\n", filename);
+      return 1;
+    }
+  }
+
+  Fl_JPEG_Image full(filename);
+  if (full.fail()) {
+    fprintf(stderr, "Can't load %s\n", filename);
+    return 1;
+  }
+  int W, H;
+  thumb_dimensions(full.w(), full.h(), W, H);
+  printf("%s: %d x %d, thumbnail %d x %d, mean of %d runs:\n",
+         filename, full.w(), full.h(), W, H, count);
+
+  Fl_Timestamp start = Fl::now();
+  int dw = 0, dh = 0;
+  for (int i = 0; i < count; i++) {
+    Fl_JPEG_Image *img = new Fl_JPEG_Image(filename);
+    dw = img->w(); dh = img->h();
+    Fl_Image *thumb = img->copy(W, H);
+    delete thumb;
+    delete img;
+  }
+  report("full decode + copy()", start, dw, dh);
+
+  start = Fl::now();
+  for (int i = 0; i < count; i++) {
+    Fl_JPEG_Image *img = new Fl_JPEG_Image(filename, W, H);
+    dw = img->w(); dh = img->h();
+    Fl_Image *thumb = img->copy(W, H);
+    delete thumb;
+    delete img;
+  }
+  report("reduced decode + copy()", start, dw, dh);
+
+  fl_register_images();
+  start = Fl::now();
+  for (int i = 0; i < count; i++) {
+    Fl_Shared_Image *img = Fl_Shared_Image::get(filename, W, H);
+    if (!img) {
+      fprintf(stderr, "Fl_Shared_Image::get() failed\n");
+      return 1;
+    }
+    img->release();
+  }
+  report("Fl_Shared_Image::get(W, H)", start, 0, 0);
+
+  if (test_image) fl_unlink(filename);
+  return 0;
+}
@@ -0,0 +1,139 @@
+//
+// Speed test of building and searching large menus
+// for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Builds a menu with many items in a few levels of submenus, like a menu
+// of fonts or recent files, by calling add() for each item with and
+// without the path index of Fl_Menu_, and with the bulk add() of an array
+// of items, then finds items by their path with find_index(). Prints how
+// long this takes and checks that all menus and results are the same.
+// This program doesn't open a window.
+//
+// Usage: menu_speed [items [lookups]]
+
+#include <FL/Fl.H>
+#include <FL/Fl_Menu_Button.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int n_items = 50000;
+static int n_lookups = 2000;
+
+// Makes the paths of the items in submenus like "Family &12/Style 3/Font 4567",
+// sorted by family like a list of fonts, with some items at the top level
+static char **make_paths(int n) {
+  char **paths = new char*[n];
+  unsigned seed = 1;
+  for (int i = 0; i < n; i++) {
+    int family = int((long long)i * 100 / n);
+    seed = seed * 1103515245u + 12345u;
+    int style = int((seed >> 8) % 8u);
+    char buf[80];
+    if (i % 50 == 0) snprintf(buf, sizeof(buf), "Top item %d", i);
+    else snprintf(buf, sizeof(buf), "Family &%d/Style %d/Font %d", family, style, i);
+    paths[i] = strdup(buf);
+  }
+  return paths;
+}
+
+static bool same_menus(Fl_Menu_ *a, Fl_Menu_ *b) {
+  int n = a->size();
+  if (b->size() != n) return false;
+  for (int i = 0; i < n; i++) {
+    const Fl_Menu_Item &x = a->menu()[i], &y = b->menu()[i];
+    if ((x.text == NULL) != (y.text == NULL) || (x.text && strcmp(x.text, y.text)) ||
+        x.flags != y.flags || x.shortcut_ != y.shortcut_ ||
+        x.callback_ != y.callback_ || x.user_data_ != y.user_data_)
+      return false;
+  }
+  return true;
+}
+
+static void callback(Fl_Widget *, void *) {}
+
+// Finds the same pseudo-random items on each call.
+// Returns a checksum of the indexes found.
+static unsigned long find_items(Fl_Menu_ *menu, char **paths) {
+  unsigned seed = 12345;
+  unsigned long sum = 0;
+  for (int i = 0; i < n_lookups; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int t = menu->find_index(paths[(seed >> 8) % unsigned(n_items)]);
+    sum = sum * 31 + (unsigned long)(t + 1);
+  }
+  return sum;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) n_items = atoi(argv[1]);
+  if (argc > 2) n_lookups = atoi(argv[2]);
+  if (n_items < 1) n_items = 1;
+  char **paths = make_paths(n_items);
+  printf("%d items, %d lookups:\n", n_items, n_lookups);
+
+  Fl_Menu_Button *menus[3];
+  const char *names[3] = { "add()", "add() with path index", "add(items, n)" };
+  for (int k = 0; k < 3; k++) {
+    Fl_Menu_Button *menu = menus[k] = new Fl_Menu_Button(0, 0, 100, 25);
+    Fl_Timestamp start = Fl::now();
+    if (k < 2) {
+      menu->path_index(k);
+      for (int i = 0; i < n_items; i++)
+        menu->add(paths[i], 0, callback, fl_voidptr(i));
+      menu->menu_end();
+    } else {
+      Fl_Menu_Item *items = new Fl_Menu_Item[n_items];
+      memset(items, 0, n_items * sizeof(Fl_Menu_Item));
+      for (int i = 0; i < n_items; i++) {
+        items[i].text = paths[i];
+        items[i].callback_ = callback;
+        items[i].user_data_ = fl_voidptr(i);
+      }
+      menu->add(items, n_items);
+      delete[] items;
+    }
+    printf("  %-28s %9.2f ms\n", names[k], 1000 * Fl::seconds_since(start));
+  }
+  if (!same_menus(menus[0], menus[1]) || !same_menus(menus[0], menus[2])) {
+    printf("Error: the menus are different\n");
+    return 1;
+  }
+  printf("  (menu size %d)\n", menus[0]->size());
+
+  unsigned long sums[2];
+  for (int k = 0; k < 2; k++) {
+    menus[0]->path_index(k);
+    if (k) { // the first search builds the index
+      Fl_Timestamp start = Fl::now();
+      menus[0]->find_index("");
+      printf("  building the index           %9.2f ms\n", 1000 * Fl::seconds_since(start));
+    }
+    Fl_Timestamp start = Fl::now();
+    sums[k] = find_items(menus[0], paths);
+    printf("  find_index(), %-14s %9.2f ms\n", k ? "with index" : "without index",
+           1000 * Fl::seconds_since(start));
+  }
+  if (sums[0] != sums[1]) {
+    printf("Error: find_index() found different items with the index\n");
+    return 1;
+  }
+
+  for (int k = 0; k < 3; k++) delete menus[k];
+  for (int i = 0; i < n_items; i++) free(paths[i]);
+  delete[] paths;
+  return 0;
+}
@@ -0,0 +1,117 @@
+//
+// Speed test of PNG encoding for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Encodes screenshot-like RGB images of several sizes with fl_encode_png()
+// and different Fl_PNG_Options, and prints how long this takes and how large
+// the PNG data is. Each result is decoded again and compared to the original
+// pixels. This program doesn't open a window.
+//
+// Usage: png_speed [-t threads] [-n count]
+
+#include <FL/Fl.H>
+#include <FL/Fl_PNG_Image.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int threads = 4;
+static int count = 1;
+
+// Fills an image with flat areas, gradients and some noisy "text" lines,
+// like a screenshot of an application window
+static unsigned char *make_image(int W, int H) {
+  unsigned char *pixels = new unsigned char[W * H * 3];
+  unsigned seed = 1;
+  for (int y = 0; y < H; y++) {
+    unsigned char *p = pixels + y * W * 3;
+    for (int x = 0; x < W; x++, p += 3) {
+      if ((y / 20) % 4 == 1 && (x / 8) % 12 < 10) { // text
+        seed = seed * 1103515245u + 12345u;
+        unsigned char v = (seed >> 20) & 1 ? 30 : 230;
+        p[0] = p[1] = p[2] = v;
+      } else if (x < W / 5) { // side bar
+        p[0] = 60; p[1] = 80; p[2] = 120;
+      } else { // gradient
+        p[0] = (unsigned char)(200 + 55 * y / H);
+        p[1] = (unsigned char)(200 + 55 * x / W);
+        p[2] = 220;
+      }
+    }
+  }
+  return pixels;
+}
+
+static void run(const char *name, const unsigned char *pixels, int W, int H,
+                const Fl_PNG_Options &options) {
+  size_t size = 0;
+  unsigned char *png = NULL;
+  Fl_Timestamp start = Fl::now();
+  for (int i = 0; i < count; i++) {
+    free(png);
+    png = fl_encode_png(pixels, W, H, 3, 0, &size, &options);
+  }
+  double ms = 1000 * Fl::seconds_since(start) / count;
+  if (!png) {
+    printf("  %-28s failed\n", name);
+    return;
+  }
+  Fl_PNG_Image img(NULL, png, (int)size);
+  bool same = (img.w() == W && img.h() == H && img.d() == 3 &&
+               !memcmp(img.array, pixels, (size_t)W * H * 3));
+  printf("  %-28s %9.1f ms %10lu bytes%s\n", name, ms, (unsigned long)size,
+         same ? "" : "  DECODING ERROR");
+  free(png);
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-n") && i + 1 < argc) count = atoi(argv[++i]);
+    else {
+      fprintf(stderr, "Usage: %s [-t threads] [-n count]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (threads < 2) threads = 2;
+  if (count < 1) count = 1;
+
+  static const int sizes[][2] = { { 1920, 1080 }, { 3840, 2160 }, { 7680, 4320 } };
+  for (int s = 0; s < 3; s++) {
+    int W = sizes[s][0], H = sizes[s][1];
+    unsigned char *pixels = make_image(W, H);
+    printf("%d x %d RGB, mean of %d runs:\n", W, H, count);
+
+    Fl_PNG_Options options;
+    run("default", pixels, W, H, options);
+    options.compression = 1;
+    run("level 1", pixels, W, H, options);
+    options.filter = Fl_PNG_Options::FILTER_SUB;
+    options.strategy = Fl_PNG_Options::STRATEGY_RLE;
+    run("level 1, sub filter, RLE", pixels, W, H, options);
+
+    char name[40];
+    options = Fl_PNG_Options();
+    options.threads = threads;
+    snprintf(name, sizeof(name), "default, %d threads", threads);
+    run(name, pixels, W, H, options);
+    options.compression = 1;
+    snprintf(name, sizeof(name), "level 1, %d threads", threads);
+    run(name, pixels, W, H, options);
+
+    delete[] pixels;
+  }
+  return 0;
+}
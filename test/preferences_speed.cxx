@@ -0,0 +1,117 @@
+//
+// Speed test of Fl_Preferences for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Writes a preferences file with many entries, then measures how long it
+// takes to open it, read some or all of its entries, and save a change.
+// The file has one group with many recent file names and many small
+// groups with window layouts. This program doesn't open a window.
+//
+// Usage: preferences_speed [directory [entries]]
+
+#include <FL/Fl.H>
+#include <FL/Fl_Preferences.H>
+#include <FL/fl_utf8.h>
+#include <FL/filename.H>     // FL_PATH_MAX
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *vendor = "fltk.org";
+static const char *application = "preferences_speed";
+static int n_entries = 50000;
+
+static void report(const char *what, Fl_Timestamp start) {
+  printf("  %-36s %9.2f ms\n", what, 1000 * Fl::seconds_since(start));
+}
+
+int main(int argc, char **argv) {
+  const char *dir = argc > 1 ? argv[1] : ".";
+  if (argc > 2) n_entries = atoi(argv[2]);
+  if (n_entries < 200) n_entries = 200;
+  const int n_recent = n_entries / 5;                 // entries in group "recent"
+  const int n_windows = (n_entries - n_recent) / 20;  // groups of 20 entries
+  char path[FL_PATH_MAX];
+  snprintf(path, sizeof(path), "%s/%s.prefs", dir, application);
+  printf("%s: %d recent files, %d window groups of 20 entries\n", path, n_recent, n_windows);
+
+  Fl_Timestamp start = Fl::now();
+  {
+    Fl_Preferences prefs(dir, vendor, application, Fl_Preferences::CLEAR);
+    Fl_Preferences recent(prefs, "recent");
+    for (int i = 0; i < n_recent; i++)
+      recent.set(Fl_Preferences::Name("file%d", i), Fl_Preferences::Name("/home/user/projects/project%d/src/file%d.cxx", i / 100, i));
+    Fl_Preferences layout(prefs, "layout");
+    for (int i = 0; i < n_windows; i++) {
+      Fl_Preferences win(layout, Fl_Preferences::Name("window%d", i));
+      for (int j = 0; j < 20; j++)
+        win.set(Fl_Preferences::Name("value%d", j), i * 20 + j);
+    }
+    if (prefs.flush() < 0) {
+      fprintf(stderr, "Can't write %s\n", path);
+      return 1;
+    }
+  }
+  report("create and write", start);
+
+  start = Fl::now();
+  {
+    Fl_Preferences prefs(dir, vendor, application, (Fl_Preferences::Root)0);
+  }
+  report("open", start);
+
+  start = Fl::now();
+  {
+    Fl_Preferences prefs(dir, vendor, application, (Fl_Preferences::Root)0);
+    Fl_Preferences win(prefs, "layout/window7");
+    int x;
+    win.get("value3", x, 0);
+  }
+  report("open and read one entry", start);
+
+  start = Fl::now();
+  long sum = 0;
+  {
+    Fl_Preferences prefs(dir, vendor, application, (Fl_Preferences::Root)0);
+    Fl_Preferences recent(prefs, "recent");
+    char name[FL_PATH_MAX];
+    for (int i = 0; i < n_recent; i++) {
+      recent.get(Fl_Preferences::Name("file%d", i), name, "", sizeof(name));
+      sum += name[0];
+    }
+    Fl_Preferences layout(prefs, "layout");
+    for (int i = 0; i < n_windows; i++) {
+      Fl_Preferences win(layout, Fl_Preferences::Name("window%d", i));
+      for (int j = 0; j < 20; j++) {
+        int v;
+        win.get(Fl_Preferences::Name("value%d", j), v, 0);
+        sum += v;
+      }
+    }
+  }
+  report("open and read all entries", start);
+
+  start = Fl::now();
+  {
+    Fl_Preferences prefs(dir, vendor, application, (Fl_Preferences::Root)0);
+    Fl_Preferences recent(prefs, "recent");
+    recent.set("file0", "/home/user/new.cxx");
+    if (prefs.flush() < 0)
+      fprintf(stderr, "Can't write %s\n", path);
+  }
+  report("open, change one entry and write", start);
+
+  fl_unlink(path);
+  return sum == 0; // use the values read
+}
@@ -0,0 +1,404 @@
+//
+// Rendering speed benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Draws a set of fixed scenes into an Fl_Image_Surface, times them and
+// prints one line of JSON per scene, e.g. to compare the results of two
+// builds with a script. The program doesn't open a window, but it needs
+// a display connection: under X11 without a screen, run it with xvfb-run.
+//
+// Scenes: a long text in an Fl_Text_Display, an Fl_Table with 100000 rows,
+// an Fl_Browser with 100000 lines, a large Fl_Tree, many short strings drawn
+// with fl_draw() one by one and between fl_text_batch_begin() and
+// fl_text_batch_end(), a scaled image, an image resized with bilinear
+// scaling, complex polygons drawn with fl_vertex(), and a panel of common
+// widgets in each scheme. Scenes contain no random or time dependent
+// data, so the optional checksum of the last frame of a scene doesn't
+// change unless drawing does.
+//
+// Usage: render_speed [-f frames] [-c] [-o file] [scene ...]
+//   -f frames  number of times each scene is drawn (default 20)
+//   -c         add a checksum of the pixels of each scene to the results
+//   -o file    write the results to file instead of stdout
+//   scene ...  only run scenes whose name starts with one of these
+
+#include <FL/Fl.H>
+#include <FL/platform.H>        // fl_open_display()
+#include <FL/Fl_Window.H>
+#include <FL/Fl_Image_Surface.H>
+#include <FL/Fl_Text_Display.H>
+#include <FL/Fl_Table.H>
+#include <FL/Fl_Browser.H>
+#include <FL/Fl_Tree.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_Check_Button.H>
+#include <FL/Fl_Round_Button.H>
+#include <FL/Fl_Input.H>
+#include <FL/Fl_Choice.H>
+#include <FL/Fl_Slider.H>
+#include <FL/Fl_Progress.H>
+#include <FL/Fl_Box.H>
+#include <FL/fl_draw.H>
+#include <FL/math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int W = 800, H = 600;  // size of the surface
+static int n_frames = 20;
+
+// All widgets are children of this window, which is never shown
+static Fl_Window *holder;
+
+//
+// Scenes
+//
+
+static Fl_Text_Display *text_display;
+
+static void make_text() {
+  Fl_Text_Buffer *buffer = new Fl_Text_Buffer();
+  char line[120];
+  for (int i = 0; i < 50000; i++) {
+    snprintf(line, sizeof(line), "%6d  The quick brown fox jumps over the lazy dog, %d times.\n",
+             i + 1, i % 97);
+    buffer->append(line);
+  }
+  text_display = new Fl_Text_Display(0, 0, W, H);
+  text_display->buffer(buffer);
+  text_display->textfont(FL_COURIER);
+  text_display->textsize(12);
+  text_display->linenumber_width(60);
+  text_display->scroll(25000, 0);
+}
+
+static void draw_text(Fl_Image_Surface *surf) {
+  surf->draw(text_display, 0, 0);
+}
+
+class Bench_Table : public Fl_Table {
+protected:
+  void draw_cell(TableContext context, int R, int C, int X, int Y, int W, int H) override {
+    char s[40];
+    switch (context) {
+      case CONTEXT_STARTPAGE:
+        fl_font(FL_HELVETICA, 12);
+        return;
+      case CONTEXT_COL_HEADER:
+      case CONTEXT_ROW_HEADER:
+        if (context == CONTEXT_COL_HEADER) snprintf(s, sizeof(s), "%c", 'A' + C);
+        else snprintf(s, sizeof(s), "%d", R + 1);
+        fl_draw_box(FL_THIN_UP_BOX, X, Y, W, H, row_header_color());
+        fl_color(FL_BLACK);
+        fl_draw(s, X, Y, W, H, FL_ALIGN_CENTER);
+        return;
+      case CONTEXT_CELL:
+        snprintf(s, sizeof(s), "%d", (R * 31 + C * 17) % 100000);
+        fl_color((R & 1) ? FL_WHITE : fl_rgb_color(240, 244, 255));
+        fl_rectf(X, Y, W, H);
+        fl_color(FL_BLACK);
+        fl_draw(s, X + 2, Y, W - 4, H, FL_ALIGN_RIGHT);
+        fl_color(FL_LIGHT2);
+        fl_rect(X, Y, W, H);
+        return;
+      default:
+        return;
+    }
+  }
+public:
+  Bench_Table(int X, int Y, int W, int H) : Fl_Table(X, Y, W, H) {
+    rows(100000);
+    cols(12);
+    row_header(1);
+    col_header(1);
+    row_height_all(20);
+    col_width_all(64);
+    end();
+  }
+};
+
+static Bench_Table *table;
+
+static void make_table() {
+  table = new Bench_Table(0, 0, W, H);
+  table->row_position(50000);
+}
+
+static void draw_table(Fl_Image_Surface *surf) {
+  surf->draw(table, 0, 0);
+}
+
+static Fl_Browser *browser;
+
+static void make_browser() {
+  browser = new Fl_Browser(0, 0, W, H);
+  static int widths[] = { 80, 300, 0 };
+  browser->column_widths(widths);
+  char line[120];
+  for (int i = 0; i < 100000; i++) {
+    snprintf(line, sizeof(line), "%d\tfile_%05d.txt\t%d bytes", i + 1, i, (i * 7919) % 100000);
+    browser->add(line);
+  }
+  browser->topline(50000);
+}
+
+static void draw_browser(Fl_Image_Surface *surf) {
+  surf->draw(browser, 0, 0);
+}
+
+// a grid of short strings, like the labels of a chart or a spreadsheet
+static void draw_strings() {
+  char s[20];
+  fl_font(FL_HELVETICA, 11);
+  fl_color(FL_BLACK);
+  for (int y = 14; y < H; y += 14) {
+    for (int x = 2; x < W - 40; x += 44) {
+      snprintf(s, sizeof(s), "%d", (x * 31 + y * 17) % 10000);
+      fl_draw(s, x, y);
+    }
+  }
+}
+
+static void draw_strings_each(Fl_Image_Surface *) {
+  draw_strings();
+}
+
+static void draw_strings_batched(Fl_Image_Surface *) {
+  fl_text_batch_begin();
+  draw_strings();
+  fl_text_batch_end();
+}
+
+static Fl_Tree *tree;
+
+static void make_tree() {
+  tree = new Fl_Tree(0, 0, W, H);
+  tree->showroot(0);
+  char path[80];
+  for (int g = 0; g < 200; g++) {
+    for (int i = 0; i < 50; i++) {
+      snprintf(path, sizeof(path), "Group %03d/Folder %d/Item %05d", g, i / 10, g * 50 + i);
+      tree->add(path);
+    }
+  }
+  tree->end();
+  tree->vposition(tree->vposition() + 100000);
+}
+
+static void draw_tree(Fl_Image_Surface *surf) {
+  surf->draw(tree, 0, 0);
+}
+
+static Fl_RGB_Image *picture;
+
+static void make_picture() {
+  const int pw = 1000, ph = 750;
+  uchar *data = new uchar[pw * ph * 3];
+  uchar *p = data;
+  for (int y = 0; y < ph; y++) {
+    for (int x = 0; x < pw; x++) {
+      *p++ = uchar(x * 255 / pw);
+      *p++ = uchar(y * 255 / ph);
+      *p++ = uchar(((x / 25) ^ (y / 25)) & 1 ? 200 : 40);
+    }
+  }
+  picture = new Fl_RGB_Image(data, pw, ph, 3);
+  picture->alloc_array = 1;
+}
+
+static void draw_image_scaled(Fl_Image_Surface *) {
+  if (!picture) make_picture();
+  picture->scale(W, H, 0, 1);
+  picture->draw(0, 0);
+}
+
+static void draw_image_copy(Fl_Image_Surface *) {
+  if (!picture) make_picture();
+  Fl_RGB_Scaling old = Fl_Image::RGB_scaling();
+  Fl_Image::RGB_scaling(FL_RGB_SCALING_BILINEAR);
+  Fl_Image *copy = picture->copy(W * 9 / 10, H * 9 / 10);
+  Fl_Image::RGB_scaling(old);
+  copy->draw(W / 20, H / 20);
+  delete copy;
+}
+
+static void draw_shapes(Fl_Image_Surface *) {
+  for (int i = 0; i < 300; i++) {
+    fl_push_matrix();
+    fl_translate(40 + (i % 20) * 38, 40 + (i / 20) * 38);
+    fl_rotate(i * 7.0);
+    fl_scale(15 + i % 5);
+    // a star with holes, as a complex polygon
+    fl_color(fl_rgb_color(uchar(i * 37), uchar(i * 59), uchar(i * 83)));
+    fl_begin_complex_polygon();
+    for (int k = 0; k < 10; k++) {
+      double r = (k & 1) ? 0.4 : 1.0;
+      fl_vertex(r * cos(k * M_PI / 5), r * sin(k * M_PI / 5));
+    }
+    fl_gap();
+    fl_arc(0, 0, 0.2, 0, 360);
+    fl_end_complex_polygon();
+    // and its outline, with a curve
+    fl_color(FL_BLACK);
+    fl_begin_loop();
+    fl_curve(-1, 0, -0.5, -1, 0.5, 1, 1, 0);
+    fl_vertex(0, 1);
+    fl_end_loop();
+    fl_pop_matrix();
+  }
+}
+
+static Fl_Group *panel;
+
+static void make_panel() {
+  static const char *choices[] = { "One", "Two", "Three", NULL };
+  panel = new Fl_Group(0, 0, W, H);
+  panel->box(FL_FLAT_BOX);
+  for (int i = 0; i < 12; i++) {
+    int y = 10 + i * 48;
+    char *label = new char[20];
+    snprintf(label, 20, "Button %d", i + 1);
+    new Fl_Button(10, y, 110, 30, label);
+    Fl_Check_Button *cb = new Fl_Check_Button(130, y, 110, 30, "Check");
+    cb->value(i & 1);
+    Fl_Round_Button *rb = new Fl_Round_Button(250, y, 110, 30, "Round");
+    rb->value(!(i & 1));
+    Fl_Input *in = new Fl_Input(370, y, 130, 30);
+    in->value("Some text input");
+    Fl_Choice *ch = new Fl_Choice(510, y, 100, 30);
+    for (int k = 0; choices[k]; k++) ch->add(choices[k]);
+    ch->value(i % 3);
+    Fl_Slider *sl = new Fl_Slider(620, y, 100, 30);
+    sl->type(FL_HOR_NICE_SLIDER);
+    sl->value((i + 1) / 13.0);
+    Fl_Progress *pr = new Fl_Progress(730, y, 60, 30);
+    pr->value(float((i + 1) * 8));
+  }
+  panel->end();
+}
+
+static void draw_panel(Fl_Image_Surface *surf) {
+  surf->draw(panel, 0, 0);
+}
+
+struct Scene {
+  const char *name;
+  const char *scheme;   // for the widget panel, NULL to keep the current one
+  void (*make)();       // creates the widgets of the scene, may be NULL
+  void (*draw)(Fl_Image_Surface *);
+};
+
+static Scene scenes[] = {
+  { "text_display",    NULL,      make_text,    draw_text },
+  { "table",           NULL,      make_table,   draw_table },
+  { "browser",         NULL,      make_browser, draw_browser },
+  { "strings",         NULL,      NULL,         draw_strings_each },
+  { "strings_batched", NULL,      NULL,         draw_strings_batched },
+  { "tree",            NULL,      make_tree,    draw_tree },
+  { "image_scaled",    NULL,      NULL,         draw_image_scaled },
+  { "image_bilinear",  NULL,      NULL,         draw_image_copy },
+  { "shapes",          NULL,      NULL,         draw_shapes },
+  { "scheme_base",     "base",    make_panel,   draw_panel },
+  { "scheme_gtk+",     "gtk+",    NULL,         draw_panel },
+  { "scheme_gleam",    "gleam",   NULL,         draw_panel },
+  { "scheme_plastic",  "plastic", NULL,         draw_panel },
+  { "scheme_oxy",      "oxy",     NULL,         draw_panel },
+};
+
+//
+// Running scenes
+//
+
+// FNV-1a hash of the pixels of the surface
+static unsigned checksum(Fl_Image_Surface *surf) {
+  Fl_RGB_Image *img = surf->image();
+  unsigned h = 2166136261u;
+  int ld = img->ld() ? img->ld() : img->data_w() * img->d();
+  const uchar *row = (const uchar *)img->data()[0];
+  for (int y = 0; y < img->data_h(); y++, row += ld) {
+    for (int x = 0; x < img->data_w() * img->d(); x++) {
+      h ^= row[x];
+      h *= 16777619u;
+    }
+  }
+  delete img;
+  return h;
+}
+
+// Waits until the graphics system has done all drawing requests
+static void finish() {
+  uchar *p = fl_read_image(NULL, 0, 0, 1, 1);
+  delete[] p;
+}
+
+static void run(const Scene &scene, Fl_Image_Surface *surf, FILE *out, bool with_checksum) {
+  if (scene.scheme) Fl::scheme(scene.scheme);
+  Fl_Surface_Device::push_current(surf);
+  double total = 0, best = 1e20;
+  for (int i = 0; i <= n_frames; i++) { // frame 0 is not counted
+    Fl_Timestamp start = Fl::now();
+    fl_color(FL_WHITE);
+    fl_rectf(0, 0, W, H);
+    scene.draw(surf);
+    finish();
+    double t = Fl::seconds_since(start);
+    if (i == 0) continue;
+    total += t;
+    if (t < best) best = t;
+  }
+  Fl_Surface_Device::pop_current();
+  fprintf(out, "{\"scene\":\"%s\",\"width\":%d,\"height\":%d,\"frames\":%d,"
+          "\"ms_per_frame\":%.3f,\"min_ms\":%.3f",
+          scene.name, W, H, n_frames, 1000 * total / n_frames, 1000 * best);
+  if (with_checksum) fprintf(out, ",\"checksum\":\"%08x\"", checksum(surf));
+  fprintf(out, "}\n");
+  fflush(out);
+}
+
+static bool selected(const char *name, int argc, char **argv, int first) {
+  if (first >= argc) return true;
+  for (int i = first; i < argc; i++)
+    if (!strncmp(name, argv[i], strlen(argv[i]))) return true;
+  return false;
+}
+
+int main(int argc, char **argv) {
+  bool with_checksum = false;
+  FILE *out = stdout;
+  int i;
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (!strcmp(argv[i], "-f") && i + 1 < argc) n_frames = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-c")) with_checksum = true;
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      out = fopen(argv[++i], "w");
+      if (!out) { perror(argv[i]); return 1; }
+    } else {
+      fprintf(stderr, "Usage: %s [-f frames] [-c] [-o file] [scene ...]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (n_frames < 1) n_frames = 1;
+  fl_open_display();
+  holder = new Fl_Window(W, H, "render_speed");
+  Fl_Image_Surface *surf = new Fl_Image_Surface(W, H);
+  for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++) {
+    if (scenes[s].make) scenes[s].make(); // always, a later scene may need it
+    if (selected(scenes[s].name, argc, argv, i)) run(scenes[s], surf, out, with_checksum);
+  }
+  holder->end();
+  delete surf;
+  if (out != stdout) fclose(out);
+  return 0;
+}
@@ -1,7 +1,7 @@
 //
 // Unit tests for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2023 by Bill Spitzak and others.
+// Copyright 1998-2026 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -16,6 +16,7 @@
 
 #include "unittests.h"
 
+#include <config.h>
 #include <FL/Fl_Group.H>
 #include <FL/Fl_Button.H>
 #include <FL/Fl_Terminal.H>
@@ -23,8 +24,32 @@
 #include <FL/fl_callback_macros.H>
 #include <FL/filename.H>
 #include <FL/fl_utf8.h>
+#include <FL/Fl_Text_Buffer.H>
+#include <FL/Fl_Multiline_Input.H>
+#include <FL/Fl_Device.H>
+#include <FL/Fl_Graphics_Driver.H>
+#include <FL/Fl_PNG_Image.H>
+#include <FL/Fl_JPEG_Image.H>
+#include <FL/Fl_BMP_Image.H>
+#include <FL/Fl_Pixmap.H>
+#include <FL/Fl_SVG_File_Surface.H>
+#include <FL/Fl_PostScript.H>
+#if HAVE_GL
+#include <FL/Fl_Gl_Window.H>
+#include <FL/gl.h>
+#endif
 
+#include <map>
 #include <string>
+#include <vector>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
 
 
 /* Test additions to Fl_Preferences. */
@@ -50,6 +75,109 @@ TEST(Fl_Preferences, Strings) {
   return true;
 }
 
+/* Test that preferences are written and read back unchanged, also when only
+   some of their groups were used in between: groups are split into entries
+   when they are first used, and entries are found with hash tables. */
+TEST(Fl_Preferences, save_and_reload) {
+  char dir[FL_PATH_MAX];
+  {
+    Fl_Preferences prefs(Fl_Preferences::USER_L, "fltk.org", "unittests");
+    EXPECT_TRUE(prefs.get_userdata_path(dir, sizeof(dir)) != 0);
+  }
+  std::string path = std::string(dir) + "roundtrip";
+  std::string file = path + "/roundtrip.prefs";
+  char name[32], key[32];
+  {
+    Fl_Preferences prefs(path.c_str(), "fltk.org", "roundtrip",
+                         (Fl_Preferences::Root)(Fl_Preferences::USER_L | Fl_Preferences::CLEAR));
+    for (int g = 0; g < 50; g++) {
+      snprintf(name, sizeof(name), "group%d/sub", g);
+      Fl_Preferences grp(prefs, name);
+      for (int e = 0; e < 50; e++) {
+        snprintf(key, sizeof(key), "key%d", e);
+        grp.set(key, g * 100 + e);
+      }
+    }
+    prefs.set("top", "level");
+  }
+  {
+    // change a single group, the others are written back without being parsed
+    Fl_Preferences prefs(path.c_str(), "fltk.org", "roundtrip", Fl_Preferences::USER_L);
+    Fl_Preferences grp(prefs, "group7/sub");
+    int v;
+    grp.get("key9", v, -1);
+    EXPECT_EQ(v, 709);
+    grp.set("key9", -709);
+    grp.set("new", 1);
+  }
+  {
+    Fl_Preferences prefs(path.c_str(), "fltk.org", "roundtrip", Fl_Preferences::USER_L);
+    EXPECT_EQ(prefs.groups(), 50);
+    std::string s;
+    prefs.get("top", s, "");
+    EXPECT_STREQ(s.c_str(), "level");
+    for (int g = 49; g >= 0; g--) {
+      snprintf(name, sizeof(name), "group%d", g);
+      EXPECT_TRUE(prefs.groupExists(name) != 0);
+      Fl_Preferences parent(prefs, name);
+      Fl_Preferences grp(parent, "sub");
+      EXPECT_EQ(grp.entries(), g == 7 ? 51 : 50);
+      for (int e = 49; e >= 0; e--) {
+        snprintf(key, sizeof(key), "key%d", e);
+        int v;
+        grp.get(key, v, -1);
+        EXPECT_EQ(v, (g == 7 && e == 9) ? -709 : g * 100 + e);
+      }
+      EXPECT_TRUE(grp.entryExists("key50") == 0);
+    }
+    EXPECT_TRUE(prefs.groupExists("group50") == 0);
+  }
+#ifndef _WIN32
+  {
+    // the file keeps its mode, and a symbolic link to it stays a link
+    EXPECT_EQ(chmod(file.c_str(), 0600), 0);
+    std::string linkpath = path + "/link";
+    std::string link = linkpath + "/roundtrip.prefs";
+    fl_make_path(linkpath.c_str());
+    unlink(link.c_str());
+    EXPECT_EQ(symlink(file.c_str(), link.c_str()), 0);
+    {
+      Fl_Preferences prefs(linkpath.c_str(), "fltk.org", "roundtrip", Fl_Preferences::USER_L);
+      prefs.set("top", "linked");
+    }
+    struct stat st;
+    EXPECT_EQ(lstat(link.c_str(), &st), 0);
+    EXPECT_TRUE(S_ISLNK(st.st_mode));
+    EXPECT_EQ(stat(file.c_str(), &st), 0);
+    EXPECT_EQ((int)(st.st_mode & 0777), 0600);
+    {
+      Fl_Preferences prefs(path.c_str(), "fltk.org", "roundtrip", Fl_Preferences::USER_L);
+      std::string s;
+      prefs.get("top", s, "");
+      EXPECT_STREQ(s.c_str(), "linked");
+    }
+    unlink(link.c_str());
+    rmdir(linkpath.c_str());
+  }
+  {
+    // a new file gets mode 0666 masked by the umask
+    EXPECT_EQ(unlink(file.c_str()), 0);
+    mode_t mask = umask(027);
+    {
+      Fl_Preferences prefs(path.c_str(), "fltk.org", "roundtrip", Fl_Preferences::USER_L);
+      prefs.set("top", "new");
+    }
+    umask(mask);
+    struct stat st;
+    EXPECT_EQ(stat(file.c_str(), &st), 0);
+    EXPECT_EQ((int)(st.st_mode & 0777), 0640);
+  }
+#endif
+  fl_unlink(file.c_str());
+  fl_rmdir(path.c_str());
+  return true;
+}
+
 #if 0
 
 TEST(fl_filename, ext) {
@@ -167,6 +295,740 @@ TEST(Fl_Callback_Macros, FL_INLINE_CALLBACK) {
 
 #endif // FIXME - Fl_String
 
+/*
+ Test the UTF-8 functions that copy runs of ASCII characters as a block
+ against the byte-by-byte conversion they replaced.
+ */
+
+// the byte-wise fl_utf8test()
+static int ref_utf8test(const char* src, unsigned srclen) {
+  int ret = 1;
+  const char* p = src;
+  const char* e = src+srclen;
+  while (p < e) {
+    if (*p & 0x80) {
+      int len; fl_utf8decode(p,e,&len);
+      if (len < 2) return 0;
+      if (len > ret) ret = len;
+      p += len;
+    } else {
+      p++;
+    }
+  }
+  return ret;
+}
+
+// the byte-wise fl_utf8toUtf16()
+static unsigned ref_utf8toUtf16(const char* src, unsigned srclen,
+                                unsigned short* dst, unsigned dstlen) {
+  const char* p = src;
+  const char* e = src+srclen;
+  unsigned count = 0;
+  if (dstlen) for (;;) {
+    if (p >= e) {dst[count] = 0; return count;}
+    if (!(*p & 0x80)) { /* ascii */
+      dst[count] = *p++;
+    } else {
+      int len; unsigned ucs = fl_utf8decode(p,e,&len);
+      p += len;
+      if (ucs < 0x10000) {
+        dst[count] = ucs;
+      } else {
+        /* make a surrogate pair: */
+        if (count+2 >= dstlen) {dst[count] = 0; count += 2; break;}
+        dst[count] = (((ucs-0x10000u)>>10)&0x3ff) | 0xd800;
+        dst[++count] = (ucs&0x3ff) | 0xdc00;
+      }
+    }
+    if (++count == dstlen) {dst[count-1] = 0; break;}
+  }
+  /* we filled dst, measure the rest: */
+  while (p < e) {
+    if (!(*p & 0x80)) p++;
+    else {
+      int len; unsigned ucs = fl_utf8decode(p,e,&len);
+      p += len;
+      if (ucs >= 0x10000) ++count;
+    }
+    ++count;
+  }
+  return count;
+}
+
+// the byte-wise fl_utf8toa()
+static unsigned ref_utf8toa(const char* src, unsigned srclen,
+                            char* dst, unsigned dstlen) {
+  const char* p = src;
+  const char* e = src+srclen;
+  unsigned count = 0;
+  if (dstlen) for (;;) {
+    unsigned char c;
+    if (p >= e) {dst[count] = 0; return count;}
+    c = *(const unsigned char*)p;
+    if (c < 0xC2) { /* ascii or bad code */
+      dst[count] = c;
+      p++;
+    } else {
+      unsigned ucs = 0x100;
+      int len = fl_utf8len(*p);
+      if (len > 2) p = fl_utf8_next_composed_char(p, e);
+      else {
+        ucs = fl_utf8decode(p,e,&len);
+        p += len;
+      }
+      if (ucs < 0x100) dst[count] = ucs;
+      else dst[count] = '?';
+    }
+    if (++count >= dstlen) {dst[count-1] = 0; break;}
+  }
+  /* we filled dst, measure the rest: */
+  while (p < e) {
+    if (!(*p & 0x80)) p++;
+    else {
+      int len = fl_utf8len1(*p);
+      if (len > 2) p = fl_utf8_next_composed_char(p, e);
+      else {
+        p += len;
+      }
+    }
+    ++count;
+  }
+  return count;
+}
+
+#ifndef _WIN32
+// the byte-wise fl_utf8towc() of the platforms with 32-bit wchar_t
+static unsigned ref_utf8towc(const char* src, unsigned srclen, wchar_t* dst, unsigned dstlen) {
+  const char* p = src;
+  const char* e = src+srclen;
+  unsigned count = 0;
+  if (dstlen) for (;;) {
+    if (p >= e) {
+      dst[count] = 0;
+      return count;
+    }
+    if (!(*p & 0x80)) { /* ascii */
+      dst[count] = *p++;
+    } else {
+      int len; unsigned ucs = fl_utf8decode(p,e,&len);
+      p += len;
+      dst[count] = (wchar_t)ucs;
+    }
+    if (++count == dstlen) {dst[count-1] = 0; break;}
+  }
+  /* we filled dst, measure the rest: */
+  while (p < e) {
+    if (!(*p & 0x80)) p++;
+    else {
+      int len; fl_utf8decode(p,e,&len);
+      p += len;
+    }
+    ++count;
+  }
+  return count;
+}
+#endif
+
+// Converts src with each function and its byte-wise version, with destination
+// buffers of several sizes, and returns true if all results are the same.
+static bool utf8_same_as_bytewise(const char *src, unsigned n) {
+  static const unsigned N = 80;
+  unsigned short u16[N], r16[N];
+  char a[N], ra[N];
+  if (fl_utf8test(src, n) != ref_utf8test(src, n)) return false;
+  unsigned sizes[] = { 0, 1, 2, 3, 5, 8, 9, 16, 17, n / 2, n, n + 1, N };
+  for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    unsigned d = sizes[i] < N ? sizes[i] : N;
+    memset(u16, 0x55, sizeof(u16)); memset(r16, 0x55, sizeof(r16));
+    if (fl_utf8toUtf16(src, n, u16, d) != ref_utf8toUtf16(src, n, r16, d)) return false;
+    if (memcmp(u16, r16, sizeof(u16))) return false;
+    memset(a, 0x55, sizeof(a)); memset(ra, 0x55, sizeof(ra));
+    if (fl_utf8toa(src, n, a, d) != ref_utf8toa(src, n, ra, d)) return false;
+    if (memcmp(a, ra, sizeof(a))) return false;
+#ifndef _WIN32
+    wchar_t wc[N], rwc[N];
+    memset(wc, 0x55, sizeof(wc)); memset(rwc, 0x55, sizeof(rwc));
+    if (fl_utf8towc(src, n, wc, d) != ref_utf8towc(src, n, rwc, d)) return false;
+    if (memcmp(wc, rwc, sizeof(wc))) return false;
+#endif
+  }
+  return true;
+}
+
+// non-ASCII byte sequences: valid, truncated, overlong and invalid
+static const char *utf8_samples[] = {
+  "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xcc\x81", "\xe4\xb8\xad",
+  "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\x80", "\xbf", "\xc0\x80", "\xc1\xbf",
+  "\xe0\x80\x80", "\xed\xa0\x80", "\xf5\x80\x80\x80", "\xfe", "\xff"
+};
+static const int n_utf8_samples = (int)(sizeof(utf8_samples) / sizeof(utf8_samples[0]));
+
+TEST(fl_utf8, ascii_runs) {
+  char buf[64 + 16];
+  // pure ASCII of every length and alignment crossing 8 and 16 byte words
+  for (int align = 0; align < 16; align++) {
+    for (unsigned n = 0; n <= 48; n++) {
+      for (unsigned i = 0; i < n; i++) buf[align + i] = char('A' + (i * 7) % 26);
+      EXPECT_TRUE(utf8_same_as_bytewise(buf + align, n));
+    }
+  }
+  // a non-ASCII sequence at every offset of words of ASCII, at every alignment;
+  // sequences near the end of the text are truncated by the end of the buffer
+  for (int s = 0; s < n_utf8_samples; s++) {
+    const char *seq = utf8_samples[s];
+    unsigned l = (unsigned)strlen(seq);
+    for (int align = 0; align < 16; align++) {
+      for (unsigned n = 1; n <= 40; n++) {
+        for (unsigned k = 0; k < n; k++) {
+          char *src = buf + align;
+          for (unsigned i = 0; i < n; i++) src[i] = char('a' + i % 26);
+          for (unsigned i = 0; i < l && k + i < n; i++) src[k + i] = seq[i];
+          EXPECT_TRUE(utf8_same_as_bytewise(src, n));
+        }
+      }
+    }
+  }
+  // random mixtures of ASCII runs and the sequences above
+  unsigned seed = 1;
+  for (int t = 0; t < 20000; t++) {
+    unsigned n = 0;
+    while (n < 64) {
+      seed = seed * 1103515245u + 12345u;
+      unsigned r = (seed >> 16) & 0x7fff;
+      if (r % 4) {
+        unsigned run = r % 20;
+        for (unsigned i = 0; i < run && n < 64; i++) buf[n++] = char(0x20 + (r + i) % 0x5f);
+      } else {
+        const char *seq = utf8_samples[(r >> 2) % n_utf8_samples];
+        for (; *seq && n < 64; seq++) buf[n++] = *seq;
+      }
+    }
+    EXPECT_TRUE(utf8_same_as_bytewise(buf + (t % 16), n - (t % 16)));
+  }
+  return true;
+}
+
+// the byte-wise input filter of Fl_Text_Buffer::insertfile()
+static int ref_utf8_input_filter(char *buffer, int buflen, char *line, int sline,
+                                 char* &endline, FILE *fp, int *input_was_changed) {
+  char *p, *q, multibyte[5];
+  int len, lp, lq, r;
+  unsigned u;
+  p = line;
+  q = buffer;
+  while (q < buffer + buflen) {
+    if (p >= endline) {
+      r = (int) fread(line, 1, sline, fp);
+      endline = line + r;
+      if (r == 0) return (int) (q - buffer);
+      p = line;
+    }
+    len = fl_utf8len1(*p);
+    if (p + len > endline) {
+      memmove(line, p, endline - p);
+      endline -= (p - line);
+      r = (int) fread(endline, 1, sline - (endline - line), fp);
+      endline += r;
+      p = line;
+      if (endline - line < len) break;
+    }
+    while ( len > 0) {
+      u = fl_utf8decode(p, p+len, &lp);
+      lq = fl_utf8encode(u, multibyte);
+      if (lp != len || lq != len)
+        *input_was_changed = true;
+      if (q + lq > buffer + buflen) {
+        memmove(line, p, endline - p);
+        endline -= (p - line);
+        return (int) (q - buffer);
+      }
+      memcpy(q, multibyte, lq);
+      q += lq;
+      p += lp;
+      len -= lp;
+    }
+  }
+  memmove(line, p, endline - p);
+  endline -= (p - line);
+  return (int) (q - buffer);
+}
+
+// what Fl_Text_Buffer::insertfile() did with the byte-wise input filter
+static std::string ref_insertfile(const char *file, int buflen, int &changed) {
+  std::string text;
+  FILE *fp = fl_fopen(file, "r");
+  if (!fp) return text;
+  char *buffer = new char[buflen + 1];
+  char *endline, line[100];
+  changed = false;
+  endline = line;
+  for (;;) {
+    int len = ref_utf8_input_filter(buffer, buflen, line, sizeof(line), endline, fp, &changed);
+    if (len == 0) break;
+    text.append(buffer, len);
+  }
+  fclose(fp);
+  delete[] buffer;
+  return text;
+}
+
+TEST(Fl_Text_Buffer, utf8_input) {
+  char dir[FL_PATH_MAX];
+  Fl_Preferences prefs(Fl_Preferences::USER_L, "fltk.org", "unittests");
+  EXPECT_TRUE(prefs.get_userdata_path(dir, sizeof(dir)) != 0);
+  std::string file = std::string(dir) + "utf8_input.txt";
+  Fl_Text_Buffer tb;
+  tb.transcoding_warning_action = NULL;
+  int buflens[] = { 4, 7, 64, 128*1024 };
+  // ASCII runs across the 100-byte line buffer, with a non-ASCII sequence
+  // at offsets around its end and at the end of the file
+  unsigned seed = 7;
+  for (int t = 0; t < 400; t++) {
+    std::string data;
+    int size = 90 + t % 130;
+    while ((int)data.size() < size) {
+      seed = seed * 1103515245u + 12345u;
+      unsigned r = (seed >> 16) & 0x7fff;
+      if (r % 3) data.append(size_t(1 + r % 40), char('a' + r % 26));
+      else data += utf8_samples[(r >> 2) % n_utf8_samples];
+    }
+    data += utf8_samples[t % n_utf8_samples];
+    FILE *fp = fl_fopen(file.c_str(), "wb");
+    EXPECT_TRUE(fp != NULL);
+    fwrite(data.data(), 1, data.size(), fp);
+    fclose(fp);
+    for (unsigned b = 0; b < sizeof(buflens) / sizeof(buflens[0]); b++) {
+      int changed = 0;
+      std::string ref = ref_insertfile(file.c_str(), buflens[b], changed);
+      tb.text("");
+      EXPECT_EQ(tb.insertfile(file.c_str(), 0, buflens[b]), 0);
+      char *text = tb.text();
+      bool same = (ref == text);
+      free(text);
+      EXPECT_TRUE(same);
+      EXPECT_EQ(tb.input_file_was_transcoded, changed);
+    }
+  }
+  fl_unlink(file.c_str());
+  return true;
+}
+
+/* Test the row-by-row decoding of PNG, JPEG and BMP images. */
+
+// Copies the rows passed to the callback into an image-sized buffer, or lets
+// the decoder write them there, and counts the bands
+struct Rows_Collector {
+  bool use_target;        // the decoder writes into pixels
+  int stop_after;         // bands after which the callback stops decoding, or 0
+  int w, h, d, bands;
+  std::vector<uchar> pixels;
+  Rows_Collector(bool target, int stop = 0)
+    : use_target(target), stop_after(stop), w(0), h(0), d(0), bands(0) { }
+};
+
+static int collect_rows(Fl_Image_Rows *rows, void *data) {
+  Rows_Collector *c = (Rows_Collector*)data;
+  if (rows->n == 0) { // the size of the image
+    c->w = rows->w; c->h = rows->h; c->d = rows->d;
+    c->pixels.assign((size_t)rows->w * rows->h * rows->d, 0);
+    if (c->use_target) rows->target = &c->pixels[0];
+    return 0;
+  }
+  int row_size = rows->w * rows->d;
+  for (int i = 0; i < rows->n; i++) {
+    uchar *to = &c->pixels[(size_t)(rows->y + i) * row_size];
+    const uchar *from = rows->pixels + (size_t)i * rows->ld;
+    if (from != to) memcpy(to, from, row_size);
+  }
+  c->bands++;
+  return (c->bands == c->stop_after) ? Fl_Image_Rows::STOP : 0;
+}
+
+// Decodes file row by row, with and without a target buffer, and returns
+// true if the rows are those of image ref, and if the callback can stop
+static bool decodes_like(int (*decode)(const char *, Fl_Image_Rows_Cb, void *),
+                         const char *file, Fl_RGB_Image *ref) {
+  if (ref->fail() || ref->count() != 1) return false;
+  int row_size = ref->data_w() * ref->d();
+  int ld = ref->ld() ? ref->ld() : row_size;
+  for (int t = 0; t < 2; t++) {
+    Rows_Collector c(t == 1);
+    if (decode(file, collect_rows, &c) != 0) return false;
+    if (c.w != ref->data_w() || c.h != ref->data_h() || c.d != ref->d()) return false;
+    if (c.bands < 1) return false;
+    for (int y = 0; y < c.h; y++) {
+      if (memcmp(&c.pixels[(size_t)y * row_size], ref->array + (size_t)y * ld, row_size))
+        return false;
+    }
+  }
+  Rows_Collector c(false, 1);
+  if (decode(file, collect_rows, &c) != Fl_Image_Rows::STOP || c.bands != 1) return false;
+  return true;
+}
+
+// 13 x 11 RGB image, interlaced with Adam7
+static const uchar adam7_png[] = {
+  0x89,0x50,0x4e,0x47,0x0d,0x0a,0x1a,0x0a,0x00,0x00,0x00,0x0d,0x49,0x48,0x44,0x52,
+  0x00,0x00,0x00,0x0d,0x00,0x00,0x00,0x0b,0x08,0x02,0x00,0x00,0x01,0x5c,0xd7,0xa0,
+  0xa0,0x00,0x00,0x01,0x8d,0x49,0x44,0x41,0x54,0x78,0xda,0x0d,0xcd,0x21,0x68,0x9c,
+  0x31,0x18,0x80,0xe1,0x4f,0xd6,0x0d,0x1a,0x11,0xb3,0xc2,0x89,0x23,0x84,0x89,0xcc,
+  0x15,0x22,0x0a,0x07,0xbb,0xa8,0x86,0x8a,0x53,0x2d,0x04,0x72,0x50,0x71,0xee,0x18,
+  0xc9,0x06,0x27,0x0e,0xa6,0x52,0x11,0xb5,0xba,0xa8,0x42,0x2a,0x0e,0xc6,0x6f,0x2a,
+  0x4e,0x04,0x0a,0x11,0x53,0x13,0x07,0xb9,0xa8,0xa9,0x89,0x42,0x1a,0x26,0xaa,0x27,
+  0x4e,0xed,0xe4,0xcb,0x23,0x5e,0x00,0xa0,0x01,0x28,0x40,0xa2,0x21,0xfd,0x05,0x09,
+  0xb4,0x1d,0x4b,0xa6,0x93,0x96,0x7e,0x01,0x28,0x2a,0x55,0x08,0xea,0xa4,0xa9,0x15,
+  0x10,0xa0,0x06,0x68,0x3e,0x2a,0x51,0x73,0xa3,0xf6,0x59,0x4d,0x80,0xa4,0x60,0xd2,
+  0x2a,0xa7,0x6b,0x00,0x46,0x09,0x9b,0x4a,0x36,0x37,0x6c,0x1d,0x58,0xc8,0x6c,0xdb,
+  0xd8,0x1e,0xc0,0x53,0xe2,0xd7,0xd2,0xef,0x8d,0x1f,0x07,0xbf,0xca,0x7e,0xd7,0xfc,
+  0x08,0xa0,0x53,0xd2,0xb7,0xb2,0x4f,0x4c,0xdf,0x85,0x7e,0x9d,0x7b,0x6b,0xfd,0x33,
+  0x20,0xa0,0x1c,0xa8,0x06,0xea,0x80,0x0e,0x40,0xeb,0x71,0x84,0xd8,0x39,0x67,0x33,
+  0xcd,0x96,0x8e,0xf9,0x81,0x6d,0x2a,0xfb,0x09,0x48,0x4d,0xb9,0x5a,0x6b,0xb5,0x75,
+  0xea,0x6d,0x50,0xe3,0xaa,0x14,0x20,0x3f,0xe3,0x7e,0xa3,0xfd,0xc1,0xf9,0xab,0xc1,
+  0x3f,0x56,0xff,0x0f,0x50,0x9a,0xf3,0xb4,0xd7,0x69,0xe2,0xd2,0xd3,0x90,0x46,0x35,
+  0x7d,0x07,0xd4,0x97,0xbc,0x1f,0x74,0xbf,0x73,0xfd,0x74,0xe8,0x0f,0xb5,0x7f,0x00,
+  0xc0,0x14,0xe1,0x8f,0x04,0x9f,0x73,0x7c,0x21,0xf1,0x54,0xe3,0x4b,0x83,0x67,0x0e,
+  0xdf,0x04,0x3c,0x1f,0xf0,0x22,0xe3,0x65,0xc5,0x5f,0x1b,0x5e,0x03,0x08,0x8a,0xc4,
+  0x05,0x11,0x33,0x2e,0x16,0x52,0xac,0xb5,0xb8,0x37,0x62,0xe3,0xc4,0x73,0x10,0xfb,
+  0x41,0xbc,0x66,0x71,0xa8,0xe2,0x5d,0x13,0x63,0x00,0x4b,0x91,0xbd,0x24,0x76,0xc9,
+  0xed,0xbd,0xb4,0x5b,0x6d,0x7f,0x1b,0x7b,0x70,0xf6,0x2c,0xd8,0xc9,0x60,0x6f,0xb3,
+  0xbd,0xab,0xf6,0x47,0xb3,0x3b,0x80,0x48,0x51,0xbc,0x21,0xd1,0xf3,0xf8,0x2c,0xe3,
+  0x9b,0x8e,0x67,0x26,0x5e,0xb9,0xf8,0x2d,0xc4,0xa7,0x21,0xbe,0xe4,0x78,0x5a,0xe3,
+  0xa7,0x16,0xbf,0x00,0x14,0x8a,0xca,0x82,0x94,0x0d,0x2f,0xaf,0xb2,0x8c,0x75,0xb9,
+  0x35,0xe5,0xd1,0x95,0x97,0x50,0x46,0x43,0xd1,0xb9,0x3c,0xd4,0xf2,0xa7,0x95,0xf7,
+  0xff,0x01,0x19,0xe4,0xbe,0x92,0xa7,0xb9,0x1c,0x8a,0x00,0x00,0x00,0x00,0x49,0x45,
+  0x4e,0x44,0xae,0x42,0x60,0x82
+};
+
+// Writes a 24-bit BMP file of w x h pixels, stored bottom-up
+static bool write_bmp(const char *file, const uchar *rgb, int w, int h) {
+  int row_size = (w * 3 + 3) & ~3;
+  uchar header[54] = { 'B', 'M' };
+  int values[][2] = { // offset and value of 32-bit fields
+    { 2, 54 + row_size * h }, { 10, 54 }, { 14, 40 }, { 18, w }, { 22, h },
+    { 26, 1 | (24 << 16) }, { 34, row_size * h }
+  };
+  for (unsigned i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    for (int b = 0; b < 4; b++) header[values[i][0] + b] = uchar(values[i][1] >> (8 * b));
+  FILE *f = fl_fopen(file, "wb");
+  if (!f) return false;
+  fwrite(header, 1, sizeof(header), f);
+  std::vector<uchar> row(row_size, 0);
+  for (int y = h - 1; y >= 0; y--) {
+    for (int x = 0; x < w; x++) { // BGR
+      const uchar *p = rgb + (y * w + x) * 3;
+      row[x * 3] = p[2]; row[x * 3 + 1] = p[1]; row[x * 3 + 2] = p[0];
+    }
+    fwrite(&row[0], 1, row_size, f);
+  }
+  return fclose(f) == 0;
+}
+
+TEST(Fl_Image_Rows, decode) {
+  char dir[FL_PATH_MAX];
+  {
+    Fl_Preferences prefs(Fl_Preferences::USER_L, "fltk.org", "unittests");
+    EXPECT_TRUE(prefs.get_userdata_path(dir, sizeof(dir)) != 0);
+  }
+  std::string png = std::string(dir) + "rows.png", adam7 = std::string(dir) + "adam7.png";
+  std::string jpeg = std::string(dir) + "rows.jpg", bmp = std::string(dir) + "rows.bmp";
+  // several bands of rows, and BMP rows that need padding
+  const int w = 37, h = 41;
+  std::vector<uchar> rgba((size_t)w * h * 4);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      uchar *p = &rgba[(size_t)(y * w + x) * 4];
+      p[0] = uchar(x * 7); p[1] = uchar(y * 6); p[2] = uchar((x + y) * 3); p[3] = uchar(255 - x * y);
+    }
+  }
+  std::vector<uchar> rgb((size_t)w * h * 3);
+  for (int i = 0; i < w * h; i++) memcpy(&rgb[i * 3], &rgba[i * 4], 3);
+
+  EXPECT_EQ(fl_write_png(png.c_str(), &rgba[0], w, h, 4, 0), 0);
+  {
+    Fl_PNG_Image ref(png.c_str());
+    EXPECT_TRUE(decodes_like(Fl_PNG_Image::decode, png.c_str(), &ref));
+  }
+  FILE *f = fl_fopen(adam7.c_str(), "wb");
+  EXPECT_TRUE(f != NULL);
+  fwrite(adam7_png, 1, sizeof(adam7_png), f);
+  fclose(f);
+  {
+    Fl_PNG_Image ref(adam7.c_str());
+    EXPECT_TRUE(decodes_like(Fl_PNG_Image::decode, adam7.c_str(), &ref));
+  }
+  EXPECT_EQ(fl_write_jpeg(jpeg.c_str(), &rgb[0], w, h, 3, 0), 0);
+  {
+    Fl_JPEG_Image ref(jpeg.c_str());
+    EXPECT_TRUE(decodes_like(Fl_JPEG_Image::decode, jpeg.c_str(), &ref));
+  }
+  EXPECT_TRUE(write_bmp(bmp.c_str(), &rgb[0], w, h));
+  {
+    Fl_BMP_Image ref(bmp.c_str());
+    EXPECT_TRUE(decodes_like(Fl_BMP_Image::decode, bmp.c_str(), &ref));
+    // rows of the file match the pixels written
+    EXPECT_TRUE(ref.d() == 3 && memcmp(ref.array, &rgb[0], rgb.size()) == 0);
+  }
+  fl_unlink(png.c_str());
+  fl_unlink(adam7.c_str());
+  fl_unlink(jpeg.c_str());
+  fl_unlink(bmp.c_str());
+  return true;
+}
+
+/* Test that SVG and PostScript output define repeated images once. */
+
+// Returns the number of occurrences of pattern in file, where a '#' of the
+// pattern matches one or more digits
+static int count_in_file(const char *file, const char *pattern) {
+  FILE *f = fl_fopen(file, "rb");
+  if (!f) return -1;
+  std::string text;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+  fclose(f);
+  int count = 0;
+  for (size_t start = 0; start < text.size(); start++) {
+    size_t t = start;
+    const char *p = pattern;
+    for (; *p && t < text.size(); p++) {
+      if (*p == '#') {
+        if (!isdigit((uchar)text[t])) break;
+        while (t < text.size() && isdigit((uchar)text[t])) t++;
+      } else if (text[t] == *p) t++;
+      else break;
+    }
+    if (!*p) count++;
+  }
+  return count;
+}
+
+// Draws two images with the same pixels and one with other pixels, as RGB
+// images and as pixmaps. The last pixmap has the same XPM data address as
+// the first ones, but its data changed in between.
+static void draw_repeated_images() {
+  uchar rgb1[4 * 3 * 3], rgb2[4 * 3 * 3], rgb3[4 * 3 * 3];
+  for (int i = 0; i < 4 * 3 * 3; i++) rgb1[i] = rgb2[i] = rgb3[i] = uchar(i * 7);
+  rgb3[5] = 0;
+  Fl_RGB_Image a(rgb1, 4, 3), b(rgb2, 4, 3), c(rgb3, 4, 3);
+  a.draw(0, 0); b.draw(10, 0); c.draw(20, 0); a.draw(30, 0);
+  char row[] = "..xx";
+  const char *xpm1[] = { "4 3 2 1", ". c #ff0000", "x c #0000ff", row, "x..x", "xx.." };
+  const char *xpm2[] = { "4 3 2 1", ". c #ff0000", "x c #0000ff", "..xx", "x..x", "xx.." };
+  {
+    Fl_Pixmap p1(xpm1), p2(xpm2);
+    p1.draw(0, 20); p2.draw(10, 20);
+  }
+  row[0] = 'x';
+  Fl_Pixmap p3(xpm1);
+  p3.draw(20, 20);
+}
+
+TEST(Fl_Graphics_Driver, repeated_images) {
+  char dir[FL_PATH_MAX];
+  {
+    Fl_Preferences prefs(Fl_Preferences::USER_L, "fltk.org", "unittests");
+    EXPECT_TRUE(prefs.get_userdata_path(dir, sizeof(dir)) != 0);
+  }
+  std::string svg = std::string(dir) + "images.svg", ps = std::string(dir) + "images.ps";
+  FILE *f = fl_fopen(svg.c_str(), "w");
+  EXPECT_TRUE(f != NULL);
+  {
+    Fl_SVG_File_Surface surface(100, 100, f); // closes f
+    Fl_Surface_Device::push_current(&surface);
+    draw_repeated_images();
+    Fl_Surface_Device::pop_current();
+  }
+  // 2 RGB images and 2 pixmaps are defined, and used 4 and 3 times
+  EXPECT_EQ(count_in_file(svg.c_str(), "<defs><image id=\"FLimg#\""), 4);
+  EXPECT_EQ(count_in_file(svg.c_str(), "<use href="), 7);
+  fl_unlink(svg.c_str());
+#if !defined(_WIN32) && !defined(__APPLE__)
+  // PostScript output sets fonts, which are measured with the display's fonts
+  if (!fl_getenv("DISPLAY") && !fl_getenv("WAYLAND_DISPLAY")) return true;
+#endif
+  f = fl_fopen(ps.c_str(), "w");
+  EXPECT_TRUE(f != NULL);
+  {
+    Fl_PostScript_File_Device surface;
+    surface.begin_job(f);
+    surface.begin_page();
+    draw_repeated_images();
+    surface.end_page();
+    surface.end_job();
+  }
+  fclose(f);
+  EXPECT_EQ(count_in_file(ps.c_str(), "/FLi# # DFI"), 4);
+  EXPECT_EQ(count_in_file(ps.c_str(), "FLi# UFI"), 7);
+  fl_unlink(ps.c_str());
+  return true;
+}
+
+#if HAVE_GL
+
+/* Test that gl_draw() draws a string from the glyph atlas as it draws it from
+ a texture of the whole string. */
+
+// Draws the same text twice, alone, which uses the glyph atlas, and followed by
+// an em space, which is not drawn from the atlas, then reads the pixels drawn.
+class Glyph_Atlas_Window : public Fl_Gl_Window {
+public:
+  std::vector<unsigned char> pixels; // red component of each pixel, bottom row first
+  Glyph_Atlas_Window() : Fl_Gl_Window(300, 80) { }
+  void draw() FL_OVERRIDE {
+    if (!valid()) {
+      glViewport(0, 0, pixel_w(), pixel_h());
+      glLoadIdentity();
+      glOrtho(0, w(), 0, h(), -1, 1);
+    }
+    glClearColor(0, 0, 0, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    gl_font(FL_HELVETICA, 24);
+    gl_color(FL_WHITE);
+    gl_draw("AVATar Wolf", 10.f, 50.f);
+    gl_draw("AVATar Wolf\xE2\x80\x83", 10.f, 10.f);
+    glFinish();
+    pixels.resize(pixel_w() * pixel_h());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, pixel_w(), pixel_h(), GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
+  }
+  // sum of the pixel values of each column in a range of rows
+  std::vector<int> columns(int from_row, int to_row) {
+    std::vector<int> sums(pixel_w());
+    for (int r = from_row; r < to_row; r++)
+      for (int c = 0; c < pixel_w(); c++) sums[c] += pixels[r * pixel_w() + c];
+    return sums;
+  }
+};
+
+TEST(gl_draw, glyph_atlas) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  if (!fl_getenv("DISPLAY") && !fl_getenv("WAYLAND_DISPLAY")) return true;
+#endif
+  if (!Fl_Gl_Window::can_do(FL_RGB | FL_DOUBLE) || !Fl::draw_GL_text_with_textures())
+    return true;
+  Glyph_Atlas_Window win;
+  win.show();
+  for (int i = 0; i < 50 && win.pixels.empty(); i++) Fl::wait(0.1);
+  EXPECT_TRUE(!win.pixels.empty());
+  // both strings lie apart from row 35 of the window
+  int split = int(35 * win.pixels_per_unit());
+  std::vector<int> atlas = win.columns(split, win.pixel_h());
+  std::vector<int> whole = win.columns(0, split);
+  win.hide();
+  int first = -1, last = -1, ink = 0, diff = 0;
+  for (size_t c = 0; c < atlas.size(); c++) {
+    if (atlas[c] && first < 0) first = int(c);
+    if (atlas[c]) last = int(c);
+    ink += whole[c];
+    diff += abs(atlas[c] - whole[c]);
+  }
+  EXPECT_GT(ink, 0);
+  // the ink of each glyph lies in the same columns, with little antialiasing difference
+  int whole_first = -1, whole_last = -1;
+  for (size_t c = 0; c < whole.size(); c++) {
+    if (whole[c] && whole_first < 0) whole_first = int(c);
+    if (whole[c]) whole_last = int(c);
+  }
+  EXPECT_LE(abs(first - whole_first), 1);
+  EXPECT_LE(abs(last - whole_last), 1);
+  EXPECT_LT(diff * 10, ink);
+  return true;
+}
+
+#endif // HAVE_GL
+
+/* Test the display lines of Fl_Input_ that edits update incrementally. */
+
+// Graphics driver that measures each byte as 7 pixels wide and records the
+// text drawn on each line, so that Fl_Input_ can be drawn without a display.
+// It doesn't clip, but counts pushed clips, which the base class can't pop.
+class Layout_Test_Driver : public Fl_Graphics_Driver {
+public:
+  std::map<int, std::string> lines; // text drawn at each baseline
+  int clip_depth = 0;
+  void push_clip(int, int, int, int) FL_OVERRIDE { clip_depth++; }
+  void push_no_clip() FL_OVERRIDE { clip_depth++; }
+  void pop_clip() FL_OVERRIDE { clip_depth--; }
+  int not_clipped(int, int, int, int) FL_OVERRIDE { return 1; }
+  int clip_box(int x, int y, int w, int h, int &X, int &Y, int &W, int &H) FL_OVERRIDE {
+    X = x; Y = y; W = w; H = h;
+    return 0;
+  }
+  double width(const char *, int n) FL_OVERRIDE { return 7.0 * n; }
+  double width(unsigned int) FL_OVERRIDE { return 7.0; }
+  int height() FL_OVERRIDE { return 14; }
+  int descent() FL_OVERRIDE { return 3; }
+  void draw(const char *str, int n, int, int y) FL_OVERRIDE { lines[y].append(str, n); }
+};
+
+class Layout_Test_Surface : public Fl_Surface_Device {
+public:
+  Layout_Test_Surface() : Fl_Surface_Device(new Layout_Test_Driver) { }
+  ~Layout_Test_Surface() { delete driver(); }
+};
+
+// Makes draw() accessible, tall enough to draw all lines without scrolling
+class Layout_Test_Input : public Fl_Multiline_Input {
+public:
+  Layout_Test_Input(int type) : Fl_Multiline_Input(0, 0, 200, 30000) {
+    this->type(type);
+    maximum_size(100000);
+  }
+  void draw() FL_OVERRIDE { Fl_Multiline_Input::draw(); }
+  // Draws the whole widget and returns the text of each line
+  std::map<int, std::string> lines() {
+    Layout_Test_Driver *d = (Layout_Test_Driver*)Fl_Surface_Device::surface()->driver();
+    d->lines.clear();
+    insert_position(0);
+    damage(FL_DAMAGE_ALL);
+    draw();
+    clear_damage();
+    return d->lines;
+  }
+};
+
+TEST(Fl_Input_, layout_after_edits) {
+  static const char *pieces[] = {
+    "a", " ", "\n", "word ", "longerword", "\n\n", "  ", "x y z ", "\t",
+    "some text that needs wrapping ", "averyveryverylongwordthatwontfitonaline"
+  };
+  const int n_pieces = (int)(sizeof(pieces) / sizeof(pieces[0]));
+  Layout_Test_Surface surface;
+  Fl_Surface_Device::push_current(&surface);
+  bool same = true;
+  int types[] = { FL_MULTILINE_INPUT, FL_MULTILINE_INPUT_WRAP };
+  unsigned seed = 3;
+  for (int t = 0; t < 2 && same; t++) {
+    // each edit after the first draw updates the lines with layout_changed(),
+    // which must give the same lines as a new widget that lays out all text
+    Layout_Test_Input in(types[t]);
+    in.lines();
+    for (int i = 0; i < 1500 && same; i++) {
+      seed = seed * 1103515245u + 12345u;
+      unsigned r = (seed >> 16) & 0x7fff;
+      if (r % 8 == 0) {
+        in.undo();
+      } else {
+        int size = in.size();
+        int b = size ? (int)(r % (size + 1)) : 0;
+        int e = b + (int)((r >> 4) % 12);
+        if (e > size || size < 300) e = b; // grow to a few hundred bytes first
+        const char *p = (size > 1500) ? "" : pieces[(r >> 8) % n_pieces];
+        in.replace(b, e, p);
+      }
+      Layout_Test_Input fresh(types[t]);
+      fresh.value(in.value(), in.size());
+      same = (in.lines() == fresh.lines());
+    }
+  }
+  int clip_depth = ((Layout_Test_Driver*)surface.driver())->clip_depth;
+  Fl_Surface_Device::pop_current();
+  EXPECT_TRUE(same);
+  EXPECT_EQ(clip_depth, 0); // each pushed clip was popped
+  return true;
+}
+
 //
 //------- test aspects of the FLTK core library ----------
 //
@@ -0,0 +1,111 @@
+//
+// Speed test of the UTF-8 functions for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2026 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Validates, decodes and converts large ASCII, Latin, CJK and emoji texts
+// with the fl_utf8 functions and prints their throughput in MB/s.
+// This program doesn't open a window.
+//
+// Usage: utf8_speed [megabytes [repetitions]]
+
+#include <FL/Fl.H>
+#include <FL/fl_utf8.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+static int megabytes = 4;
+static int repetitions = 10;
+
+static const struct {
+  const char *name;
+  const char *sample;
+} corpora[] = {
+  { "ASCII", "The quick brown fox jumps over the lazy dog. 0123456789\n" },
+  { "Latin", "Gr\xc3\xb6\xc3\x9f" "e Stra\xc3\x9f" "e, caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9" "e, \xc3\xa0 bient\xc3\xb4t!\n" },
+  { "CJK",   "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe6\x96\x87\xe7\xab\xa0\xe3\x80\x82"
+             "\xe4\xb8\xad\xe6\x96\x87\xe6\x96\x87\xe6\x9c\xac\xe3\x80\x82"
+             "\xed\x95\x9c\xea\xb5\xad\xec\x96\xb4 \xed\x85\x8d\xec\x8a\xa4\xed\x8a\xb8\n" },
+  { "emoji", "\xf0\x9f\x98\x80\xf0\x9f\x8e\x89\xf0\x9f\x9a\x80 smile \xf0\x9f\x91\x8d\xf0\x9f\x94\xa5\n" }
+};
+
+// volatile sink so the compiler doesn't remove the loops
+static volatile unsigned sink;
+
+static void report(const char *what, size_t bytes, Fl_Timestamp start) {
+  double t = Fl::seconds_since(start);
+  printf("  %-16s %9.1f MB/s\n", what, t > 0 ? bytes * double(repetitions) / (t * 1e6) : 0.);
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) megabytes = atoi(argv[1]);
+  if (argc > 2) repetitions = atoi(argv[2]);
+  if (megabytes < 1) megabytes = 1;
+  if (repetitions < 1) repetitions = 1;
+
+  const size_t size = size_t(megabytes) << 20;
+  char *text = (char*)malloc(size + 64);
+  unsigned short *utf16 = (unsigned short*)malloc((size + 1) * sizeof(unsigned short));
+  wchar_t *wide = (wchar_t*)malloc((size + 1) * sizeof(wchar_t));
+  char *latin1 = (char*)malloc(size + 1);
+
+  for (unsigned c = 0; c < sizeof(corpora) / sizeof(corpora[0]); c++) {
+    // fill the buffer with complete copies of the sample
+    const size_t l = strlen(corpora[c].sample);
+    size_t n = 0;
+    while (n + l <= size) {
+      memcpy(text + n, corpora[c].sample, l);
+      n += l;
+    }
+    const unsigned len = unsigned(n);
+    printf("%s text, %u bytes, %d repetitions:\n", corpora[c].name, len, repetitions);
+
+    Fl_Timestamp start = Fl::now();
+    for (int r = 0; r < repetitions; r++) sink = fl_utf8test(text, len);
+    report("fl_utf8test()", len, start);
+
+    start = Fl::now();
+    for (int r = 0; r < repetitions; r++) {
+      const char *p = text, *e = text + len;
+      unsigned sum = 0;
+      while (p < e) {
+        int l;
+        sum += fl_utf8decode(p, e, &l);
+        p += l;
+      }
+      sink = sum;
+    }
+    report("fl_utf8decode()", len, start);
+
+    start = Fl::now();
+    for (int r = 0; r < repetitions; r++) sink = fl_utf8toUtf16(text, len, utf16, len + 1);
+    report("fl_utf8toUtf16()", len, start);
+
+    start = Fl::now();
+    for (int r = 0; r < repetitions; r++) sink = fl_utf8towc(text, len, wide, len + 1);
+    report("fl_utf8towc()", len, start);
+
+    start = Fl::now();
+    for (int r = 0; r < repetitions; r++) sink = fl_utf8toa(text, len, latin1, len + 1);
+    report("fl_utf8toa()", len, start);
+  }
+
+  free(latin1);
+  free(wide);
+  free(utf16);
+  free(text);
+  return 0;
+}